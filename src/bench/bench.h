@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// Micro-benchmarks bundled into jetson_motion_bench. Each entry point takes
+// the arguments that follow its subcommand name (argv[0] is the subcommand).
+int bench_jitter(int argc, char** argv);
+int bench_gate(int argc, char** argv);
+int bench_kalman(int argc, char** argv);
+int bench_points(int argc, char** argv);
+int bench_homography(int argc, char** argv);
+int bench_spectrum(int argc, char** argv);
+int bench_bus(int argc, char** argv);
+int bench_alloc(int argc, char** argv);
+int bench_startup(int argc, char** argv);
+int bench_pose(int argc, char** argv);
+int bench_undistort(int argc, char** argv);
+int bench_tiles(int argc, char** argv);
+int bench_quality(int argc, char** argv);
+int bench_redetect(int argc, char** argv);
+int bench_pyramid(int argc, char** argv);
+int bench_serialize(int argc, char** argv);
+
+// Shared helpers
+struct BenchPercentiles {
+    double p50 = 0, p99 = 0, max = 0, mean = 0;
+};
+
+inline BenchPercentiles bench_percentiles(std::vector<double> v) {
+    BenchPercentiles r;
+    if (v.empty()) return r;
+    std::sort(v.begin(), v.end());
+    auto at = [&](double q) { return v[std::min(v.size() - 1, static_cast<size_t>(q * (v.size() - 1) + 0.5))]; };
+    r.p50 = at(0.50);
+    r.p99 = at(0.99);
+    r.max = v.back();
+    double s = 0;
+    for (double x : v) s += x;
+    r.mean = s / v.size();
+    return r;
+}
@@ -0,0 +1,192 @@
+#include "bench.h"
+#include "../processing/aruco_tracker.h"
+#include "../pipeline/synthetic_source.h"
+#include "../util/alloc_trace.h"
+#include "../util/csv_logger.h"
+#include "../util/frame_bus.h"
+#include "../util/thread_topology.h"
+#include "../io/writer.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <stdlib.h>
+
+// Steady-state allocation check (needs -DTRACKER_ALLOC_TRACE=ON). Replays a
+// synthetic clip through the real capture -> bus -> tracker path, with CSV,
+// snapshots and UDP metrics on (written to a temporary ARUCO_OUT_DIR), and
+// counts heap allocations per frame on the capture and processing threads
+// after a warm-up.
+//
+// Budgets come from a baseline: --save-baseline records this run's
+// allocs/frame, and --baseline then allows each thread its baseline plus 10%
+// (at least 0.5 allocs/frame) for cadence jitter in the timed outputs.
+// config/alloc_baseline.json is the committed baseline for the default clip
+// and params; ctest runs against it (alloc_budget) in TRACKER_ALLOC_TRACE
+// builds. Exits 2 when either thread is over budget. Without a baseline or
+// --budget-* it only reports.
+
+namespace {
+
+bool load_baseline(const std::string& path, double& capture, double& process) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened() || fs["capture_allocs_per_frame"].empty() || fs["process_allocs_per_frame"].empty())
+        return false;
+    fs["capture_allocs_per_frame"] >> capture;
+    fs["process_allocs_per_frame"] >> process;
+    return true;
+}
+
+double budget_from(double baseline) {
+    return baseline + std::max(0.5, 0.1 * baseline);
+}
+
+} // namespace
+
+int bench_alloc(int argc, char** argv) {
+    int frames = 1200, warmup = 120;
+    double budget_capture = -1, budget_process = -1;
+    std::string params_path, baseline_path, save_baseline_path;
+    bool outputs = true;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--warmup" && i+1<argc) warmup = atoi(argv[++i]);
+        else if (a == "--budget-capture" && i+1<argc) budget_capture = atof(argv[++i]);
+        else if (a == "--budget-process" && i+1<argc) budget_process = atof(argv[++i]);
+        else if (a == "--baseline" && i+1<argc) baseline_path = argv[++i];
+        else if (a == "--save-baseline" && i+1<argc) save_baseline_path = argv[++i];
+        else if (a == "--no-outputs") outputs = false;
+        else if (a == "--params" && i+1<argc) params_path = argv[++i];
+        else {
+            std::cerr << "Usage: alloc [--frames N] [--warmup N] [--baseline FILE] [--save-baseline FILE]\n"
+                         "             [--budget-capture A] [--budget-process A] [--no-outputs] [--params FILE]\n";
+            return 1;
+        }
+    }
+    if (!baseline_path.empty()) {
+        double base_capture = 0, base_process = 0;
+        if (!load_baseline(baseline_path, base_capture, base_process)) {
+            std::cerr << "alloc: could not read baseline " << baseline_path << "\n";
+            return 1;
+        }
+        if (budget_capture < 0) budget_capture = budget_from(base_capture);
+        if (budget_process < 0) budget_process = budget_from(base_process);
+    }
+    if (!alloc_trace::enabled()) {
+        std::cerr << "alloc: built without TRACKER_ALLOC_TRACE; reconfigure with -DTRACKER_ALLOC_TRACE=ON\n";
+        return 1;
+    }
+    alloc_trace::install();
+
+    TrackerParams p;
+    if (!params_path.empty() && !load_tracker_params(params_path, p)) {
+        std::cerr << "alloc: could not read " << params_path << "\n";
+        return 1;
+    }
+
+    // outputs go to a scratch directory, set up before the clock starts as in main
+    std::string out_dir;
+    if (outputs) {
+        char tmpl[] = "/tmp/jetson_motion_alloc_XXXXXX";
+        if (!mkdtemp(tmpl)) { std::cerr << "alloc: cannot create a temporary output directory\n"; return 1; }
+        out_dir = tmpl;
+        setenv("ARUCO_OUT_DIR", out_dir.c_str(), 1);
+        CsvLogger::instance().init(out_dir);
+        SnapshotWriter::Config snap;
+        snap.out_dir = out_dir;
+        SnapshotWriter::instance().init(snap);
+    }
+    ArucoTracker tracker(p);
+    ArucoTracker::Options opts;
+    opts.enable_save = opts.enable_csv = opts.enable_metrics = outputs;
+    tracker.setOptions(opts);
+
+    SyntheticSource::Config sc;
+    sc.frames = frames;
+    SyntheticSource src(sc);
+    if (!src.open()) { std::cerr << "synthetic source failed\n"; return 1; }
+
+    // depth covers the whole clip: nothing is dropped, every frame is measured
+    FrameBus bus;
+    auto sub = bus.subscribe({"tracker", static_cast<size_t>(frames), DropPolicy::DropNewest, 0});
+
+    AllocCounters cap_steady;
+    std::thread capture([&]{
+        ThreadTopology::instance().applyToCurrentThread("capture");
+        ALLOC_STAGE("capture");
+        AllocCounters c0;
+        int n = 0;
+        cv::Mat f;
+        uint64_t ts = 0;
+        while (src.grab(f, ts)) {
+            if (n++ == warmup) c0 = alloc_trace::thread_counters();
+            bus.publish(f, ts);
+            f = cv::Mat();
+        }
+        cap_steady = alloc_trace::thread_counters() - c0;
+        bus.close();
+    });
+
+    ThreadTopology::instance().applyToCurrentThread("process");
+    AllocCounters proc_steady, c0;
+    {
+        ALLOC_STAGE("process");
+        int n = 0;
+        FramePtr f;
+        while (sub->pop(f)) {
+            if (n++ == warmup) c0 = alloc_trace::thread_counters();
+            tracker.process(f->image, f->ts_us);
+            f.reset();
+        }
+        proc_steady = alloc_trace::thread_counters() - c0;
+    }
+    capture.join();
+    if (outputs) {
+        SnapshotWriter::instance().shutdown();
+        CsvLogger::instance().shutdown();
+        std::error_code ec;
+        std::filesystem::remove_all(out_dir, ec);
+    }
+
+    const double steady = std::max(1, frames - warmup);
+    const double cap_pf = cap_steady.allocs / steady, proc_pf = proc_steady.allocs / steady;
+    alloc_trace::report(std::cout, static_cast<uint64_t>(frames));
+    std::cout << "\nSteady state (" << static_cast<int>(steady) << " frames after " << warmup << " warm-up):\n"
+              << "thread    allocs/frame  bytes/frame  copies/frame   budget\n" << std::fixed;
+    auto row = [&](const char* name, const AllocCounters& c, double pf, double budget) {
+        std::cout << std::left << std::setw(10) << name << std::right << std::setprecision(2)
+                  << std::setw(12) << pf << std::setw(13) << std::setprecision(0) << c.bytes / steady
+                  << std::setw(14) << std::setprecision(2) << c.copies / steady;
+        if (budget >= 0) std::cout << std::setw(9) << budget << (pf > budget ? "  OVER" : "");
+        else std::cout << std::setw(9) << "-";
+        std::cout << "\n";
+    };
+    row("capture", cap_steady, cap_pf, budget_capture);
+    row("process", proc_steady, proc_pf, budget_process);
+    std::cout << "outputs " << (outputs ? "on (CSV, snapshots, UDP)" : "off") << "\n";
+
+    if (!save_baseline_path.empty()) {
+        cv::FileStorage fs(save_baseline_path, cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
+        if (!fs.isOpened()) {
+            std::cerr << "alloc: could not write " << save_baseline_path << "\n";
+            return 1;
+        }
+        fs << "frames" << frames << "warmup" << warmup << "outputs" << (outputs ? 1 : 0)
+           << "params" << params_path
+           << "capture_allocs_per_frame" << cap_pf << "process_allocs_per_frame" << proc_pf;
+        std::cout << "baseline written to " << save_baseline_path << "\n";
+    }
+
+    if (budget_capture < 0 && budget_process < 0) {
+        std::cout << "no budget (record one with --save-baseline, check with --baseline)" << std::endl;
+        return 0;
+    }
+    bool ok = (budget_capture < 0 || cap_pf <= budget_capture) && (budget_process < 0 || proc_pf <= budget_process);
+    std::cout << (ok ? "PASS" : "FAIL: steady-state allocations over budget") << std::endl;
+    return ok ? 0 : 2;
+}
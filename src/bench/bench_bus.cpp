@@ -0,0 +1,102 @@
+#include "bench.h"
+#include "../util/frame_bus.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Frame bus fan-out under a slow consumer. A 120 Hz producer feeds a
+// "tracker" with a fixed per-frame cost and a "display" that is much
+// slower. Inline: both costs run on the tracker's thread, as when the
+// window was drawn from the processing loop. Bus: the display gets its own
+// depth-1 subscription. Reports tracker frames processed, drops and lag.
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+void spin_for(double ms) {
+    auto end = clk::now() + std::chrono::duration<double, std::milli>(ms);
+    while (clk::now() < end) {}
+}
+
+struct ConsumerResult {
+    SubscriberStats stats;
+    std::vector<double> lag_ms;
+};
+
+void consume(FrameSubscription& sub, double work_ms, double extra_ms, ConsumerResult& out) {
+    FramePtr f;
+    while (sub.pop(f)) {
+        out.lag_ms.push_back(sub.stats().lag_s * 1e3);
+        spin_for(work_ms);
+        if (extra_ms > 0) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(extra_ms));
+    }
+    out.stats = sub.stats();
+}
+
+void print_row(const char* mode, const ConsumerResult& r) {
+    BenchPercentiles p = bench_percentiles(r.lag_ms);
+    std::cout << std::left << std::setw(8) << mode << std::setw(10) << r.stats.name << std::right << std::fixed
+              << std::setw(10) << r.stats.delivered << std::setw(9) << r.stats.dropped
+              << std::setw(9) << r.stats.rate_skipped
+              << std::setw(11) << std::setprecision(2) << p.p50 << std::setw(11) << p.p99 << "\n";
+}
+
+void run(bool inline_display, int frames, double hz, double work_ms, double slow_ms, double display_hz) {
+    FrameBus bus;
+    auto trk = bus.subscribe({"tracker", 8, DropPolicy::DropOldest, 0});
+    std::shared_ptr<FrameSubscription> disp;
+    if (!inline_display) disp = bus.subscribe({"display", 1, DropPolicy::DropOldest, display_hz});
+
+    ConsumerResult rt, rd;
+    std::thread t_trk([&]{ consume(*trk, work_ms, inline_display ? slow_ms : 0, rt); });
+    std::thread t_disp;
+    if (disp) t_disp = std::thread([&]{ consume(*disp, 0, slow_ms, rd); });
+
+    cv::Mat img(480, 640, CV_8UC1, cv::Scalar(0));
+    auto period = std::chrono::duration_cast<clk::duration>(std::chrono::duration<double>(1.0 / hz));
+    auto next = clk::now();
+    for (int k = 0; k < frames; k++) {
+        std::this_thread::sleep_until(next);
+        next += period;
+        bus.publish(img, static_cast<uint64_t>(k * 1e6 / hz));
+    }
+    bus.close();
+    t_trk.join();
+    if (t_disp.joinable()) t_disp.join();
+
+    const char* mode = inline_display ? "inline" : "bus";
+    print_row(mode, rt);
+    if (disp) print_row(mode, rd);
+}
+
+} // namespace
+
+int bench_bus(int argc, char** argv) {
+    int frames = 1200;
+    double hz = 120, work_ms = 4, slow_ms = 25, display_hz = 30;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--hz" && i+1<argc) hz = atof(argv[++i]);
+        else if (a == "--work-ms" && i+1<argc) work_ms = atof(argv[++i]);
+        else if (a == "--slow-ms" && i+1<argc) slow_ms = atof(argv[++i]);
+        else if (a == "--display-hz" && i+1<argc) display_hz = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: bus [--frames N] [--hz HZ] [--work-ms MS] [--slow-ms MS] [--display-hz HZ]\n";
+            return 1;
+        }
+    }
+
+    std::cout << frames << " frames at " << hz << " Hz, tracker " << work_ms << " ms/frame, display "
+              << slow_ms << " ms/frame\n"
+              << "mode    consumer   delivered  dropped  thinned  lag50[ms]  lag99[ms]\n";
+    run(true, frames, hz, work_ms, slow_ms, display_hz);
+    run(false, frames, hz, work_ms, slow_ms, display_hz);
+    return 0;
+}
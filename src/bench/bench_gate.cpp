@@ -0,0 +1,112 @@
+#include "bench.h"
+#include "../processing/motion_gate.h"
+#include "../processing/tracker_params.h"
+#include "../pipeline/synthetic_source.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Motion gate cost and skip ratio. Part 1 times the SAD kernel against a
+// plain scalar loop; part 2 runs the gate over synthetic clips with and
+// without motion to show how often the full pipeline would be skipped.
+
+namespace {
+
+uint64_t sad_scalar(const uint8_t* a, const uint8_t* b, size_t n) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < n; i++) s += static_cast<uint64_t>(std::abs(int(a[i]) - int(b[i])));
+    return s;
+}
+
+template <typename F>
+double time_ns_per_px(F fn, const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int reps) {
+    volatile uint64_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) sink = sink + fn(a.data(), b.data(), a.size());
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return s * 1e9 / (static_cast<double>(reps) * a.size());
+}
+
+// The ROI is the marker bbox as the tracker holds it: placed at a detection
+// and left alone until the next one, which in LK mode comes every
+// `redetect_interval` full passes (gated frames do not count).
+void run_clip(const char* label, SyntheticSource::Config sc, const MotionGateParams& gp, int redetect_interval) {
+    SyntheticSource src(sc);
+    if (!src.open()) { std::cerr << "synthetic source failed\n"; return; }
+    MotionGate gate(gp);
+    cv::Mat frame;
+    uint64_t ts = 0;
+    int checked = 0, skipped = 0;
+    double gate_s = 0;
+    bool have_ref = false;
+    cv::Rect roi;
+    int since_detect = 0;
+    while (src.grab(frame, ts)) {
+        if (have_ref) {
+            auto t0 = std::chrono::steady_clock::now();
+            bool same = gate.unchanged(frame, roi);
+            gate_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            checked++;
+            if (same) { skipped++; continue; }
+        }
+        // full pass: a due re-detection moves the bbox to the marker
+        if (!have_ref || ++since_detect >= redetect_interval) {
+            const auto& t = src.truth();
+            const float half = sc.marker_px * 0.5f;
+            roi = cv::Rect(cv::Point(int(t.center.x - half), int(t.center.y - half)), cv::Size(sc.marker_px, sc.marker_px));
+            since_detect = 0;
+        }
+        gate.setReference(frame, roi);
+        have_ref = true;
+    }
+    std::cout << std::left << std::setw(14) << label << std::right << std::fixed
+              << std::setw(8) << checked << std::setw(8) << skipped
+              << std::setw(10) << std::setprecision(1) << (checked ? 100.0 * skipped / checked : 0.0)
+              << std::setw(12) << std::setprecision(2) << (checked ? gate_s * 1e6 / checked : 0.0) << "\n";
+}
+
+} // namespace
+
+int bench_gate(int argc, char** argv) {
+    MotionGateParams gp;
+    gp.enabled = true;
+    int frames = 1200;
+    int redetect_interval = TrackerParams().redetect_interval;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--threshold" && i+1<argc) gp.threshold = atof(argv[++i]);
+        else if (a == "--decimation" && i+1<argc) gp.decimation = atoi(argv[++i]);
+        else if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--redetect" && i+1<argc) redetect_interval = std::max(1, atoi(argv[++i]));
+        else {
+            std::cerr << "Usage: gate [--threshold T] [--decimation N] [--frames N] [--redetect N]\n";
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> a(152 * 152), b(a.size());
+    for (size_t i = 0; i < a.size(); i++) { a[i] = uint8_t(i * 31); b[i] = uint8_t(i * 17 + 3); }
+    const int reps = 20000;
+    double simd = time_ns_per_px(MotionGate::sad_u8, a, b, reps);
+    double scalar = time_ns_per_px(sad_scalar, a, b, reps);
+    std::cout << "SAD kernel (152x152 ROI): simd " << std::setprecision(3) << simd << " ns/px, scalar "
+              << scalar << " ns/px (x" << std::setprecision(1) << scalar / simd << ")\n\n";
+
+    std::cout << "clip           checked skipped   skip[%]  gate[us/f]\n";
+    SyntheticSource::Config sc;
+    sc.frames = frames;
+    sc.sweep_px_x = sc.sweep_px_y = 0;
+    sc.vib_px = 0;
+    run_clip("static", sc, gp, redetect_interval);
+    sc.vib_px = 0.3;
+    run_clip("vib 0.3px", sc, gp, redetect_interval);
+    sc.vib_px = 3.0;
+    run_clip("vib 3px", sc, gp, redetect_interval);
+    sc.sweep_px_x = 40; sc.sweep_px_y = 20;
+    run_clip("sweep+vib", sc, gp, redetect_interval);
+    return 0;
+}
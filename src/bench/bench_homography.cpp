@@ -0,0 +1,61 @@
+#include "bench.h"
+#include "../processing/param_tuner.h"
+#include "../util/metrics.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// LK point tracking vs whole-marker homography alignment on the same
+// synthetic clip: per-frame cost, position/velocity error, misses and how
+// many detections each path needed.
+
+int bench_homography(int argc, char** argv) {
+    SyntheticSource::Config sc;
+    int frames = 900;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--sweep-px" && i+1<argc) sc.sweep_px_x = atof(argv[++i]);
+        else if (a == "--sweep-hz" && i+1<argc) sc.sweep_hz = atof(argv[++i]);
+        else if (a == "--vib-px" && i+1<argc) sc.vib_px = atof(argv[++i]);
+        else if (a == "--noise" && i+1<argc) sc.noise_sigma = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: homography [--frames N] [--sweep-px PX] [--sweep-hz HZ] [--vib-px PX] [--noise SIGMA]\n";
+            return 1;
+        }
+    }
+
+    TunerClip clip;
+    make_synthetic_clip(sc, frames, clip);
+    if (clip.frames.empty()) { std::cerr << "synthetic clip failed\n"; return 1; }
+
+    Counter& fails = MetricsRegistry::instance().counter("tracker_homography_failures_total",
+        "Alignments that failed or fell below homog_min_cc");
+
+    std::cout << "Clip: " << clip.frames.size() << " synthetic frames\n"
+              << "mode                cost_ms    p95_ms   err_px     miss   vel_err  detects  align_fail\n";
+    struct Variant { const char* name; TrackMode mode; int levels; bool kalman; };
+    const Variant variants[] = {
+        {"lk", TrackMode::LK, 0, false},
+        {"lk+kalman", TrackMode::LK, 0, true},
+        {"homography L1", TrackMode::Homography, 1, false},
+        {"homography L2", TrackMode::Homography, 2, false},
+        {"homography L3", TrackMode::Homography, 3, false},
+    };
+    for (const auto& v : variants) {
+        TrackerParams p;
+        p.track_mode = v.mode;
+        p.kalman.enabled = v.kalman;
+        if (v.levels) p.homog.levels = v.levels;
+        uint64_t f0 = fails.value();
+        TunerResult r = evaluate_params(clip, p);
+        std::cout << std::left << std::setw(18) << v.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(9) << r.cost_ms_mean << std::setw(10) << r.cost_ms_p95
+                  << std::setw(9) << r.err_px << std::setw(9) << std::setprecision(4) << r.miss_rate
+                  << std::setw(10) << std::setprecision(1) << r.vel_err
+                  << std::setw(9) << r.detections << std::setw(12) << (fails.value() - f0) << "\n";
+    }
+    return 0;
+}
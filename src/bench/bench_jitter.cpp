@@ -0,0 +1,113 @@
+#include "bench.h"
+#include "../util/thread_topology.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// A periodic loop stands in for the processing thread: it sleeps until an
+// absolute deadline every 1/rate s and records how late it actually woke.
+// Background threads spin to create contention. Run once with everything
+// floating, then with the loop pinned (optionally SCHED_FIFO) and the load
+// kept off its CPU.
+
+namespace {
+
+struct JitterConfig {
+    double rate_hz = 120.0;
+    double seconds = 10.0;
+    int cpu = -1;        // -1 = last online CPU
+    int fifo = 0;
+    int load_threads = -1; // -1 = one per online CPU
+};
+
+int64_t now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+BenchPercentiles run_once(const JitterConfig& cfg, bool pinned, ThreadStats& st) {
+    const int ncpu = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> load;
+    for (int i = 0; i < cfg.load_threads; i++) {
+        load.emplace_back([&, i] {
+            if (pinned && ncpu > 1) {
+                std::vector<int> others;
+                for (int c = 0; c < ncpu; c++) if (c != cfg.cpu) others.push_back(c);
+                ThreadTopology::setAffinity(others);
+            }
+            volatile uint64_t x = static_cast<uint64_t>(i);
+            while (!stop.load(std::memory_order_relaxed)) x = x * 6364136223846793005ULL + 1;
+        });
+    }
+
+    std::vector<double> late_us;
+    std::thread loop([&] {
+        if (pinned) {
+            ThreadTopology::instance().set("bench", ThreadPolicy{{cfg.cpu}, cfg.fifo});
+        }
+        ThreadTopology::instance().applyToCurrentThread(pinned ? "bench" : "bench-free", pinned ? "pinned" : "unpinned");
+        const int64_t period = static_cast<int64_t>(1e9 / cfg.rate_hz);
+        const int64_t n = static_cast<int64_t>(cfg.seconds * cfg.rate_hz);
+        late_us.reserve(static_cast<size_t>(n));
+        int64_t next = now_ns() + period;
+        for (int64_t k = 0; k < n; k++) {
+            timespec ts{static_cast<time_t>(next / 1000000000LL), static_cast<long>(next % 1000000000LL)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+            late_us.push_back((now_ns() - next) * 1e-3);
+            next += period;
+        }
+        for (const auto& s : ThreadTopology::instance().stats())
+            if (s.tid == ThreadTopology::currentTid()) st = s;
+    });
+    loop.join();
+    stop = true;
+    for (auto& t : load) t.join();
+    return bench_percentiles(late_us);
+}
+
+void print_row(const char* label, const BenchPercentiles& p, const ThreadStats& st) {
+    std::cout << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << p.p50 << std::setw(10) << p.p99 << std::setw(10) << p.max
+              << std::setw(10) << st.voluntary_cs << std::setw(10) << st.involuntary_cs << "\n";
+}
+
+} // namespace
+
+int bench_jitter(int argc, char** argv) {
+    JitterConfig cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--rate" && i+1<argc) cfg.rate_hz = atof(argv[++i]);
+        else if (a == "--seconds" && i+1<argc) cfg.seconds = atof(argv[++i]);
+        else if (a == "--cpu" && i+1<argc) cfg.cpu = atoi(argv[++i]);
+        else if (a == "--fifo" && i+1<argc) cfg.fifo = atoi(argv[++i]);
+        else if (a == "--load-threads" && i+1<argc) cfg.load_threads = atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: jitter [--rate HZ] [--seconds S] [--cpu N] [--fifo PRIO] [--load-threads N]\n";
+            return 1;
+        }
+    }
+    const int ncpu = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+    if (cfg.cpu < 0) cfg.cpu = ncpu - 1;
+    if (cfg.load_threads < 0) cfg.load_threads = ncpu;
+    if (cfg.rate_hz <= 0 || cfg.seconds <= 0) { std::cerr << "rate and seconds must be positive\n"; return 1; }
+
+    std::cout << "Jitter: " << cfg.rate_hz << " Hz for " << cfg.seconds << " s, " << cfg.load_threads
+              << " load threads, pinned run on CPU " << cfg.cpu
+              << (cfg.fifo > 0 ? " SCHED_FIFO " + std::to_string(cfg.fifo) : std::string(" SCHED_OTHER")) << "\n";
+    std::cout << "run        p50[us]   p99[us]   max[us]    vol_cs  invol_cs\n";
+    ThreadStats st;
+    print_row("unpinned", run_once(cfg, false, st), st);
+    st = ThreadStats();
+    print_row("pinned", run_once(cfg, true, st), st);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "bench.h"
+#include "../processing/param_tuner.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// How far can LK be cut back once it is seeded with a Kalman prediction?
+// Replays a fast synthetic clip (large sweep + vibration) through the tracker
+// with EMA smoothing and with the Kalman filter. Reference: the default LK
+// setting with EMA. For each knob (maxLevel, winSize, iterations) it reports
+// the smallest value, other knobs at default, whose miss rate stays within
+// tolerance of the reference, then the cheapest full combination.
+
+namespace {
+
+void row(const char* mode, const TunerResult& r) {
+    std::cout << std::left << std::setw(8) << mode << std::right
+              << std::setw(5) << r.params.lk_max_level << std::setw(5) << r.params.lk_win_size
+              << std::setw(6) << r.params.lk_iters << std::fixed
+              << std::setw(10) << std::setprecision(3) << r.cost_ms_mean
+              << std::setw(9) << r.err_px
+              << std::setw(9) << std::setprecision(4) << r.miss_rate
+              << std::setw(10) << std::setprecision(1) << r.vel_err << "\n";
+}
+
+const char* kRowHeader = "mode      lvl  win iters   cost_ms   err_px     miss   vel_err\n";
+
+} // namespace
+
+int bench_kalman(int argc, char** argv) {
+    SyntheticSource::Config sc;
+    sc.sweep_px_x = 150;
+    sc.sweep_px_y = 60;
+    sc.sweep_hz = 2.0;
+    int frames = 900;
+    double tol = 0.005;
+    double miss_px = 3.0;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--sweep-px" && i+1<argc) sc.sweep_px_x = atof(argv[++i]);
+        else if (a == "--sweep-hz" && i+1<argc) sc.sweep_hz = atof(argv[++i]);
+        else if (a == "--tol" && i+1<argc) tol = atof(argv[++i]);
+        else if (a == "--miss-px" && i+1<argc) miss_px = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: kalman [--frames N] [--sweep-px PX] [--sweep-hz HZ] [--tol RATE] [--miss-px PX]\n";
+            return 1;
+        }
+    }
+
+    TunerClip clip;
+    make_synthetic_clip(sc, frames, clip);
+    if (clip.frames.empty()) { std::cerr << "synthetic clip failed\n"; return 1; }
+    const double peak = 2 * 3.14159265 * sc.sweep_hz * sc.sweep_px_x / sc.fps;
+    std::cout << "Clip: " << clip.frames.size() << " frames, peak sweep " << std::setprecision(1) << std::fixed
+              << peak << " px/frame, miss = lost or > " << miss_px << " px\n\n";
+
+    TrackerParams base;
+    TunerResult ref = evaluate_params(clip, base, 10, miss_px);
+    const double target = ref.miss_rate + tol;
+    std::cout << kRowHeader;
+    row("ref", ref);
+
+    const std::vector<int> levels{0, 1, 2, 3}, wins{5, 7, 9, 11, 15, 21}, iters{2, 3, 5, 10, 20};
+    std::cout << "\nSmallest value per knob (others at default) with miss <= " << std::setprecision(4) << target << ":\n"
+              << kRowHeader;
+    for (int kal = 0; kal < 2; kal++) {
+        const char* mode = kal ? "kalman" : "ema";
+        TrackerParams p = base;
+        p.kalman.enabled = kal != 0;
+        for (int knob = 0; knob < 3; knob++) {
+            const auto& vals = knob == 0 ? levels : knob == 1 ? wins : iters;
+            for (int v : vals) {
+                TrackerParams q = p;
+                (knob == 0 ? q.lk_max_level : knob == 1 ? q.lk_win_size : q.lk_iters) = v;
+                TunerResult r = evaluate_params(clip, q, 10, miss_px);
+                if (r.miss_rate <= target) { row(mode, r); break; }
+            }
+        }
+    }
+
+    std::cout << "\nCheapest combination with miss <= " << target << ":\n" << kRowHeader;
+    for (int kal = 0; kal < 2; kal++) {
+        TunerResult best;
+        bool found = false;
+        for (int l : levels)
+            for (int w : wins)
+                for (int it : iters) {
+                    TrackerParams q = base;
+                    q.kalman.enabled = kal != 0;
+                    q.lk_max_level = l; q.lk_win_size = w; q.lk_iters = it;
+                    TunerResult r = evaluate_params(clip, q, 10, miss_px);
+                    if (r.miss_rate <= target && (!found || r.cost_ms_mean < best.cost_ms_mean)) { best = r; found = true; }
+                }
+        if (found) row(kal ? "kalman" : "ema", best);
+        else std::cout << (kal ? "kalman" : "ema") << ": no combination reached the target\n";
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include "bench.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+struct BenchEntry {
+    const char* name;
+    int (*fn)(int, char**);
+    const char* help;
+};
+
+const BenchEntry kBenches[] = {
+    {"jitter", bench_jitter, "wake-up jitter of a 120 Hz loop, unpinned vs pinned/SCHED_FIFO"},
+    {"gate", bench_gate, "motion gate SAD kernel cost and skip ratio on synthetic clips"},
+    {"kalman", bench_kalman, "LK level/window/iteration reduction with Kalman-seeded initial flow"},
+    {"points", bench_points, "re-detections and per-frame cost vs LK points per quadrant"},
+    {"homography", bench_homography, "homography (ECC) tracking mode vs the LK path"},
+    {"spectrum", bench_spectrum, "streaming vibration spectrum cost per frame and accuracy"},
+    {"bus", bench_bus, "frame bus fan-out: tracker drops and lag with a slow display, inline vs subscribed"},
+    {"alloc", bench_alloc, "steady-state heap allocations per frame vs budget (TRACKER_ALLOC_TRACE build)"},
+    {"startup", bench_startup, "cold-start time to first tracked frame, lazy init vs parallel warm-up"},
+    {"pose", bench_pose, "6-DOF pose solve cost and accuracy, warm-started vs cold"},
+    {"undistort", bench_undistort, "point-space undistortion lookup grid vs undistortPoints vs full-frame remap"},
+    {"tiles", bench_tiles, "tiled parallel marker detection: latency vs tile grid and threads at high resolutions"},
+    {"quality", bench_quality, "quality gate: Laplacian/exposure check cost and detections saved on blurry clips"},
+    {"redetect", bench_redetect, "fixed re-detection cadence vs confidence-driven scheduling: detections, drift, cost"},
+    {"pyramid", bench_pyramid, "CPU LK throughput vs pyramid pipeline workers (pyramids built ahead, consumed in order)"},
+    {"serialize", bench_serialize, "TrackerState CSV/JSON/binary writers (state_schema) vs ostringstream formatting"},
+};
+
+void usage() {
+    std::cerr << "Usage: jetson_motion_bench <benchmark> [options]\n\nBenchmarks:\n";
+    for (const auto& b : kBenches) std::cerr << "  " << b.name << "\t" << b.help << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) { usage(); return 1; }
+    for (const auto& b : kBenches)
+        if (std::strcmp(argv[1], b.name) == 0) return b.fn(argc - 1, argv + 1);
+    usage();
+    return 1;
+}
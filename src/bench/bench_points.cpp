@@ -0,0 +1,58 @@
+#include "bench.h"
+#include "../processing/param_tuner.h"
+#include "../util/metrics.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Points per quadrant (K) vs re-detections and per-frame cost. Each K
+// replays the same synthetic clip; "forced" counts re-detections caused by
+// a quadrant losing all of its points (the rest are the periodic cadence).
+
+int bench_points(int argc, char** argv) {
+    SyntheticSource::Config sc;
+    int frames = 900;
+    std::vector<int> ks{1, 2, 4, 8, 16};
+    bool kalman = false;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--vib-px" && i+1<argc) sc.vib_px = atof(argv[++i]);
+        else if (a == "--noise" && i+1<argc) sc.noise_sigma = atof(argv[++i]);
+        else if (a == "--kalman") kalman = true;
+        else if (a == "--k" && i+1<argc) {
+            ks.clear();
+            std::stringstream ss(argv[++i]);
+            std::string v;
+            while (std::getline(ss, v, ',')) ks.push_back(atoi(v.c_str()));
+        } else {
+            std::cerr << "Usage: points [--frames N] [--vib-px PX] [--noise SIGMA] [--kalman] [--k 1,2,4,...]\n";
+            return 1;
+        }
+    }
+
+    TunerClip clip;
+    make_synthetic_clip(sc, frames, clip);
+    if (clip.frames.empty()) { std::cerr << "synthetic clip failed\n"; return 1; }
+
+    Counter& forced = MetricsRegistry::instance().counter("tracker_redetect_forced_total",
+        "Re-detections triggered by a quadrant losing all its points");
+
+    std::cout << "Clip: " << clip.frames.size() << " synthetic frames\n"
+              << "    K  detects  forced   cost_ms    p95_ms   err_px     miss\n";
+    for (int k : ks) {
+        TrackerParams p;
+        p.points_per_quadrant = k;
+        p.kalman.enabled = kalman;
+        uint64_t f0 = forced.value();
+        TunerResult r = evaluate_params(clip, p);
+        std::cout << std::setw(5) << k << std::setw(9) << r.detections << std::setw(8) << (forced.value() - f0)
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(10) << r.cost_ms_mean << std::setw(10) << r.cost_ms_p95
+                  << std::setw(9) << r.err_px << std::setw(9) << std::setprecision(4) << r.miss_rate << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "bench.h"
+#include "../processing/pose_estimator.h"
+
+#include <opencv2/calib3d.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Pose stage cost, warm-started vs cold. A marker at --distance-mm vibrates
+// (translation and a small tilt) in front of a pinhole camera; the quadrant
+// centres are projected with --noise-px of Gaussian noise and solved each
+// frame. Cold runs the full iterative solve every frame; warm refines the
+// previous pose with --iters LM steps. Reported: per-frame solve time and
+// translation / velocity error against the true trajectory.
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+struct Truth {
+    cv::Point3d t, v;
+    double rx, ry;
+};
+
+Truth truth_at(double s, double dist_mm, double amp_mm, double hz) {
+    const double w = 2 * M_PI * hz;
+    Truth r;
+    r.t = cv::Point3d(amp_mm * std::sin(w * s), 0.5 * amp_mm * std::sin(0.7 * w * s), dist_mm + amp_mm * std::cos(0.3 * w * s));
+    r.v = cv::Point3d(amp_mm * w * std::cos(w * s), 0.5 * amp_mm * 0.7 * w * std::cos(0.7 * w * s),
+                      -amp_mm * 0.3 * w * std::sin(0.3 * w * s));
+    r.rx = 0.15 + 0.05 * std::sin(0.5 * w * s);
+    r.ry = -0.1 + 0.05 * std::cos(0.4 * w * s);
+    return r;
+}
+
+cv::Mat vec3(double a, double b, double c) {
+    cv::Mat m(3, 1, CV_64F);
+    m.at<double>(0) = a;
+    m.at<double>(1) = b;
+    m.at<double>(2) = c;
+    return m;
+}
+
+} // namespace
+
+int bench_pose(int argc, char** argv) {
+    int frames = 2400, iters = 3;
+    double fps = 120, dist_mm = 400, amp_mm = 5, hz = 8, noise_px = 0.1, marker_mm = 50;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--iters" && i+1<argc) iters = atoi(argv[++i]);
+        else if (a == "--distance-mm" && i+1<argc) dist_mm = atof(argv[++i]);
+        else if (a == "--amp-mm" && i+1<argc) amp_mm = atof(argv[++i]);
+        else if (a == "--hz" && i+1<argc) hz = atof(argv[++i]);
+        else if (a == "--noise-px" && i+1<argc) noise_px = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: pose [--frames N] [--iters N] [--distance-mm D] [--amp-mm A] [--hz F] [--noise-px S]\n";
+            return 1;
+        }
+    }
+
+    CameraCalibration calib;
+    calib.K = cv::Mat::zeros(3, 3, CV_64F);
+    calib.K.at<double>(0, 0) = calib.K.at<double>(1, 1) = 800;
+    calib.K.at<double>(0, 2) = 320;
+    calib.K.at<double>(1, 2) = 240;
+    calib.K.at<double>(2, 2) = 1;
+    calib.size = cv::Size(640, 480);
+
+    // marker plane as in PoseEstimator::setMarker: centre origin, y up
+    const float h = static_cast<float>(marker_mm / 2), qd = h / 2;
+    const std::vector<cv::Point3f> corners3 = {{-h, h, 0}, {h, h, 0}, {h, -h, 0}, {-h, -h, 0}};
+    const std::vector<cv::Point3f> quads3 = {{-qd, qd, 0}, {qd, qd, 0}, {-qd, -qd, 0}, {qd, -qd, 0}};
+
+    // pre-project the whole clip so only the solve is timed
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, noise_px);
+    std::vector<std::vector<cv::Point2f>> quad_img(frames);
+    std::vector<Truth> truth(frames);
+    std::vector<cv::Point2f> corner_img;
+    for (int k = 0; k < frames; k++) {
+        truth[k] = truth_at(k / fps, dist_mm, amp_mm, hz);
+        cv::Mat rv = vec3(truth[k].rx, truth[k].ry, 0), tv = vec3(truth[k].t.x, truth[k].t.y, truth[k].t.z);
+        cv::projectPoints(quads3, rv, tv, calib.K, cv::Mat(), quad_img[k]);
+        for (auto& p : quad_img[k]) p += cv::Point2f(static_cast<float>(noise(rng)), static_cast<float>(noise(rng)));
+        if (k == 0) cv::projectPoints(corners3, rv, tv, calib.K, cv::Mat(), corner_img);
+    }
+    if (corner_img.size() != 4 || quad_img[0].size() != 4) { std::cerr << "pose: projection failed\n"; return 1; }
+    const cv::Point2f c0[4] = {corner_img[0], corner_img[1], corner_img[2], corner_img[3]};
+
+    std::cout << "Marker " << marker_mm << " mm at " << dist_mm << " mm, +-" << amp_mm << " mm at " << hz
+              << " Hz, " << fps << " fps, noise " << noise_px << " px, " << frames << " frames\n"
+              << "mode        p50[us]  p99[us]  mean[us]   t_err[mm]  v_err[mm/s]  warm/cold\n" << std::fixed;
+    for (int warm = 0; warm < 2; warm++) {
+        PoseParams pp;
+        pp.enabled = true;
+        pp.marker_mm = marker_mm;
+        pp.warm_start = warm != 0;
+        pp.refine_iters = iters;
+        PoseEstimator est;
+        est.setCalibration(calib);
+        est.setMarker(c0, quad_img[0].data(), marker_mm);
+
+        PoseState st;
+        std::vector<double> us;
+        double t_err = 0, v_err = 0;
+        int n_t = 0, n_v = 0;
+        for (int k = 0; k < frames; k++) {
+            const uint64_t ts = static_cast<uint64_t>(k * 1e6 / fps);
+            auto t0 = clk::now();
+            bool ok = est.update(quad_img[k].data(), calib.size, ts, pp, st);
+            double dt_us = std::chrono::duration<double, std::micro>(clk::now() - t0).count();
+            if (k > 0) us.push_back(dt_us); // first solve is cold in both modes
+            if (!ok) continue;
+            cv::Point3d e = st.t - truth[k].t;
+            t_err += std::sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+            n_t++;
+            if (k > fps / 4) { // after the velocity EMA settles
+                cv::Point3d ev = st.vel - truth[k].v;
+                v_err += ev.x * ev.x + ev.y * ev.y + ev.z * ev.z;
+                n_v++;
+            }
+        }
+        BenchPercentiles p = bench_percentiles(us);
+        const auto& s = est.stats();
+        std::cout << std::left << std::setw(10) << (warm ? "warm" : "cold") << std::right << std::setprecision(1)
+                  << std::setw(9) << p.p50 << std::setw(9) << p.p99 << std::setw(10) << p.mean
+                  << std::setw(12) << std::setprecision(3) << (n_t ? t_err / n_t : 0.0)
+                  << std::setw(13) << std::setprecision(2) << (n_v ? std::sqrt(v_err / n_v) : 0.0)
+                  << "  " << s.warm << "/" << s.cold << (s.failed ? "  failed " + std::to_string(s.failed) : "")
+                  << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include "bench.h"
+#include "../processing/aruco_tracker.h"
+#include "../processing/param_tuner.h"
+#include "../processing/pyramid_pipeline.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// CPU LK throughput against the number of pyramid workers. A synthetic clip
+// at --width x --height is replayed through ArucoTracker with
+// lk_backend = cpu: once with pyramids built inline on the tracking thread,
+// then through PyramidPipeline with 1..--max-workers workers feeding the
+// tracker in order. Reported: sustained frames/s, per-frame tracking cost,
+// out-of-order completions absorbed by the reorder ring, pool buffers and
+// the position error (identical rows mean frame order was preserved).
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+double ms_since(clk::time_point t0) {
+    return std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+}
+
+struct Run {
+    double fps = 0;
+    BenchPercentiles track_ms;
+    double err_px = 0;
+    PyramidPipeline::Stats ps;
+};
+
+void accumulate_error(const TrackerState& st, const TunerClip& clip, size_t k, double& sum, int& n) {
+    if (k >= clip.ref.size() || !clip.ref_valid[k] || !st.tracking) return;
+    for (int q = 0; q < 4; q++) {
+        if (!st.q[q].valid) continue;
+        const cv::Point2f d = st.q[q].motion.pos - clip.ref[k][q];
+        sum += std::sqrt(d.x * d.x + d.y * d.y);
+        n++;
+    }
+}
+
+Run replay(const TunerClip& clip, const TrackerParams& p, int workers, int depth) {
+    ArucoTracker tracker(p);
+    tracker.setOptions({false, false, false});
+    tracker.warmUp(clip.frames[0].size());
+    std::vector<double> cost;
+    cost.reserve(clip.frames.size());
+    double err_sum = 0;
+    int err_n = 0;
+    Run r;
+
+    auto t0 = clk::now();
+    if (workers == 0) {
+        for (size_t k = 0; k < clip.frames.size(); k++) {
+            auto tp = clk::now();
+            tracker.process(clip.frames[k], clip.ts[k]);
+            cost.push_back(ms_since(tp));
+            accumulate_error(tracker.state(), clip, k, err_sum, err_n);
+        }
+    } else {
+        PyramidPipeline::Config pc;
+        pc.workers = workers;
+        pc.depth = depth > 0 ? depth : workers + 2;
+        pc.win_size = p.lk_win_size;
+        pc.max_level = p.lk_max_level;
+        PyramidPipeline pipe(pc);
+        std::thread feed([&]{
+            for (size_t k = 0; k < clip.frames.size(); k++)
+                if (!pipe.push(clip.frames[k], clip.ts[k])) break;
+            pipe.close();
+        });
+        PyramidPipeline::Item item;
+        for (size_t k = 0; pipe.pop(item); k++) {
+            auto tp = clk::now();
+            tracker.process(item.frame, item.ts_us, std::move(item.pyr));
+            cost.push_back(ms_since(tp));
+            accumulate_error(tracker.state(), clip, k, err_sum, err_n);
+        }
+        feed.join();
+        r.ps = pipe.stats();
+    }
+    r.fps = clip.frames.size() / (ms_since(t0) / 1e3);
+    r.track_ms = bench_percentiles(cost);
+    r.err_px = err_n ? err_sum / err_n : 0;
+    return r;
+}
+
+} // namespace
+
+int bench_pyramid(int argc, char** argv) {
+    SyntheticSource::Config sc;
+    sc.width = 1280;
+    sc.height = 720;
+    int frames = 1200, max_workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency())), depth = 0;
+    TrackerParams p;
+    p.lk_backend = LkBackend::Cpu;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--width" && i+1<argc) sc.width = atoi(argv[++i]);
+        else if (a == "--height" && i+1<argc) sc.height = atoi(argv[++i]);
+        else if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--max-workers" && i+1<argc) max_workers = atoi(argv[++i]);
+        else if (a == "--depth" && i+1<argc) depth = atoi(argv[++i]);
+        else if (a == "--win" && i+1<argc) p.lk_win_size = atoi(argv[++i]);
+        else if (a == "--levels" && i+1<argc) p.lk_max_level = atoi(argv[++i]);
+        else if (a == "--points" && i+1<argc) p.points_per_quadrant = atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: pyramid [--width W] [--height H] [--frames N] [--max-workers N] [--depth N]"
+                         " [--win PX] [--levels N] [--points K]\n";
+            return 1;
+        }
+    }
+    sc.marker_px = std::min(sc.height / 3, 240);
+
+    TunerClip clip;
+    make_synthetic_clip(sc, frames, clip);
+    if (clip.frames.empty()) { std::cerr << "synthetic clip failed\n"; return 1; }
+
+    // the stage being moved off the tracking thread, alone
+    std::vector<double> build_ms;
+    FramePyramid fp;
+    const cv::Size win(p.lk_win_size, p.lk_win_size);
+    for (size_t k = 0; k < std::min<size_t>(clip.frames.size(), 300); k++) {
+        auto t0 = clk::now();
+        build_lk_pyramid(clip.frames[k], fp, win, p.lk_max_level);
+        build_ms.push_back(ms_since(t0));
+    }
+    const BenchPercentiles b = bench_percentiles(build_ms);
+    std::cout << sc.width << "x" << sc.height << ", " << clip.frames.size() << " frames, LK win " << p.lk_win_size
+              << " levels " << p.lk_max_level << ", " << p.points_per_quadrant << " pt/quadrant\n"
+              << std::fixed << std::setprecision(3) << "pyramid + gradients alone: p50 " << b.p50 << " ms, p99 "
+              << b.p99 << " ms (" << std::setprecision(0) << 1e3 / std::max(1e-6, b.mean) << " fps on one thread)\n\n"
+              << "workers      fps  track_p50[ms]  track_p99[ms]  out-of-order  buffers  err_px\n";
+
+    for (int w = 0; w <= max_workers; w++) {
+        Run r = replay(clip, p, w, depth);
+        std::cout << std::left << std::setw(8) << (w ? std::to_string(w) : std::string("inline")) << std::right
+                  << std::setprecision(0) << std::setw(9) << r.fps << std::setprecision(3)
+                  << std::setw(15) << r.track_ms.p50 << std::setw(15) << r.track_ms.p99
+                  << std::setw(14) << r.ps.reordered << std::setw(9) << r.ps.pool_allocated
+                  << std::setw(8) << r.err_px << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "bench.h"
+#include "../processing/quality_gate.h"
+#include "../pipeline/synthetic_source.h"
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Quality gate cost and effect. Part 1 times the Laplacian kernel against a
+// plain scalar loop and the whole check per frame (marker ROI and full
+// frame). Part 2 replays a synthetic clip with bursts of motion blur and
+// overexposure through a simplified detection schedule (detect when lost or
+// every --interval frames; a bad frame between detections loses the track,
+// as LK does on a smeared marker) with and without the gate, and counts the
+// detectMarkers calls, failed ones and their time.
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+void lap_scalar(const uint8_t* up, const uint8_t* row, const uint8_t* down, size_t n, int64_t& sum, uint64_t& sumsq) {
+    sum = 0;
+    sumsq = 0;
+    for (size_t x = 1; x + 1 < n; x++) {
+        const int lap = 4 * row[x] - row[x - 1] - row[x + 1] - up[x] - down[x];
+        sum += lap;
+        sumsq += static_cast<uint64_t>(lap * lap);
+    }
+}
+
+template <typename F>
+double time_ns_per_px(F fn, const std::vector<uint8_t>& img, size_t w, int reps) {
+    volatile uint64_t sink = 0;
+    const size_t rows = img.size() / w;
+    auto t0 = clk::now();
+    for (int r = 0; r < reps; r++)
+        for (size_t y = 1; y + 1 < rows; y++) {
+            int64_t s;
+            uint64_t q;
+            fn(&img[(y - 1) * w], &img[y * w], &img[(y + 1) * w], w, s, q);
+            sink = sink + q;
+        }
+    double s = std::chrono::duration<double>(clk::now() - t0).count();
+    return s * 1e9 / (static_cast<double>(reps) * (rows - 2) * w);
+}
+
+enum Defect { None, Blur, Over };
+
+struct RunResult {
+    int detect_calls = 0, detect_failed = 0, rejected = 0, bad_rejected = 0, good_rejected = 0;
+    double detect_ms = 0, gate_us = 0;
+};
+
+RunResult run(const std::vector<cv::Mat>& clip, const std::vector<Defect>& defect, const std::vector<cv::Rect>& roi,
+              bool use_gate, const QualityGateParams& qp, int interval) {
+    auto dict = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    QualityGate gate(qp);
+    RunResult r;
+    bool tracking = false;
+    std::vector<int> ids;
+    std::vector<std::vector<cv::Point2f>> corners;
+    for (size_t k = 0; k < clip.size(); k++) {
+        if (use_gate) {
+            FrameQuality fq;
+            auto t0 = clk::now();
+            bool ok = gate.check(clip[k], tracking ? roi[k] : cv::Rect(), fq);
+            r.gate_us += std::chrono::duration<double, std::micro>(clk::now() - t0).count();
+            if (!ok) {
+                r.rejected++;
+                (defect[k] != None ? r.bad_rejected : r.good_rejected)++;
+                continue; // prediction carried, nothing else runs
+            }
+        }
+        if (!tracking || k % static_cast<size_t>(interval) == 0) {
+            auto t0 = clk::now();
+            cv::aruco::detectMarkers(clip[k], dict, corners, ids);
+            r.detect_ms += std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+            r.detect_calls++;
+            tracking = !ids.empty();
+            if (!tracking) r.detect_failed++;
+        } else if (defect[k] != None) {
+            tracking = false; // LK on the bad frame loses the points
+        }
+    }
+    return r;
+}
+
+} // namespace
+
+int bench_quality(int argc, char** argv) {
+    int frames = 600, interval = 20, blur_px = 21;
+    double burst_rate = 0.03;
+    QualityGateParams qp;
+    qp.enabled = true;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--interval" && i+1<argc) interval = std::max(1, atoi(argv[++i]));
+        else if (a == "--blur-px" && i+1<argc) blur_px = atoi(argv[++i]);
+        else if (a == "--burst-rate" && i+1<argc) burst_rate = atof(argv[++i]);
+        else if (a == "--blur-ratio" && i+1<argc) qp.blur_ratio = atof(argv[++i]);
+        else if (a == "--decimation" && i+1<argc) qp.decimation = atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: quality [--frames N] [--interval N] [--blur-px L] [--burst-rate P] [--blur-ratio R] [--decimation N]\n";
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> img(160 * 160);
+    std::mt19937 rng(5);
+    for (auto& v : img) v = static_cast<uint8_t>(rng());
+    const int reps = 5000;
+    double simd = time_ns_per_px(QualityGate::laplacian_moments, img, 160, reps);
+    double scalar = time_ns_per_px(lap_scalar, img, 160, reps);
+    std::cout << "Laplacian kernel (160 px rows): simd " << std::fixed << std::setprecision(3) << simd
+              << " ns/px, scalar " << scalar << " ns/px (x" << std::setprecision(1) << scalar / simd << ")\n";
+
+    // Clip: bursts of 3..8 frames, motion blur (horizontal line kernel) or overexposure
+    SyntheticSource::Config sc;
+    sc.frames = frames;
+    SyntheticSource src(sc);
+    if (!src.open()) { std::cerr << "quality: synthetic source failed\n"; return 1; }
+    std::vector<cv::Mat> clip;
+    std::vector<Defect> defect;
+    std::vector<cv::Rect> roi;
+    cv::Mat f, kernel = cv::Mat::zeros(1, std::max(3, blur_px), CV_32F);
+    kernel.setTo(cv::Scalar(1.0 / kernel.cols));
+    std::uniform_real_distribution<double> u01(0, 1);
+    std::uniform_int_distribution<int> burst_len(3, 8);
+    uint64_t ts = 0;
+    int left = 0;
+    Defect cur = None;
+    while (src.grab(f, ts)) {
+        if (left == 0 && u01(rng) < burst_rate) {
+            left = burst_len(rng);
+            cur = u01(rng) < 0.7 ? Blur : Over;
+        }
+        Defect d = left > 0 ? cur : None;
+        if (left > 0) left--;
+        cv::Mat out;
+        if (d == Blur) cv::filter2D(f, out, -1, kernel);
+        else if (d == Over) f.convertTo(out, -1, 2.5, 60);
+        else out = f.clone();
+        clip.push_back(out);
+        defect.push_back(d);
+        const float half = sc.marker_px * 0.5f;
+        const auto& t = src.truth();
+        roi.emplace_back(cv::Point(int(t.center.x - half), int(t.center.y - half)), cv::Size(sc.marker_px, sc.marker_px));
+    }
+    int n_bad = 0;
+    for (Defect d : defect) n_bad += d != None;
+
+    // per-frame check cost, ROI and full frame
+    QualityGate g(qp);
+    FrameQuality fq;
+    std::vector<double> t_roi, t_full;
+    for (size_t k = 0; k < clip.size(); k++) {
+        auto t0 = clk::now();
+        g.check(clip[k], roi[k], fq);
+        t_roi.push_back(std::chrono::duration<double, std::micro>(clk::now() - t0).count());
+        t0 = clk::now();
+        g.check(clip[k], cv::Rect(), fq);
+        t_full.push_back(std::chrono::duration<double, std::micro>(clk::now() - t0).count());
+    }
+    BenchPercentiles pr = bench_percentiles(t_roi), pf = bench_percentiles(t_full);
+    std::cout << "check per frame, " << sc.width << "x" << sc.height << ", decimation " << qp.decimation
+              << ": ROI p50 " << std::setprecision(1) << pr.p50 << " us (p99 " << pr.p99 << "), full frame p50 "
+              << pf.p50 << " us (p99 " << pf.p99 << ")\n\n";
+
+    std::cout << clip.size() << " frames, " << n_bad << " bad (blur " << blur_px << " px / overexposed), detect every "
+              << interval << " frames\n"
+              << "gate   detect  failed  detect[ms]  rejected  bad-hit  good-rej  gate[us/f]\n";
+    for (int use = 0; use < 2; use++) {
+        RunResult r = run(clip, defect, roi, use != 0, qp, interval);
+        std::cout << std::left << std::setw(5) << (use ? "on" : "off") << std::right
+                  << std::setw(8) << r.detect_calls << std::setw(8) << r.detect_failed
+                  << std::setw(12) << std::setprecision(1) << r.detect_ms
+                  << std::setw(10) << r.rejected << std::setw(8) << r.bad_rejected << "/" << n_bad
+                  << std::setw(9) << r.good_rejected
+                  << std::setw(12) << std::setprecision(2) << (use ? r.gate_us / clip.size() : 0.0) << "\n";
+    }
+    return 0;
+}
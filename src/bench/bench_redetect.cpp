@@ -0,0 +1,122 @@
+#include "bench.h"
+#include "../processing/param_tuner.h"
+#include "../util/metrics.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Fixed re-detection cadence vs confidence-driven scheduling. The same
+// synthetic clip is replayed with redetect_interval = 10/20/40/80 and with
+// the adaptive scheduler at several confidence thresholds (with and without
+// the forward-backward check). Reported: detections, position error (drift
+// between detections shows up here), miss rate and per-frame cost. The
+// summary compares each adaptive run with the cheapest fixed cadence that is
+// at least as accurate.
+
+namespace {
+
+std::vector<double> parse_list(const std::string& s) {
+    std::vector<double> out;
+    std::stringstream ss(s);
+    std::string v;
+    while (std::getline(ss, v, ',')) out.push_back(atof(v.c_str()));
+    return out;
+}
+
+} // namespace
+
+int bench_redetect(int argc, char** argv) {
+    SyntheticSource::Config sc;
+    int frames = 1800, max_interval = 120;
+    bool kalman = false;
+    std::vector<double> thresholds{0.3, 0.5, 0.7};
+    std::vector<double> intervals{10, 20, 40, 80};
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--vib-px" && i+1<argc) sc.vib_px = atof(argv[++i]);
+        else if (a == "--noise" && i+1<argc) sc.noise_sigma = atof(argv[++i]);
+        else if (a == "--kalman") kalman = true;
+        else if (a == "--max-interval" && i+1<argc) max_interval = atoi(argv[++i]);
+        else if (a == "--thresholds" && i+1<argc) thresholds = parse_list(argv[++i]);
+        else if (a == "--intervals" && i+1<argc) intervals = parse_list(argv[++i]);
+        else {
+            std::cerr << "Usage: redetect [--frames N] [--vib-px PX] [--noise SIGMA] [--kalman] [--max-interval N]"
+                         " [--thresholds 0.3,0.5] [--intervals 10,20,40]\n";
+            return 1;
+        }
+    }
+
+    TunerClip clip;
+    make_synthetic_clip(sc, frames, clip);
+    if (clip.frames.empty()) { std::cerr << "synthetic clip failed\n"; return 1; }
+
+    auto& reg = MetricsRegistry::instance();
+    Counter& low_conf = reg.counter("tracker_redetect_low_confidence_total", "Re-detections triggered by low track confidence");
+    Counter& fb_rej = reg.counter("tracker_lk_fb_rejected_total", "LK points dropped by the forward-backward check");
+
+    std::cout << "Clip: " << clip.frames.size() << " synthetic frames, noise " << sc.noise_sigma << ", vib "
+              << sc.vib_px << " px" << (kalman ? ", Kalman seed" : "") << "\n"
+              << "schedule          detects  low-conf  fb-drop   err_px     miss   cost_ms\n";
+    struct Row {
+        std::string name;
+        TunerResult r;
+        bool adaptive;
+    };
+    std::vector<Row> rows;
+    auto run = [&](const std::string& name, const TrackerParams& p) {
+        const uint64_t lc0 = low_conf.value(), fb0 = fb_rej.value();
+        TunerResult r = evaluate_params(clip, p);
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(9) << r.detections
+                  << std::setw(10) << (low_conf.value() - lc0) << std::setw(9) << (fb_rej.value() - fb0)
+                  << std::fixed << std::setprecision(3) << std::setw(9) << r.err_px
+                  << std::setw(9) << std::setprecision(4) << r.miss_rate
+                  << std::setw(10) << std::setprecision(3) << r.cost_ms_mean << "\n";
+        rows.push_back({name, r, p.redetect.adaptive});
+    };
+
+    for (double iv : intervals) {
+        TrackerParams p;
+        p.kalman.enabled = kalman;
+        p.redetect_interval = static_cast<int>(iv);
+        run("every " + std::to_string(p.redetect_interval), p);
+    }
+    for (int fb = 1; fb >= 0; fb--)
+        for (double th : thresholds) {
+            TrackerParams p;
+            p.kalman.enabled = kalman;
+            p.redetect.adaptive = true;
+            p.redetect.min_confidence = th;
+            p.redetect.max_interval = max_interval;
+            p.redetect.forward_backward = fb != 0;
+            std::ostringstream name;
+            name << "conf<" << std::setprecision(2) << th << (fb ? " fb" : "");
+            run(name.str(), p);
+        }
+
+    // Equal accuracy: the fixed cadence with the fewest detections that still
+    // matches the adaptive run's error
+    std::cout << "\n";
+    for (const Row& a : rows) {
+        if (!a.adaptive) continue;
+        const Row* best = nullptr;
+        for (const Row& f : rows)
+            if (!f.adaptive && f.r.err_px <= a.r.err_px * 1.05 && (!best || f.r.detections < best->r.detections)) best = &f;
+        std::cout << std::left << std::setw(16) << a.name << std::right;
+        if (!best) {
+            std::cout << "  more accurate than every fixed cadence tried\n";
+            continue;
+        }
+        // signed: adaptive can also need more detections than the cadence it matches
+        const int diff = best->r.detections - a.r.detections;
+        const int mag = std::abs(diff);
+        std::cout << "  vs " << best->name << ": " << a.r.detections << " vs " << best->r.detections << " detections, "
+                  << mag << (diff < 0 ? " extra (" : " saved (") << std::fixed << std::setprecision(1)
+                  << (best->r.detections ? 100.0 * mag / best->r.detections : 0.0)
+                  << "%), err " << std::setprecision(3) << a.r.err_px << " vs " << best->r.err_px << " px\n";
+    }
+    return 0;
+}
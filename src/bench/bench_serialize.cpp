@@ -0,0 +1,214 @@
+#include "bench.h"
+#include "../util/alloc_trace.h"
+#include "../util/state_schema.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+// TrackerState serialisation cost: the state_schema writers against the
+// ostringstream code they replaced (kept below as the baseline), per output:
+// CSV line, snapshot JSON, UDP JSON, and the binary UDP record (compared to
+// the UDP JSON it can stand in for). Records cycle through randomised states
+// with some quadrants, the pose and the quality check absent. Reported:
+// ns/record (median and p99 over batches), bytes/record, and heap
+// allocations per record in a TRACKER_ALLOC_TRACE build.
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+// --- stream baselines (the formatting in place before state_schema) ---
+
+void stream_pose_json(std::ostream& os, const PoseState& p) {
+    if (!p.valid) return;
+    os << ",\"pose\":{\"t\":[" << p.t.x << "," << p.t.y << "," << p.t.z << "],\"r\":["
+       << p.rvec[0] << "," << p.rvec[1] << "," << p.rvec[2] << "],\"v\":["
+       << p.vel.x << "," << p.vel.y << "," << p.vel.z << "],\"qv\":[";
+    for (int i = 0; i < 4; i++)
+        os << (i ? "," : "") << "[" << p.q_vel[i].x << "," << p.q_vel[i].y << "," << p.q_vel[i].z << "]";
+    os << "],\"reproj_px\":" << p.reproj_px << "}";
+}
+
+std::string stream_json(const TrackerState& st, uint64_t ts_us, bool positions) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2);
+    os << "{\"marker_id\":" << st.marker_id << ",\"ts_us\":" << ts_us << ",\"quadrants\":[";
+    for (int i = 0; i < 4; i++) {
+        const auto& q = st.q[i];
+        if (i) os << ",";
+        if (!q.valid) {
+            os << (positions ? "{\"valid\":false,\"cx\":null,\"cy\":null,\"vx\":null,\"vy\":null,\"ax\":null,\"ay\":null}"
+                             : "{\"valid\":false,\"vx\":null,\"vy\":null,\"ax\":null,\"ay\":null}");
+        } else {
+            const auto& m = q.motion;
+            os << "{\"valid\":true";
+            if (positions) os << ",\"cx\":" << m.pos.x << ",\"cy\":" << m.pos.y;
+            os << ",\"vx\":" << m.vel.x << ",\"vy\":" << m.vel.y << ",\"ax\":" << m.acc.x << ",\"ay\":" << m.acc.y << "}";
+        }
+    }
+    os << "]";
+    stream_pose_json(os, st.pose);
+    os << "}";
+    return os.str();
+}
+
+std::string stream_csv(const TrackerState& st, uint64_t ts_us) {
+    std::ostringstream os;
+    os.setf(std::ios::fixed); os.precision(3);
+    os << ts_us << "," << (st.tracking ? 1 : 0) << "," << st.marker_id
+       << "," << st.marker_bbox.x << "," << st.marker_bbox.y << "," << st.marker_bbox.width << "," << st.marker_bbox.height;
+    for (int i = 0; i < 4; i++) {
+        const auto& q = st.q[i];
+        os << "," << (q.valid ? 1 : 0);
+        if (q.valid) {
+            os << "," << q.motion.pos.x << "," << q.motion.pos.y << "," << q.motion.vel.x << "," << q.motion.vel.y
+               << "," << q.motion.acc.x << "," << q.motion.acc.y;
+        } else {
+            os << ",,,,,,";
+        }
+    }
+    const PoseState& p = st.pose;
+    os << "," << (p.valid ? 1 : 0);
+    if (p.valid) {
+        os << "," << p.t.x << "," << p.t.y << "," << p.t.z << "," << p.rvec[0] << "," << p.rvec[1] << "," << p.rvec[2]
+           << "," << p.vel.x << "," << p.vel.y << "," << p.vel.z;
+        for (int i = 0; i < 4; i++) os << "," << p.q_vel[i].x << "," << p.q_vel[i].y << "," << p.q_vel[i].z;
+    } else {
+        os << std::string(21, ',');
+    }
+    const FrameQuality& fq = st.quality;
+    if (fq.checked) os << "," << (fq.ok ? 1 : 0) << "," << fq.sharpness << "," << fq.clipped;
+    else os << ",,,";
+    os << "\n";
+    return os.str();
+}
+
+// --- workload ---
+
+std::vector<TrackerState> make_states(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(0, 1280), vel(-500, 500), acc(-20000, 20000), u(0, 1);
+    std::vector<TrackerState> out(n);
+    for (auto& st : out) {
+        st.tracking = true;
+        st.marker_id = 7;
+        st.marker_bbox = cv::Rect(static_cast<int>(pos(rng)), static_cast<int>(pos(rng)), 180, 180);
+        for (auto& q : st.q) {
+            q.valid = u(rng) > 0.1f;
+            q.motion.pos = {pos(rng), pos(rng)};
+            q.motion.vel = {vel(rng), vel(rng)};
+            q.motion.acc = {acc(rng), acc(rng)};
+        }
+        st.pose.valid = u(rng) > 0.3f;
+        st.pose.t = {vel(rng), vel(rng), 800 + vel(rng)};
+        st.pose.rvec = cv::Vec3d(u(rng), u(rng), u(rng));
+        st.pose.vel = {vel(rng), vel(rng), vel(rng)};
+        for (auto& v : st.pose.q_vel) v = {vel(rng), vel(rng), vel(rng)};
+        st.pose.reproj_px = u(rng);
+        st.quality.checked = u(rng) > 0.5f;
+        st.quality.sharpness = 1000 * u(rng);
+        st.quality.clipped = u(rng);
+    }
+    return out;
+}
+
+struct Result {
+    BenchPercentiles ns;
+    double bytes = 0;
+    double allocs = 0;
+};
+
+// `fn(state, ts)` returns the bytes produced; timed in batches of `batch` records
+template <typename Fn>
+Result measure(const std::vector<TrackerState>& states, int records, int batch, Fn&& fn) {
+    std::vector<double> per;
+    size_t bytes = 0;
+    const AllocCounters a0 = alloc_trace::thread_counters();
+    for (int done = 0; done < records; done += batch) {
+        auto t0 = clk::now();
+        for (int k = 0; k < batch; k++) {
+            const size_t idx = static_cast<size_t>(done + k) % states.size();
+            bytes += fn(states[idx], 1000000ULL + 8333ULL * static_cast<uint64_t>(done + k));
+        }
+        per.push_back(std::chrono::duration<double, std::nano>(clk::now() - t0).count() / batch);
+    }
+    const AllocCounters a = alloc_trace::thread_counters() - a0;
+    Result r;
+    r.ns = bench_percentiles(per);
+    r.bytes = static_cast<double>(bytes) / records;
+    r.allocs = static_cast<double>(a.allocs) / records;
+    return r;
+}
+
+void row(const char* format, const char* impl, const Result& r, double base_ns) {
+    std::cout << std::left << std::setw(10) << format << std::setw(10) << impl << std::right << std::fixed
+              << std::setprecision(0) << std::setw(10) << r.ns.p50 << std::setw(10) << r.ns.p99
+              << std::setw(9) << r.bytes;
+    if (alloc_trace::enabled()) std::cout << std::setprecision(2) << std::setw(9) << r.allocs;
+    else std::cout << std::setw(9) << "-";
+    if (base_ns > 0) std::cout << std::setprecision(1) << std::setw(8) << base_ns / std::max(1e-9, r.ns.p50) << "x";
+    std::cout << "\n";
+}
+
+} // namespace
+
+int bench_serialize(int argc, char** argv) {
+    int records = 200000, batch = 1000;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--records" && i+1<argc) records = atoi(argv[++i]);
+        else if (a == "--batch" && i+1<argc) batch = atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: serialize [--records N] [--batch N]\n";
+            return 1;
+        }
+    }
+    batch = std::max(1, batch);
+    records = std::max(batch, records);
+    const std::vector<TrackerState> states = make_states(4096, 42);
+    char buf[state_schema::kMaxText];
+    volatile size_t sink = 0; // keeps the stream results alive
+
+    using namespace state_schema;
+    std::cout << records << " records, binary record " << binary_record_size() << " B"
+              << (alloc_trace::enabled() ? "" : " (allocs/rec needs TRACKER_ALLOC_TRACE)") << "\n\n"
+              << "format    impl       ns_p50    ns_p99    bytes allocs/rec speedup\n";
+
+    const Result csv_s = measure(states, records, batch, [&](const TrackerState& st, uint64_t ts) {
+        std::string s = stream_csv(st, ts);
+        sink = sink + s.size();
+        return s.size();
+    });
+    const Result csv_w = measure(states, records, batch, [&](const TrackerState& st, uint64_t ts) {
+        return write_csv(buf, sizeof(buf), {st, ts}, false, std::string_view());
+    });
+    row("csv", "stream", csv_s, 0);
+    row("csv", "schema", csv_w, csv_s.ns.p50);
+
+    for (int udp = 0; udp < 2; udp++) {
+        const Result js = measure(states, records, batch, [&](const TrackerState& st, uint64_t ts) {
+            std::string s = stream_json(st, ts, !udp);
+            sink = sink + s.size();
+            return s.size();
+        });
+        const Result jw = measure(states, records, batch, [&](const TrackerState& st, uint64_t ts) {
+            return write_json(buf, sizeof(buf), {st, ts}, udp ? kUdp : kSnapshot, std::string_view());
+        });
+        const char* name = udp ? "udp" : "snapshot";
+        row(name, "stream", js, 0);
+        row(name, "schema", jw, js.ns.p50);
+        if (udp) {
+            const Result bw = measure(states, records, batch, [&](const TrackerState& st, uint64_t ts) {
+                return write_binary(buf, sizeof(buf), {st, ts}, std::string_view());
+            });
+            row("binary", "schema", bw, js.ns.p50);
+        }
+    }
+    std::cout << "\nbinary speedup is against the stream UDP JSON it replaces on the wire\n";
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "bench.h"
+#include "../processing/vibration_spectrum.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Streaming spectrum cost and accuracy. Feeds a known vibration (sine plus
+// noise, with a fraction of frames dropped and PTS jitter) through
+// VibrationSpectrum and reports time per frame against the window length
+// together with the recovered frequency and amplitude.
+
+int bench_spectrum(int argc, char** argv) {
+    double f_true = 12.3, a_true = 0.8, drop = 0.1, fps = 120.0;
+    int frames = 12000;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--freq" && i+1<argc) f_true = atof(argv[++i]);
+        else if (a == "--amp" && i+1<argc) a_true = atof(argv[++i]);
+        else if (a == "--drop" && i+1<argc) drop = atof(argv[++i]);
+        else if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: spectrum [--freq HZ] [--amp PX] [--drop FRACTION] [--frames N]\n";
+            return 1;
+        }
+    }
+
+    std::cout << "Input: " << f_true << " Hz, " << a_true << " px, " << 100 * drop << "% frames dropped\n"
+              << "window   res[Hz]   us/frame     f[Hz]     A[px]   rms[px]\n";
+    const double pi = 3.14159265358979323846;
+    for (int window : {64, 128, 256, 512, 1024}) {
+        SpectrumParams p;
+        p.enabled = true;
+        p.window = window;
+        p.sample_hz = fps;
+        VibrationSpectrum vs;
+        vs.configure(p);
+
+        TrackerState st;
+        st.tracking = true;
+        srand(7);
+        double busy = 0;
+        int fed = 0;
+        for (int k = 0; k < frames; k++) {
+            if (rand() < drop * RAND_MAX) continue;
+            double t = k / fps + (rand() % 200) * 1e-6; // capture jitter
+            double noise = 0.05 * ((rand() / double(RAND_MAX)) - 0.5);
+            for (int q = 0; q < 4; q++) {
+                st.q[q].valid = true;
+                st.q[q].motion.pos = {static_cast<float>(320 + a_true * std::sin(2 * pi * f_true * t) + noise), 240.0f};
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            vs.push(st, 1000000 + static_cast<uint64_t>(t * 1e6));
+            busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            fed++;
+        }
+        const SpectrumPeak& pk = vs.peak(0, 0);
+        std::cout << std::setw(6) << window << std::fixed << std::setprecision(3)
+                  << std::setw(10) << fps / window << std::setw(11) << busy * 1e6 / std::max(1, fed)
+                  << std::setw(10) << pk.freq_hz << std::setw(10) << pk.amp_px << std::setw(10) << pk.rms_px << "\n";
+    }
+    return 0;
+}
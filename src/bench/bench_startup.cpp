@@ -0,0 +1,125 @@
+#include "bench.h"
+#include "../processing/aruco_tracker.h"
+#include "../pipeline/synthetic_source.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Cold-start latency. CUDA and OpenCV initialise once per process, so each
+// sample is a fresh child process (this executable re-run with --child).
+// A child simulates the tracker's startup: a pipeline start of --pipeline-ms,
+// then frames from a synthetic clip until the marker is tracked.
+//   cold: pipeline start, then tracker construction, lazy init on frame 1
+//   warm: tracker construction + warmUp() overlapped with the pipeline start
+// Reported: time to first tracked frame and the cost of the first process().
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+int child(bool warm, double pipeline_ms, int width, int height) {
+    // frames are rendered before t0 so the source cost is not counted
+    SyntheticSource::Config sc;
+    sc.width = width;
+    sc.height = height;
+    sc.frames = 30;
+    SyntheticSource src(sc);
+    if (!src.open()) return 1;
+    std::vector<cv::Mat> frames;
+    std::vector<uint64_t> ts;
+    cv::Mat f;
+    uint64_t t = 0;
+    while (src.grab(f, t)) { frames.push_back(f); ts.push_back(t); }
+
+    auto t0 = clk::now();
+    auto pipeline = [&]{ std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(pipeline_ms)); };
+    std::unique_ptr<ArucoTracker> tracker;
+    auto make = [&]{
+        tracker = std::make_unique<ArucoTracker>();
+        tracker->setOptions({false, false, false});
+        if (warm) tracker->warmUp(cv::Size(width, height));
+    };
+    if (warm) {
+        auto w = std::async(std::launch::async, make);
+        pipeline();
+        w.get();
+    } else {
+        pipeline();
+        make();
+    }
+    double ready_ms = std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+
+    double first_ms = 0, ttft_ms = -1;
+    for (size_t k = 0; k < frames.size(); k++) {
+        auto tp = clk::now();
+        tracker->process(frames[k], ts[k]);
+        if (k == 0) first_ms = std::chrono::duration<double, std::milli>(clk::now() - tp).count();
+        if (tracker->isTracking()) {
+            ttft_ms = std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+            break;
+        }
+    }
+    std::printf("%.3f %.3f %.3f\n", ready_ms, first_ms, ttft_ms);
+    return ttft_ms < 0 ? 1 : 0;
+}
+
+} // namespace
+
+int bench_startup(int argc, char** argv) {
+    int reps = 5, width = 640, height = 480;
+    double pipeline_ms = 300;
+    std::string child_mode;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--reps" && i+1<argc) reps = atoi(argv[++i]);
+        else if (a == "--pipeline-ms" && i+1<argc) pipeline_ms = atof(argv[++i]);
+        else if (a == "--width" && i+1<argc) width = atoi(argv[++i]);
+        else if (a == "--height" && i+1<argc) height = atoi(argv[++i]);
+        else if (a == "--child" && i+1<argc) child_mode = argv[++i];
+        else {
+            std::cerr << "Usage: startup [--reps N] [--pipeline-ms MS] [--width W] [--height H]\n";
+            return 1;
+        }
+    }
+    if (!child_mode.empty()) return child(child_mode == "warm", pipeline_ms, width, height);
+
+    char exe[4096];
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (n <= 0) { std::cerr << "startup: cannot resolve /proc/self/exe\n"; return 1; }
+    exe[n] = 0;
+
+    std::cout << "Pipeline start simulated as " << pipeline_ms << " ms, " << width << "x" << height
+              << ", " << reps << " fresh processes per mode\n"
+              << "mode   ready50[ms]  first50[ms]  ttft50[ms]  ttft_max[ms]\n" << std::fixed;
+    for (const char* mode : {"cold", "warm"}) {
+        std::vector<double> ready, first, ttft;
+        for (int r = 0; r < reps; r++) {
+            std::string cmd = std::string("'") + exe + "' startup --child " + mode +
+                              " --pipeline-ms " + std::to_string(pipeline_ms) +
+                              " --width " + std::to_string(width) + " --height " + std::to_string(height);
+            FILE* p = popen(cmd.c_str(), "r");
+            if (!p) continue;
+            double a = 0, b = 0, c = -1;
+            if (std::fscanf(p, "%lf %lf %lf", &a, &b, &c) == 3 && c >= 0) {
+                ready.push_back(a);
+                first.push_back(b);
+                ttft.push_back(c);
+            }
+            pclose(p);
+        }
+        if (ttft.empty()) { std::cout << mode << "   (no tracked frame)\n"; continue; }
+        BenchPercentiles pr = bench_percentiles(ready), pf = bench_percentiles(first), pt = bench_percentiles(ttft);
+        std::cout << std::left << std::setw(7) << mode << std::right << std::setprecision(1)
+                  << std::setw(11) << pr.p50 << std::setw(13) << pf.p50
+                  << std::setw(12) << pt.p50 << std::setw(14) << pt.max << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "../pipeline/synthetic_source.h"
+#include "../processing/tiled_detector.h"
+
+#include <opencv2/aruco.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Tiled parallel detection vs a single detectMarkers pass on high-resolution
+// synthetic frames. For each resolution the marker is scaled to a sixth of the
+// frame height and sits across the centre, so with an even tile grid every
+// frame exercises the overlap merge. Sweeps tile grid x pool threads and
+// reports detection latency, the fraction of frames the marker was found and
+// the duplicates merged per frame.
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+struct Res {
+    int w, h;
+};
+
+bool parse_list(const std::string& s, std::vector<int>& out) {
+    out.clear();
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, ','))
+        if (!tok.empty()) out.push_back(atoi(tok.c_str()));
+    return !out.empty();
+}
+
+} // namespace
+
+int bench_tiles(int argc, char** argv) {
+    int frames = 60;
+    std::vector<Res> res = {{1920, 1080}, {3840, 2160}, {4000, 3000}};
+    std::vector<int> grids = {1, 2, 3, 4};  // NxN
+    std::vector<int> threads = {0, 1, 3, static_cast<int>(std::thread::hardware_concurrency()) - 1};
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--size" && i+1<argc) {
+            Res r{0, 0};
+            if (sscanf(argv[++i], "%dx%d", &r.w, &r.h) != 2) { std::cerr << "tiles: bad --size\n"; return 1; }
+            res = {r};
+        }
+        else if (a == "--grids" && i+1<argc) { if (!parse_list(argv[++i], grids)) return 1; }
+        else if (a == "--threads" && i+1<argc) { if (!parse_list(argv[++i], threads)) return 1; }
+        else {
+            std::cerr << "Usage: tiles [--frames N] [--size WxH] [--grids 1,2,3] [--threads 0,1,3]\n";
+            return 1;
+        }
+    }
+
+    std::sort(threads.begin(), threads.end());
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+    auto dict = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    std::cout << std::fixed;
+    for (const Res& r : res) {
+        SyntheticSource::Config sc;
+        sc.width = r.w;
+        sc.height = r.h;
+        sc.marker_px = r.h / 6;
+        sc.frames = frames;
+        SyntheticSource src(sc);
+        if (!src.open()) { std::cerr << "tiles: synthetic source failed\n"; return 1; }
+        std::vector<cv::Mat> clip;
+        cv::Mat f;
+        uint64_t ts = 0;
+        while (src.grab(f, ts)) clip.push_back(f.clone());
+        // the overlap must hold the whole marker wherever it moves
+        const int overlap = sc.marker_px + static_cast<int>(2 * (sc.sweep_px_x + sc.vib_px)) + 16;
+
+        std::cout << r.w << "x" << r.h << ", marker " << sc.marker_px << " px, overlap " << overlap << " px, "
+                  << clip.size() << " frames\n"
+                  << "tiles  threads   p50[ms]   p99[ms]  speedup  found  dup/frame  steals\n";
+        double base_p50 = 0;
+        for (int g : grids) {
+            for (int t : threads) {
+                if (t < 0 || (g == 1 && t > 0)) continue; // one tile has nothing to share
+                TileDetectParams tp;
+                tp.enabled = true;
+                tp.cols = tp.rows = g;
+                tp.overlap_px = overlap;
+                tp.threads = t;
+                TiledDetector det;
+                std::vector<std::vector<cv::Point2f>> corners;
+                std::vector<int> ids;
+                det.detect(clip[0], dict, tp, corners, ids); // pool start-up and tile layout
+                std::vector<double> ms;
+                int found = 0;
+                const uint64_t merged0 = det.stats().merged;
+                for (const auto& fr : clip) {
+                    auto t0 = clk::now();
+                    if (g == 1)
+                        cv::aruco::detectMarkers(fr, dict, corners, ids);
+                    else
+                        det.detect(fr, dict, tp, corners, ids);
+                    ms.push_back(std::chrono::duration<double, std::milli>(clk::now() - t0).count());
+                    found += ids.size() == 1 ? 1 : 0; // exactly one marker after merging
+                }
+                BenchPercentiles p = bench_percentiles(ms);
+                if (g == 1) base_p50 = p.p50;
+                std::ostringstream grid;
+                grid << g << "x" << g;
+                std::cout << std::setw(5) << grid.str() << std::setw(9) << (g == 1 ? 0 : t)
+                          << std::setprecision(2) << std::setw(10) << p.p50 << std::setw(10) << p.p99
+                          << std::setw(9) << (p.p50 > 0 ? base_p50 / p.p50 : 0.0)
+                          << std::setw(7) << std::setprecision(0) << 100.0 * found / clip.size() << "%"
+                          << std::setw(11) << std::setprecision(2)
+                          << static_cast<double>(det.stats().merged - merged0) / clip.size()
+                          << std::setw(8) << det.steals() << "\n";
+            }
+        }
+        std::cout << "\n";
+    }
+    std::cout << "(tiles 1x1 = plain detectMarkers on the full frame; threads 0 = caller only)\n";
+    return 0;
+}
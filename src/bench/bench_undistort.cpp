@@ -0,0 +1,137 @@
+#include "bench.h"
+#include "../processing/undistort_lut.h"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Point-space undistortion vs full-frame remap. A wide-angle calibration
+// (strong barrel distortion) at --width x --height; per frame either the
+// tracked points (--points) go through the lookup grid or cv::undistortPoints,
+// or the whole frame goes through cv::remap with precomputed fixed-point maps.
+// Also reports grid build vs mmap'ed cache load time and the interpolation
+// error against the exact solution for several grid steps.
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+double us_since(clk::time_point t0) {
+    return std::chrono::duration<double, std::micro>(clk::now() - t0).count();
+}
+
+} // namespace
+
+int bench_undistort(int argc, char** argv) {
+    int width = 1280, height = 720, points = 20, frames = 2000;
+    double k1 = -0.32, k2 = 0.12;
+    std::string cache = "/tmp/bench_undistort.lut";
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--width" && i+1<argc) width = atoi(argv[++i]);
+        else if (a == "--height" && i+1<argc) height = atoi(argv[++i]);
+        else if (a == "--points" && i+1<argc) points = atoi(argv[++i]);
+        else if (a == "--frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--k1" && i+1<argc) k1 = atof(argv[++i]);
+        else if (a == "--k2" && i+1<argc) k2 = atof(argv[++i]);
+        else if (a == "--cache" && i+1<argc) cache = argv[++i];
+        else {
+            std::cerr << "Usage: undistort [--width W] [--height H] [--points N] [--frames N] [--k1 K] [--k2 K] [--cache FILE]\n";
+            return 1;
+        }
+    }
+
+    CameraCalibration calib;
+    calib.K = cv::Mat::zeros(3, 3, CV_64F);
+    calib.K.at<double>(0, 0) = calib.K.at<double>(1, 1) = 0.55 * width; // ~85 deg horizontal FOV
+    calib.K.at<double>(0, 2) = width / 2.0;
+    calib.K.at<double>(1, 2) = height / 2.0;
+    calib.K.at<double>(2, 2) = 1;
+    calib.dist = cv::Mat::zeros(1, 5, CV_64F);
+    calib.dist.at<double>(0) = k1;
+    calib.dist.at<double>(1) = k2;
+    const cv::Size size(width, height);
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> ux(0.f, static_cast<float>(width - 1)), uy(0.f, static_cast<float>(height - 1));
+    std::vector<cv::Point2f> probe(20000);
+    for (auto& p : probe) p = {ux(rng), uy(rng)};
+    std::vector<cv::Point2f> exact;
+    cv::undistortPoints(probe, exact, calib.K, calib.dist, cv::Mat(), calib.K);
+
+    std::cout << width << "x" << height << ", k1 " << k1 << " k2 " << k2 << "\n\n"
+              << "step  nodes     build[ms]  load[ms]  err_mean[px]  err_max[px]\n" << std::fixed;
+    for (int step : {4, 8, 16, 32}) {
+        std::remove(cache.c_str());
+        UndistortLut lut;
+        auto t0 = clk::now();
+        lut.prepare(calib, size, step, cache);
+        double build_ms = us_since(t0) / 1e3;
+        UndistortLut cached;
+        t0 = clk::now();
+        cached.prepare(calib, size, step, cache);
+        double load_ms = us_since(t0) / 1e3;
+        double e_sum = 0, e_max = 0;
+        for (size_t i = 0; i < probe.size() && i < exact.size(); i++) {
+            cv::Point2f d = cached.map(probe[i]) - exact[i];
+            double e = std::sqrt(d.x * d.x + d.y * d.y);
+            e_sum += e;
+            e_max = std::max(e_max, e);
+        }
+        const int nodes = ((width + step - 1) / step + 1) * ((height + step - 1) / step + 1);
+        std::cout << std::setw(4) << step << std::setw(7) << nodes << std::setprecision(2)
+                  << std::setw(14) << build_ms << std::setw(10) << load_ms
+                  << (cached.mapped() ? "" : "*")
+                  << std::setprecision(4) << std::setw(14) << e_sum / probe.size() << std::setw(13) << e_max << "\n";
+    }
+    std::remove(cache.c_str());
+    std::cout << "(* = cache not used)\n\n";
+
+    // Per-frame cost. The points move a little each frame, as tracked points do.
+    UndistortLut lut;
+    lut.build(calib.scaledTo(size), size, 8);
+    std::vector<cv::Point2f> pts(static_cast<size_t>(points)), work, out;
+    for (auto& p : pts) p = {ux(rng), uy(rng)};
+    std::vector<double> t_lut, t_exact, t_remap;
+    volatile float sink = 0;
+    for (int k = 0; k < frames; k++) {
+        for (auto& p : pts) p += cv::Point2f(0.3f * std::sin(k * 0.1f), 0.2f * std::cos(k * 0.1f));
+        work = pts;
+        auto t0 = clk::now();
+        lut.map(work.data(), work.size());
+        t_lut.push_back(us_since(t0));
+        sink = sink + work[0].x;
+        t0 = clk::now();
+        cv::undistortPoints(pts, out, calib.K, calib.dist, cv::Mat(), calib.K);
+        t_exact.push_back(us_since(t0));
+    }
+    cv::Mat map1, map2;
+    cv::initUndistortRectifyMap(calib.K, calib.dist, cv::Mat(), calib.K, size, CV_16SC2, map1, map2);
+    cv::Mat frame(size, CV_8UC1, cv::Scalar(128)), undist;
+    const int remap_frames = std::min(frames, 300);
+    for (int k = 0; k < remap_frames; k++) {
+        auto t0 = clk::now();
+        cv::remap(frame, undist, map1, map2, cv::INTER_LINEAR);
+        t_remap.push_back(us_since(t0));
+    }
+
+    std::cout << "Per frame (" << points << " points):\n"
+              << "method                 p50[us]   p99[us]  mean[us]\n";
+    auto row = [](const char* name, const std::vector<double>& v) {
+        BenchPercentiles p = bench_percentiles(v);
+        std::cout << std::left << std::setw(20) << name << std::right << std::setprecision(2)
+                  << std::setw(10) << p.p50 << std::setw(10) << p.p99 << std::setw(10) << p.mean << "\n";
+    };
+    row("lut (step 8)", t_lut);
+    row("undistortPoints", t_exact);
+    row("remap (full frame)", t_remap);
+    return 0;
+}
@@ -0,0 +1,299 @@
+#include "control_server.h"
+
+#include <opencv2/core.hpp>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+void ControlServer::handle(const std::string& command, Handler h) {
+    std::lock_guard<std::mutex> lk(handlers_m_);
+    handlers_[command] = std::move(h);
+}
+
+bool ControlServer::start(const std::string& path) {
+    if (running_) return true;
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Control: socket path too long: " << path << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    // A stale socket from an earlier run (nobody listening: ECONNREFUSED) is
+    // replaced; a live one or anything that is not a socket is left alone.
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            std::cerr << "Control: " << path << " exists and is not a socket" << std::endl;
+            return false;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe < 0) {
+            std::cerr << "Control: socket() failed" << std::endl;
+            return false;
+        }
+        const int rc = connect(probe, (sockaddr*)&addr, sizeof(addr));
+        const int err = errno;
+        ::close(probe);
+        if (rc == 0) {
+            std::cerr << "Control: " << path << " is already in use by another process" << std::endl;
+            return false;
+        }
+        if (err != ECONNREFUSED) {
+            std::cerr << "Control: cannot probe " << path << ": " << std::strerror(err) << std::endl;
+            return false;
+        }
+        if (::unlink(path.c_str()) < 0) {
+            std::cerr << "Control: cannot remove stale socket " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+    }
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Control: socket() failed" << std::endl;
+        return false;
+    }
+    if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 4) < 0) {
+        std::cerr << "Control: cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    path_ = path;
+    running_ = true;
+    thread_ = std::thread([this]{ this->run(); });
+    std::cerr << "Control: listening on " << path << std::endl;
+    return true;
+}
+
+void ControlServer::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+    if (listen_fd_ >= 0) { ::close(listen_fd_); listen_fd_ = -1; }
+    if (!path_.empty()) { ::unlink(path_.c_str()); path_.clear(); }
+}
+
+void ControlServer::run() {
+    while (running_) {
+        pollfd p{listen_fd_, POLLIN, 0};
+        if (poll(&p, 1, 200) <= 0) continue; // wake periodically to observe stop()
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+        serve(fd);
+        ::close(fd);
+    }
+}
+
+void ControlServer::serve(int fd) {
+    std::string pending;
+    char buf[1024];
+    while (running_) {
+        pollfd p{fd, POLLIN, 0};
+        int r = poll(&p, 1, 200);
+        if (r == 0) continue;
+        if (r < 0) return;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return; // client closed
+        pending.append(buf, static_cast<size_t>(n));
+        size_t eol;
+        while ((eol = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, eol);
+            pending.erase(0, eol + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            std::string out = dispatch(line);
+            if (out.empty() || out.back() != '\n') out += '\n';
+            out += '\n';
+            size_t off = 0;
+            while (off < out.size()) {
+                ssize_t w = send(fd, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+                if (w <= 0) return;
+                off += static_cast<size_t>(w);
+            }
+        }
+        if (pending.size() > 4096) return; // not a command stream
+    }
+}
+
+std::string ControlServer::dispatch(const std::string& line) {
+    size_t b = line.find_first_not_of(" \t");
+    if (b == std::string::npos) return std::string();
+    size_t e = line.find_first_of(" \t", b);
+    std::string cmd = line.substr(b, e == std::string::npos ? std::string::npos : e - b);
+    std::string args = e == std::string::npos ? std::string() : line.substr(e + 1);
+    Handler h;
+    {
+        std::lock_guard<std::mutex> lk(handlers_m_);
+        auto it = handlers_.find(cmd);
+        if (it != handlers_.end()) h = it->second;
+    }
+    if (!h) return "error: unknown command '" + cmd + "' (try help)";
+    try {
+        return h(args);
+    } catch (const std::exception& ex) {
+        return std::string("error: ") + ex.what();
+    }
+}
+
+namespace {
+
+const char* const kOptionKeys[] = {"save", "csv", "metrics", "save_period_ms", "metrics_period_ms", "process_every"};
+
+std::vector<std::string> split_words(const std::string& s) {
+    std::vector<std::string> out;
+    std::istringstream is(s);
+    std::string w;
+    while (is >> w) out.push_back(w);
+    return out;
+}
+
+bool parse_number(const std::string& s, double& v) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    v = std::strtod(s.c_str(), &end);
+    return end && *end == '\0';
+}
+
+// on/off, true/false and yes/no as 1/0; anything else unchanged
+std::string normalise_value(const std::string& v) {
+    if (v == "on" || v == "true" || v == "yes") return "1";
+    if (v == "off" || v == "false" || v == "no") return "0";
+    return v;
+}
+
+// tracker_params.json keys with their current values, in file order
+std::vector<std::pair<std::string, std::string>> param_values(const TrackerParams& p) {
+    std::vector<std::pair<std::string, std::string>> out;
+    cv::FileStorage fs(tracker_params_json(p), cv::FileStorage::READ | cv::FileStorage::MEMORY);
+    cv::FileNode root = fs.root();
+    for (auto it = root.begin(); it != root.end(); ++it) {
+        cv::FileNode n = *it;
+        std::ostringstream os;
+        if (n.isString()) os << n.string();
+        else if (n.isInt()) os << static_cast<int>(n);
+        else os << std::setprecision(10) << static_cast<double>(n);
+        out.emplace_back(n.name(), os.str());
+    }
+    return out;
+}
+
+std::string option_value(const RuntimeConfig& c, const std::string& key) {
+    const auto& o = c.options;
+    if (key == "save") return o.enable_save ? "1" : "0";
+    if (key == "csv") return o.enable_csv ? "1" : "0";
+    if (key == "metrics") return o.enable_metrics ? "1" : "0";
+    if (key == "save_period_ms") return std::to_string(o.save_period_us / 1000);
+    if (key == "metrics_period_ms") return std::to_string(o.metrics_period_us / 1000);
+    if (key == "process_every") return std::to_string(c.process_every);
+    return std::string();
+}
+
+} // namespace
+
+void add_runtime_commands(ControlServer& server, ConfigSnapshot<RuntimeConfig>& config, const RuntimeLimits& limits) {
+    server.handle("help", [](const std::string&) {
+        return std::string(
+            "help                   this text\n"
+            "get [KEY...]           current values (all keys without arguments)\n"
+            "set KEY=VALUE...       change values; applied together at the next frame boundary\n"
+            "params                 tracker parameters as JSON (a --params file)\n"
+            "option keys: save csv metrics save_period_ms metrics_period_ms process_every\n"
+            "parameter keys: see config/tracker_params.json");
+    });
+
+    server.handle("get", [&config](const std::string& args) {
+        uint64_t version = 0;
+        const RuntimeConfig c = config.latest(&version);
+        const auto params = param_values(c.params);
+        std::vector<std::string> keys = split_words(args);
+        std::ostringstream os;
+        os << "ok version " << version << " applied " << config.applied() << "\n";
+        if (keys.empty()) {
+            for (const char* k : kOptionKeys) os << k << "=" << option_value(c, k) << "\n";
+            for (const auto& kv : params) os << kv.first << "=" << kv.second << "\n";
+            return os.str();
+        }
+        for (const auto& k : keys) {
+            std::string v = option_value(c, k);
+            for (const auto& kv : params)
+                if (kv.first == k) v = kv.second;
+            if (v.empty()) return "error: unknown key '" + k + "'";
+            os << k << "=" << v << "\n";
+        }
+        return os.str();
+    });
+
+    server.handle("params", [&config](const std::string&) {
+        return "ok\n" + tracker_params_json(config.latest().params);
+    });
+
+    server.handle("set", [&config, limits](const std::string& args) -> std::string {
+        std::vector<std::string> words = split_words(args);
+        if (words.empty()) return std::string("error: usage: set KEY=VALUE...");
+        std::set<std::string> param_keys;
+        for (const auto& kv : param_values(TrackerParams())) param_keys.insert(kv.first);
+
+        RuntimeConfig c = config.latest();
+        std::ostringstream doc; // parameter changes, read back through the --params reader
+        bool params_changed = false;
+        for (const auto& w : words) {
+            size_t eq = w.find('=');
+            if (eq == std::string::npos || eq == 0) return "error: expected KEY=VALUE, got '" + w + "'";
+            const std::string key = w.substr(0, eq);
+            const std::string val = normalise_value(w.substr(eq + 1));
+            double num = 0;
+            const bool numeric = parse_number(val, num);
+            if (key == "track_mode" || key == "lk_backend") {
+                TrackMode m;
+                LkBackend b;
+                if (key == "track_mode" && !parse_track_mode(val, m)) return "error: track_mode must be lk or homography";
+                if (key == "lk_backend" && !parse_lk_backend(val, b)) return "error: lk_backend must be cuda or cpu";
+                doc << (params_changed ? ", " : "") << "\"" << key << "\": \"" << val << "\"";
+                params_changed = true;
+                continue;
+            }
+            if (param_keys.count(key)) {
+                if (!numeric) return "error: " + key + " needs a number";
+                doc << (params_changed ? ", " : "") << "\"" << key << "\": " << val;
+                params_changed = true;
+                continue;
+            }
+            if (!numeric) return "error: unknown key '" + key + "' or non-numeric value";
+            auto& o = c.options;
+            if (key == "save") {
+                if (num != 0 && !limits.save_available) return std::string("error: snapshots were disabled at startup (--no-save)");
+                o.enable_save = num != 0;
+            } else if (key == "csv") {
+                o.enable_csv = num != 0;
+            } else if (key == "metrics") {
+                o.enable_metrics = num != 0;
+            } else if (key == "save_period_ms" || key == "metrics_period_ms") {
+                if (num < 0) return "error: " + key + " must be >= 0";
+                (key == "save_period_ms" ? o.save_period_us : o.metrics_period_us) = static_cast<uint64_t>(num * 1000);
+            } else if (key == "process_every") {
+                if (num < 1) return std::string("error: process_every must be >= 1");
+                c.process_every = static_cast<int>(num);
+            } else {
+                return "error: unknown key '" + key + "'";
+            }
+        }
+        if (params_changed) {
+            if (!parse_tracker_params("{" + doc.str() + "}", c.params))
+                return std::string("error: parameters rejected");
+            c.params_version++;
+        }
+        return "ok version " + std::to_string(config.publish(c));
+    });
+}
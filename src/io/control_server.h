@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../processing/aruco_tracker.h"
+#include "../util/config_snapshot.h"
+
+// Line-oriented command server on a local Unix domain socket. A request is
+// one line, "<command> [args]"; the reply is the handler's text followed by
+// an empty line, so a client can send several commands on one connection
+// (e.g. `socat - UNIX-CONNECT:/tmp/jetson_motion.sock`). One client at a time.
+class ControlServer {
+public:
+    using Handler = std::function<std::string(const std::string& args)>;
+
+    ControlServer() = default;
+    ~ControlServer() { stop(); }
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    void handle(const std::string& command, Handler h);
+    // Replaces a stale socket file left by a previous run.
+    bool start(const std::string& path);
+    void stop();
+    bool isRunning() const { return running_; }
+
+private:
+    void run();
+    void serve(int fd);
+    std::string dispatch(const std::string& line);
+
+    int listen_fd_ = -1;
+    std::string path_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex handlers_m_;
+    std::map<std::string, Handler> handlers_;
+};
+
+// Everything the control socket may change while the tracker runs. The
+// process loop polls for a new version at each frame boundary.
+struct RuntimeConfig {
+    TrackerParams params;
+    ArucoTracker::Options options;
+    int process_every = 1;
+    uint64_t params_version = 0; // bumped only when `params` changed
+};
+
+struct RuntimeLimits {
+    bool save_available = true; // snapshot writer was initialised (no --no-save)
+};
+
+// help, get [KEY...], set KEY=VALUE..., params. Option keys are save, csv,
+// metrics, save_period_ms, metrics_period_ms and process_every; every
+// tracker_params.json key is accepted too.
+void add_runtime_commands(ControlServer& server, ConfigSnapshot<RuntimeConfig>& config,
+                          const RuntimeLimits& limits = RuntimeLimits());
@@ -0,0 +1,127 @@
+#include "http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+
+void HttpServer::handle(const std::string& path, Handler h) {
+    std::lock_guard<std::mutex> lk(handlers_m_);
+    handlers_[path] = std::move(h);
+}
+
+std::string HttpServer::param(const std::string& query, const std::string& key, const std::string& dflt) {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t amp = query.find('&', pos);
+        if (amp == std::string::npos) amp = query.size();
+        size_t eq = query.find('=', pos);
+        if (eq < amp && query.compare(pos, eq - pos, key) == 0 && eq - pos == key.size())
+            return query.substr(eq + 1, amp - eq - 1);
+        pos = amp + 1;
+    }
+    return dflt;
+}
+
+bool HttpServer::start(uint16_t port, const std::string& bind_addr) {
+    if (running_) return true;
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "HTTP: socket() failed" << std::endl;
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, bind_addr.c_str(), &addr.sin_addr);
+    if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 8) < 0) {
+        std::cerr << "HTTP: cannot listen on " << bind_addr << ":" << port << ": " << std::strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    running_ = true;
+    thread_ = std::thread([this]{ this->run(); });
+    std::cerr << "HTTP: serving on http://" << bind_addr << ":" << port << std::endl;
+    return true;
+}
+
+void HttpServer::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+    if (listen_fd_ >= 0) { ::close(listen_fd_); listen_fd_ = -1; }
+}
+
+void HttpServer::run() {
+    while (running_) {
+        pollfd p{listen_fd_, POLLIN, 0};
+        if (poll(&p, 1, 200) <= 0) continue; // wake periodically to observe stop()
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+        timeval tv{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        serve(fd);
+        ::close(fd);
+    }
+}
+
+void HttpServer::serve(int fd) {
+    char buf[2048];
+    ssize_t n = recv(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return;
+    buf[n] = '\0';
+
+    // "GET /path?query HTTP/1.1"
+    std::string req(buf, static_cast<size_t>(n));
+    size_t sp1 = req.find(' ');
+    size_t sp2 = sp1 == std::string::npos ? std::string::npos : req.find(' ', sp1 + 1);
+    Response resp;
+    if (sp2 == std::string::npos || req.compare(0, sp1, "GET") != 0) {
+        resp.status = 405;
+        resp.body = "method not allowed\n";
+    } else {
+        std::string target = req.substr(sp1 + 1, sp2 - sp1 - 1);
+        size_t q = target.find('?');
+        std::string path = target.substr(0, q);
+        std::string query = q == std::string::npos ? std::string() : target.substr(q + 1);
+        Handler h;
+        {
+            std::lock_guard<std::mutex> lk(handlers_m_);
+            auto it = handlers_.find(path);
+            if (it != handlers_.end()) h = it->second;
+        }
+        if (h) {
+            try {
+                resp = h(query);
+            } catch (const std::exception& e) {
+                resp.status = 500;
+                resp.body = std::string("error: ") + e.what() + "\n";
+            }
+        } else {
+            resp.status = 404;
+            resp.body = "not found\n";
+        }
+    }
+
+    const char* reason = resp.status == 200 ? "OK" : resp.status == 400 ? "Bad Request"
+                       : resp.status == 404 ? "Not Found" : resp.status == 405 ? "Method Not Allowed"
+                       : "Internal Server Error";
+    std::string head = "HTTP/1.0 " + std::to_string(resp.status) + " " + reason + "\r\n" +
+                       "Content-Type: " + resp.content_type + "\r\n" +
+                       "Content-Length: " + std::to_string(resp.body.size()) + "\r\n" +
+                       "Connection: close\r\n\r\n";
+    std::string out = head + resp.body;
+    size_t off = 0;
+    while (off < out.size()) {
+        ssize_t w = send(fd, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+        if (w <= 0) break;
+        off += static_cast<size_t>(w);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Minimal single-threaded HTTP/1.0 server for local scraping and queries.
+// Handlers are matched on the exact request path; the query string (after
+// '?') is passed through unparsed. One request per connection.
+class HttpServer {
+public:
+    struct Response {
+        int status = 200;
+        std::string content_type = "text/plain; version=0.0.4";
+        std::string body;
+    };
+    using Handler = std::function<Response(const std::string& query)>;
+
+    HttpServer() = default;
+    ~HttpServer() { stop(); }
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    void handle(const std::string& path, Handler h);
+    // Value of `key` in a "k=v&k2=v2" query string (no %-decoding); `dflt` when absent.
+    static std::string param(const std::string& query, const std::string& key, const std::string& dflt = std::string());
+    bool start(uint16_t port, const std::string& bind_addr = "127.0.0.1");
+    void stop();
+    bool isRunning() const { return running_; }
+
+private:
+    void run();
+    void serve(int fd);
+
+    int listen_fd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex handlers_m_;
+    std::map<std::string, Handler> handlers_;
+};
@@ -0,0 +1,65 @@
+#include "live_encoder.h"
+#include "../network/udp_sender.h"
+#include "../util/alloc_trace.h"
+#include "../util/thread_topology.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <fstream>
+#include <iostream>
+
+void LiveEncoder::start(const Config& cfg) {
+    if (worker_.joinable()) return;
+    cfg_ = cfg;
+    running_ = true;
+    worker_ = std::thread([this]{ run(); });
+}
+
+void LiveEncoder::stop() {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void LiveEncoder::submit(const cv::Mat& vis) {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        if (!running_) return;
+        vis.copyTo(pending_);
+        ALLOC_TRACE_COPY(vis.total() * vis.elemSize());
+        if (has_pending_) replaced_.fetch_add(1, std::memory_order_relaxed);
+        has_pending_ = true;
+    }
+    cv_.notify_one();
+}
+
+void LiveEncoder::run() {
+    ThreadTopology::instance().applyToCurrentThread("live");
+    std::vector<int> jpg_params = {cv::IMWRITE_JPEG_QUALITY, cfg_.jpeg_quality};
+    std::vector<uchar> enc;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&]{ return has_pending_ || !running_; });
+            if (!has_pending_) return;
+            cv::swap(pending_, work_);
+            has_pending_ = false;
+        }
+        try {
+            cv::imencode(".jpg", work_, enc, jpg_params);
+            // write to the live path without re-encoding
+            {
+                std::ofstream out(cfg_.path, std::ios::binary);
+                if (out.good()) out.write(reinterpret_cast<const char*>(enc.data()), static_cast<std::streamsize>(enc.size()));
+            }
+            // also send via UDP for Flask receiver
+            send_jpeg_udp(enc, cfg_.udp_host.c_str(), cfg_.udp_port);
+            encoded_.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            std::cerr << "Live snapshot write failed: " << e.what() << std::endl;
+        }
+    }
+}
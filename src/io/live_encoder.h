@@ -0,0 +1,49 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Live MJPEG feed: encodes rendered overlay frames and writes /tmp/live.jpg
+// plus the chunked UDP stream for the Flask UI. submit() only copies into a
+// one-slot mailbox (latest frame wins), so the renderer never waits on
+// the encoder.
+class LiveEncoder {
+public:
+    struct Config {
+        double hz = 10;                          // rate the renderer submits at
+        int jpeg_quality = 75;
+        std::string path = "/tmp/live.jpg";
+        std::string udp_host = "127.0.0.1";
+        uint16_t udp_port = 5002;
+    };
+
+    ~LiveEncoder() { stop(); }
+
+    void start(const Config& cfg);
+    void stop();
+
+    // Copy one rendered BGR frame for encoding; replaces one not yet taken.
+    void submit(const cv::Mat& vis);
+
+    uint64_t encoded() const { return encoded_.load(std::memory_order_relaxed); }
+    uint64_t replaced() const { return replaced_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    Config cfg_;
+    std::thread worker_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    cv::Mat pending_, work_;   // swapped under m_, buffers reused
+    bool has_pending_ = false;
+    bool running_ = false;
+    std::atomic<uint64_t> encoded_{0};
+    std::atomic<uint64_t> replaced_{0};
+};
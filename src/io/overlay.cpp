@@ -0,0 +1,121 @@
+#include "overlay.h"
+#include "live_encoder.h"
+#include "../util/thread_topology.h"
+
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace cv;
+
+void draw_overlay(Mat& vis, const OverlayState& ov, float scale, bool full) {
+    const TrackerState& s = ov.st;
+    if (!s.tracking) return;
+
+    Rect bb(cvRound(s.marker_bbox.x * scale), cvRound(s.marker_bbox.y * scale),
+            cvRound(s.marker_bbox.width * scale), cvRound(s.marker_bbox.height * scale));
+    char txt[48];
+
+    // bbox and marker id
+    if (full) {
+        rectangle(vis, bb, Scalar(0,255,0), 2);
+        std::snprintf(txt, sizeof(txt), "ID: %d", s.marker_id);
+        putText(vis, txt, {bb.x, std::max(0, bb.y-6)}, FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0,255,0), 1);
+    }
+
+    for (int i=0;i<4;i++) {
+        Point2f center;
+        if (s.q[i].valid) center = s.q[i].image_pos * scale; // motion.pos may be undistorted
+        else center = Point2f(bb.x + bb.width * (i%2 ? 0.75f : 0.25f), bb.y + bb.height * (i<2 ? 0.25f : 0.75f));
+        int ix = saturate_cast<int>(center.x);
+        int iy = saturate_cast<int>(center.y);
+
+        if (!s.q[i].valid) {
+            // small X where the quadrant should be
+            line(vis, {ix-3,iy-3}, {ix+3,iy+3}, Scalar(0,128,255), 1);
+            line(vis, {ix+3,iy-3}, {ix-3,iy+3}, Scalar(0,128,255), 1);
+            continue;
+        }
+        circle(vis, {ix, iy}, 4, Scalar(0,0,255), -1);
+        if (!full) continue;
+
+        // velocity arrow (scaled for visibility) and value
+        float vx = s.q[i].motion.vel.x;
+        float vy = s.q[i].motion.vel.y;
+        float k = 0.05f * scale; // px per (velocity unit)
+        Point dst(saturate_cast<int>(ix + vx*k), saturate_cast<int>(iy + vy*k));
+        arrowedLine(vis, {ix,iy}, dst, Scalar(255,0,0), 1, LINE_AA, 0, 0.3);
+        std::snprintf(txt, sizeof(txt), "v=%.1f,%.1f", vx, vy);
+        putText(vis, txt, {ix+6, iy-6}, FONT_HERSHEY_SIMPLEX, 0.4, Scalar(255,255,255), 1);
+        if (!ov.vib[i].empty())
+            putText(vis, ov.vib[i], {ix+6, iy+8}, FONT_HERSHEY_SIMPLEX, 0.4, Scalar(0,255,255), 1);
+    }
+}
+
+void OverlayRenderer::start(std::shared_ptr<FrameSubscription> sub, const StateSnapshot& state, const Config& cfg,
+                            LiveEncoder* live, std::function<void()> on_quit) {
+    if (worker_.joinable()) return;
+    cfg_ = cfg;
+    cfg_.scale = std::min(1.0, std::max(0.1, cfg_.scale));
+    sub_ = std::move(sub);
+    state_ = &state;
+    live_ = live;
+    on_quit_ = std::move(on_quit);
+    m_render_ = &MetricsRegistry::instance().histogram("tracker_overlay_render_seconds", "Overlay draw time per rendered frame",
+                                                       {1e-4, 2.5e-4, 5e-4, 1e-3, 2e-3, 4e-3, 8e-3, 16e-3});
+    worker_ = std::thread([this]{ run(); });
+}
+
+void OverlayRenderer::stop() {
+    if (sub_) sub_->close();
+    if (worker_.joinable()) worker_.join();
+}
+
+void OverlayRenderer::run() {
+    using clock = std::chrono::steady_clock;
+    ThreadTopology::instance().applyToCurrentThread("overlay");
+    if (cfg_.window) {
+        namedWindow("Live", WINDOW_AUTOSIZE);
+        // Quick check: is display usable? If not, warn the user.
+        if (getWindowProperty("Live", WND_PROP_AUTOSIZE) < 0)
+            std::cerr << "Warning: display window could not be created; are you running headless or without X?\n";
+    }
+
+    const uint64_t live_gap_us = cfg_.live_hz > 0 ? static_cast<uint64_t>(1e6 / cfg_.live_hz) : 0;
+    uint64_t last_live_us = 0;
+    FramePtr f;
+    while (sub_->pop(f)) {
+        auto t0 = clock::now();
+        // same-size destinations are reused by resize/cvtColor, so steady state allocates nothing
+        const Mat* src = &f->image;
+        if (cfg_.scale < 1.0) {
+            resize(f->image, small_, Size(), cfg_.scale, cfg_.scale, INTER_AREA);
+            src = &small_;
+        }
+        if (src->channels() == 1) cvtColor(*src, vis_, COLOR_GRAY2BGR);
+        else src->copyTo(vis_);
+        draw_overlay(vis_, state_->get(), static_cast<float>(cfg_.scale), overlay_on_);
+        m_render_->observe(std::chrono::duration<double>(clock::now() - t0).count());
+        rendered_.fetch_add(1, std::memory_order_relaxed);
+
+        if (live_ && live_gap_us && (!last_live_us || f->ts_us - last_live_us >= live_gap_us)) {
+            live_->submit(vis_);
+            last_live_us = f->ts_us;
+        }
+
+        if (cfg_.window) {
+            imshow("Live", vis_);
+            int k = waitKey(1);
+            if (k == 'q' || k == 'Q') {
+                if (on_quit_) on_quit_();
+            } else if (k == 'o' || k == 'O') {
+                overlay_on_ = !overlay_on_;
+            }
+        }
+    }
+    if (cfg_.window) destroyAllWindows();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../util/frame_bus.h"
+#include "../util/metrics.h"
+#include "../processing/state_snapshot.h"
+
+class LiveEncoder;
+
+// Draw the tracker overlay onto a BGR image. `scale` maps frame pixels to
+// image pixels (image may be downscaled); with `full` off only the quadrant
+// markers are drawn (the 'o' key in the display window).
+void draw_overlay(cv::Mat& vis, const OverlayState& ov, float scale = 1.0f, bool full = true);
+
+// Single overlay renderer shared by the display window and the live feed.
+// Runs on its own thread, fed by a rate-limited bus subscription (the
+// display refresh rate), and draws the latest StateSnapshot onto a reused,
+// optionally downscaled buffer. HighGUI calls stay on this thread, so the
+// processing loop never waits for the window.
+class OverlayRenderer {
+public:
+    struct Config {
+        bool window = false;     // show the "Live" HighGUI window
+        double live_hz = 10;     // rendered frames handed to the live encoder; 0 = none
+        double scale = 1.0;      // output size relative to the frame (<= 1)
+    };
+
+    ~OverlayRenderer() { stop(); }
+
+    // `live` may be null. `on_quit` runs on the renderer thread when 'q' is pressed.
+    void start(std::shared_ptr<FrameSubscription> sub, const StateSnapshot& state, const Config& cfg,
+               LiveEncoder* live, std::function<void()> on_quit);
+    void stop();
+
+    uint64_t rendered() const { return rendered_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    Config cfg_;
+    std::shared_ptr<FrameSubscription> sub_;
+    const StateSnapshot* state_ = nullptr;
+    LiveEncoder* live_ = nullptr;
+    std::function<void()> on_quit_;
+    std::thread worker_;
+    std::atomic<uint64_t> rendered_{0};
+    bool overlay_on_ = true;
+
+    cv::Mat small_, vis_;   // reused across frames
+    Histogram* m_render_ = nullptr;
+};
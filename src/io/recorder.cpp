@@ -0,0 +1,36 @@
+#include "recorder.h"
+#include "../util/thread_topology.h"
+
+#include <iostream>
+
+void FrameRecorder::start(std::shared_ptr<FrameSubscription> sub, const Config& cfg) {
+    if (worker_.joinable()) return;
+    cfg_ = cfg;
+    sub_ = std::move(sub);
+    worker_ = std::thread([this]{ run(); });
+}
+
+void FrameRecorder::stop() {
+    if (sub_) sub_->close();
+    if (worker_.joinable()) worker_.join();
+    if (vw_.isOpened()) vw_.release();
+}
+
+void FrameRecorder::run() {
+    ThreadTopology::instance().applyToCurrentThread("recorder");
+    FramePtr f;
+    while (sub_->pop(f)) {
+        if (failed_) continue; // keep draining so the queue stats stay meaningful
+        if (!vw_.isOpened()) {
+            const std::string& cc = cfg_.fourcc;
+            int fourcc = cc.size() == 4 ? cv::VideoWriter::fourcc(cc[0], cc[1], cc[2], cc[3]) : 0;
+            if (!vw_.open(cfg_.path, fourcc, cfg_.fps, f->image.size(), f->image.channels() == 3)) {
+                std::cerr << "Recorder: could not open " << cfg_.path << " (" << cc << ")" << std::endl;
+                failed_ = true;
+                continue;
+            }
+        }
+        vw_.write(f->image);
+        written_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../util/frame_bus.h"
+
+// Raw-frame recorder fed from its own bus subscription. The container is
+// opened on the first frame (size and colour come from the stream); when
+// the disk falls behind, the subscription's queue drops frames instead of
+// back-pressuring capture.
+class FrameRecorder {
+public:
+    struct Config {
+        std::string path;             // .avi/.mkv/...; codec must suit the container
+        double fps = 30;              // nominal rate written into the container
+        std::string fourcc = "MJPG";
+    };
+
+    ~FrameRecorder() { stop(); }
+
+    void start(std::shared_ptr<FrameSubscription> sub, const Config& cfg);
+    void stop();
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    Config cfg_;
+    std::shared_ptr<FrameSubscription> sub_;
+    std::thread worker_;
+    cv::VideoWriter vw_;
+    std::atomic<uint64_t> written_{0};
+    std::atomic<bool> failed_{false};
+};
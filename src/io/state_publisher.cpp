@@ -0,0 +1,83 @@
+#include "state_publisher.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+bool StateShmPublisher::open(const std::string& name, uint32_t history_len) {
+    close();
+    if (history_len == 0) history_len = 1;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "StateShm: shm_open(" << name << ") failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    size_t size = shm_segment_size(history_len);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "StateShm: ftruncate failed: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "StateShm: mmap failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Fresh segment every run; readers validate the header before use.
+    std::memset(p, 0, size);
+    base_ = p;
+    size_ = size;
+    name_ = name;
+    history_len_ = history_len;
+    count_ = 0;
+
+    ShmHeader* h = header();
+    h->version = kShmVersion;
+    h->history_len = history_len;
+    h->record_size = sizeof(ShmStateRecord);
+    h->write_count.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = kShmMagic;
+
+    std::cerr << "StateShm: publishing to " << name << " (" << size << " bytes, history " << history_len << ")" << std::endl;
+    return true;
+}
+
+void StateShmPublisher::publish(const TrackerState& st, uint64_t ts_us) {
+    if (!base_) return;
+
+    ShmStateRecord r;
+    std::memset(&r, 0, sizeof(r));
+    r.frame_seq = ++count_;
+    r.ts_us = ts_us;
+    r.marker_id = st.marker_id;
+    r.tracking = st.tracking ? 1u : 0u;
+    r.bbox_x = st.marker_bbox.x;
+    r.bbox_y = st.marker_bbox.y;
+    r.bbox_w = st.marker_bbox.width;
+    r.bbox_h = st.marker_bbox.height;
+    for (int i = 0; i < 4; i++) {
+        const auto& q = st.q[i];
+        auto& o = r.q[i];
+        o.valid = q.valid ? 1u : 0u;
+        o.cx = q.motion.pos.x; o.cy = q.motion.pos.y;
+        o.vx = q.motion.vel.x; o.vy = q.motion.vel.y;
+        o.ax = q.motion.acc.x; o.ay = q.motion.acc.y;
+    }
+    r.publish_ns = shm_now_ns();
+
+    slots()[1 + (r.frame_seq - 1) % history_len_].store(r);
+    slots()[0].store(r);
+    header()->write_count.store(r.frame_seq, std::memory_order_release);
+}
+
+void StateShmPublisher::close() {
+    if (!base_) return;
+    munmap(base_, size_);
+    shm_unlink(name_.c_str());
+    base_ = nullptr;
+    size_ = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "state_shm.h"
+#include "../processing/motion_types.h"
+
+#include <string>
+
+// Publishes each processed TrackerState into a POSIX shared-memory segment
+// (see state_shm.h). Writer is the processing thread; readers are lock-free.
+class StateShmPublisher {
+public:
+    StateShmPublisher() = default;
+    ~StateShmPublisher() { close(); }
+    StateShmPublisher(const StateShmPublisher&) = delete;
+    StateShmPublisher& operator=(const StateShmPublisher&) = delete;
+
+    bool open(const std::string& name = kDefaultShmName, uint32_t history_len = 256);
+    void publish(const TrackerState& st, uint64_t ts_us);
+    void close();
+
+    bool isOpen() const { return base_ != nullptr; }
+    const std::string& name() const { return name_; }
+
+private:
+    ShmHeader* header() { return static_cast<ShmHeader*>(base_); }
+    ShmSlot* slots() { return reinterpret_cast<ShmSlot*>(static_cast<uint8_t*>(base_) + sizeof(ShmHeader)); }
+
+    std::string name_;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    uint32_t history_len_ = 0;
+    uint64_t count_ = 0;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+// Shared-memory layout for the latest TrackerState plus a short history ring.
+// Header-only and free of OpenCV so external readers can include it directly.
+//
+// Segment layout (all little-endian, offsets in bytes):
+//   ShmHeader                        64
+//   Seqlock<ShmStateRecord> latest   8 + 184
+//   Seqlock<ShmStateRecord> history[history_len]
+// tools/shm_reader.py mirrors this layout; bump kShmVersion on any change.
+
+#include "../util/seqlock.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <time.h>
+
+constexpr uint32_t kShmMagic = 0x4B525441; // "ATRK"
+constexpr uint32_t kShmVersion = 1;
+constexpr const char* kDefaultShmName = "/aruco_tracker_state";
+
+struct ShmQuadrant {
+    float cx, cy;
+    float vx, vy;
+    float ax, ay;
+    uint32_t valid;
+    uint32_t reserved;
+};
+
+struct ShmStateRecord {
+    uint64_t frame_seq;  // 1-based count of published frames
+    uint64_t ts_us;      // frame timestamp
+    uint64_t publish_ns; // CLOCK_MONOTONIC at publication
+    int32_t marker_id;
+    uint32_t tracking;
+    int32_t bbox_x, bbox_y, bbox_w, bbox_h;
+    ShmQuadrant q[4];
+    uint64_t reserved;
+};
+
+struct ShmHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t history_len;
+    uint32_t record_size;
+    std::atomic<uint64_t> write_count; // records published so far
+    uint8_t reserved[40];
+};
+
+using ShmSlot = Seqlock<ShmStateRecord>;
+
+static_assert(sizeof(ShmQuadrant) == 32, "ShmQuadrant layout changed");
+static_assert(sizeof(ShmStateRecord) == 184, "ShmStateRecord layout changed");
+static_assert(sizeof(ShmHeader) == 64, "ShmHeader layout changed");
+static_assert(sizeof(ShmSlot) == 192, "ShmSlot layout changed");
+
+inline size_t shm_segment_size(uint32_t history_len) {
+    return sizeof(ShmHeader) + sizeof(ShmSlot) * (1 + static_cast<size_t>(history_len));
+}
+
+inline uint64_t shm_now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Read-only view of a published segment.
+class StateShmReader {
+public:
+    ~StateShmReader() { close(); }
+
+    bool open(const std::string& name = kDefaultShmName) {
+        close();
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmHeader)) { ::close(fd); return false; }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base_ = p;
+        size_ = static_cast<size_t>(st.st_size);
+        if (header()->magic != kShmMagic || header()->version != kShmVersion ||
+            header()->record_size != sizeof(ShmStateRecord) ||
+            size_ < shm_segment_size(header()->history_len)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_) munmap(base_, size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    bool isOpen() const { return base_ != nullptr; }
+    uint32_t historyLen() const { return header()->history_len; }
+    uint64_t writeCount() const { return header()->write_count.load(std::memory_order_acquire); }
+
+    // Latest record (consistent snapshot).
+    void latest(ShmStateRecord& out) const { slots()[0].load(out); }
+
+    // Record number `n` (1-based frame_seq) from the history ring; false if it
+    // has not been written yet or was already overwritten.
+    bool history(uint64_t n, ShmStateRecord& out) const {
+        if (n == 0) return false;
+        const ShmSlot& s = slots()[1 + (n - 1) % header()->history_len];
+        s.load(out);
+        return out.frame_seq == n;
+    }
+
+private:
+    const ShmHeader* header() const { return static_cast<const ShmHeader*>(base_); }
+    const ShmSlot* slots() const {
+        return reinterpret_cast<const ShmSlot*>(static_cast<const uint8_t*>(base_) + sizeof(ShmHeader));
+    }
+
+    void* base_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,169 @@
+#include "writer.h"
+#include "../util/thread_topology.h"
+#include "../util/alloc_trace.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+void SnapshotWriter::init() {
+    init(Config());
+}
+
+void SnapshotWriter::init(const Config& cfg) {
+    std::lock_guard<std::mutex> lk(init_m_);
+    if (initialized_.load(std::memory_order_relaxed)) return;
+    cfg_ = cfg;
+    if (cfg_.workers < 1) cfg_.workers = 1;
+    if (cfg_.max_queue < 1) cfg_.max_queue = 1;
+    if (cfg_.bucket_us == 0) cfg_.bucket_us = 600000000ULL;
+    cfg_.jpeg_quality = std::min(100, std::max(1, cfg_.jpeg_quality));
+
+    out_dir_ = cfg_.out_dir;
+    if (out_dir_.empty()) {
+        const char* env = std::getenv("ARUCO_OUT_DIR");
+        out_dir_ = (env && *env) ? std::string(env) : std::string("/data/yash_project/frames");
+    }
+    root_ = out_dir_ + "/snapshots";
+    try {
+        std::filesystem::create_directories(root_);
+    } catch (const std::exception& e) {
+        std::cerr << "SnapshotWriter: cannot create " << root_ << ": " << e.what() << std::endl;
+        init_failed_ = true;
+        initialized_.store(true, std::memory_order_release);
+        return;
+    }
+
+    running_ = true;
+    for (int i = 0; i < cfg_.workers; i++)
+        workers_.emplace_back([this, i]{ this->run(i); });
+    initialized_.store(true, std::memory_order_release);
+}
+
+bool SnapshotWriter::submit(const cv::Mat& frame, std::string_view json, uint64_t ts_us,
+                            const std::string& tag) {
+    // the pool is started from main, never lazily on the process thread
+    if (!initialized_.load(std::memory_order_acquire) || init_failed_.load(std::memory_order_relaxed)) return false;
+    if (!running_ || frame.empty()) return false;
+
+    // cheap early-out before copying the frame
+    if (queued_.load(std::memory_order_relaxed) >= cfg_.max_queue) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // the caller's buffer may be reused by the camera, so take an owned copy
+    Job job;
+    job.frame = frame.clone();
+    ALLOC_TRACE_COPY(frame.total() * frame.elemSize());
+    job.json.assign(json.data(), json.size());
+    job.tag = tag;
+    job.ts_us = ts_us;
+
+    {
+        std::unique_lock<std::mutex> lk(m_, std::try_to_lock);
+        if (!lk.owns_lock() || queue_.size() >= cfg_.max_queue) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(std::move(job));
+        size_t q = queue_.size();
+        queued_.store(q, std::memory_order_relaxed);
+        if (q > high_water_.load(std::memory_order_relaxed))
+            high_water_.store(q, std::memory_order_relaxed);
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    cv_.notify_one();
+    return true;
+}
+
+void SnapshotWriter::shutdown() {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_)
+        if (t.joinable()) t.join();
+    workers_.clear();
+}
+
+SnapshotWriter::Stats SnapshotWriter::stats() const {
+    Stats s;
+    s.submitted = submitted_.load(std::memory_order_relaxed);
+    s.written = written_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.failed = failed_.load(std::memory_order_relaxed);
+    s.queued = queued_.load(std::memory_order_relaxed);
+    s.high_water = high_water_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void SnapshotWriter::run(int index) {
+    ThreadTopology::instance().applyToCurrentThread("output", "output:" + std::to_string(index));
+    std::vector<uchar> enc; // per-worker encode buffer, reused
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&]{ return !queue_.empty() || !running_; });
+            // on shutdown keep draining until the queue is empty
+            if (queue_.empty()) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            queued_.store(queue_.size(), std::memory_order_relaxed);
+        }
+        write_job(job, enc);
+    }
+}
+
+void SnapshotWriter::write_job(const Job& job, std::vector<uchar>& enc) {
+    try {
+        std::string dir = bucket_dir(job.ts_us);
+        if (dir.empty()) { failed_.fetch_add(1, std::memory_order_relaxed); return; }
+        std::string img = dir + "/frame_" + (job.tag.empty() ? std::string() : job.tag + "_") +
+                          std::to_string(job.ts_us) + ".jpg";
+
+        const std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, cfg_.jpeg_quality};
+        if (!cv::imencode(".jpg", job.frame, enc, params)) {
+            std::cerr << "SnapshotWriter: failed to encode " << img << std::endl;
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        {
+            std::ofstream f(img, std::ios::binary);
+            f.write(reinterpret_cast<const char*>(enc.data()), static_cast<std::streamsize>(enc.size()));
+            if (!f.good()) {
+                std::cerr << "SnapshotWriter: failed to write " << img << std::endl;
+                failed_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        std::ofstream(img + ".json") << job.json;
+        written_.fetch_add(1, std::memory_order_relaxed);
+    } catch (const std::exception& e) {
+        std::cerr << "SnapshotWriter exception: " << e.what() << std::endl;
+        failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::string SnapshotWriter::bucket_dir(uint64_t ts_us) {
+    uint64_t bucket = ts_us / cfg_.bucket_us;
+    std::lock_guard<std::mutex> lk(dir_m_);
+    if (bucket == last_bucket_) return last_bucket_dir_;
+
+    std::string dir = root_ + "/" + std::to_string(bucket * cfg_.bucket_us / 1000000ULL);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "SnapshotWriter: cannot create " << dir << ": " << ec.message() << std::endl;
+        return std::string();
+    }
+    last_bucket_ = bucket;
+    last_bucket_dir_ = dir;
+    return dir;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Asynchronous snapshot writer (frame JPEG + JSON metadata).
+// submit() only copies the frame into a bounded queue and never waits on I/O;
+// a small worker pool encodes and writes. Snapshots are grouped into
+// time-bucketed subdirectories: <out_dir>/snapshots/<bucket_start_s>/.
+class SnapshotWriter {
+public:
+    struct Config {
+        std::string out_dir;               // empty -> ARUCO_OUT_DIR or default
+        int workers = 2;                   // encoder threads
+        size_t max_queue = 16;             // pending snapshots before dropping
+        uint64_t bucket_us = 600000000ULL; // 10 min per subdirectory
+        int jpeg_quality = 95;             // cv::imwrite default, as before the pool
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;  // accepted into the queue
+        uint64_t written = 0;    // jpg+json written
+        uint64_t dropped = 0;    // rejected because the queue was full/busy
+        uint64_t failed = 0;     // encode or write errors
+        size_t queued = 0;       // current backlog
+        size_t high_water = 0;   // max backlog seen
+    };
+
+    static SnapshotWriter& instance() {
+        static SnapshotWriter inst;
+        return inst;
+    }
+
+    // Create the output root once and start the worker pool. Idempotent, and
+    // attempted only once. Call it at startup (main does when saving is on):
+    // submit() never starts the pool itself, so it returns false before a
+    // successful init().
+    void init();
+    void init(const Config& cfg);
+
+    // Queue one snapshot. Never blocks: returns false (and counts a drop)
+    // when the queue is full or momentarily contended. A non-empty `tag`
+    // (the camera name) goes into the file name: frame_<tag>_<ts>.jpg.
+    bool submit(const cv::Mat& frame, std::string_view json, uint64_t ts_us,
+                const std::string& tag = std::string());
+
+    // Stop accepting, write everything still queued and join the workers.
+    void shutdown();
+
+    Stats stats() const;
+    const std::string& outDir() const { return out_dir_; }
+
+private:
+    struct Job {
+        cv::Mat frame;
+        std::string json;
+        std::string tag;
+        uint64_t ts_us = 0;
+    };
+
+    SnapshotWriter() = default;
+    ~SnapshotWriter() { shutdown(); }
+
+    void run(int index);
+    void write_job(const Job& job, std::vector<uchar>& enc);
+    std::string bucket_dir(uint64_t ts_us);
+
+    Config cfg_;
+    std::string out_dir_;
+    std::string root_;
+
+    std::mutex init_m_;
+    std::atomic<bool> initialized_{false}; // init attempted (submit's lock-free check)
+    std::atomic<bool> init_failed_{false};
+
+    std::vector<std::thread> workers_;
+    mutable std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<Job> queue_;
+    std::atomic<bool> running_{false};
+
+    // bucket directories already created (only the most recent is kept hot)
+    std::mutex dir_m_;
+    uint64_t last_bucket_ = UINT64_MAX;
+    std::string last_bucket_dir_;
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> high_water_{0};
+};
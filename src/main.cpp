@@ -1,17 +1,32 @@
-#include "pipeline/v4l2_source.h"
-#include "pipeline/video_file_source.h"
-#include "pipeline/image_sequence_source.h"
-#include "pipeline/nvargus_source.h"
+#include "pipeline/source_factory.h"
+#include "pipeline/multi_camera.h"
 #include "processing/aruco_tracker.h"
-#include "util/ring_buffer.h"
+#include "processing/param_tuner.h"
+#include "processing/state_snapshot.h"
+#include "processing/motion_history.h"
+#include "util/frame_bus.h"
 #include "util/csv_logger.h"
+#include "io/writer.h"
+#include "io/state_publisher.h"
+#include "io/http_server.h"
+#include "io/control_server.h"
+#include "io/live_encoder.h"
+#include "io/overlay.h"
+#include "io/recorder.h"
+#include "util/metrics.h"
+#include "util/thread_topology.h"
+#include "util/alloc_trace.h"
+#include "util/startup_timeline.h"
 
 #include <gst/gst.h>
 #include <atomic>
+#include <cmath>
 #include <csignal>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <chrono>
+#include <future>
 #include <thread>
 #include <sstream>
 #include <iomanip>
@@ -21,8 +36,16 @@ static std::atomic<bool> running(true);
 void sigint(int) { running = false; }
 
 int main(int argc, char** argv) {
+    StartupTimeline::instance().begin();
     signal(SIGINT, sigint);
 
+    // Offline parameter search replaces the normal run entirely
+    for (int i=1;i<argc;i++)
+        if (std::string(argv[i]) == "--tune") return tuner_main(argc, argv);
+    // Several cameras in one process, each with its own capture/tracker pair
+    for (int i=1;i<argc;i++)
+        if (std::string(argv[i]) == "--cameras") return multi_camera_main(argc, argv);
+
     // parse args
     bool display = false;
     int width = 640, height = 480;
@@ -38,6 +61,40 @@ int main(int argc, char** argv) {
     bool enable_live = true;
     bool enable_csv = true;
     bool enable_metrics = true;
+    bool udp_binary = false; // UDP metrics as state_schema binary records
+    SnapshotWriter::Config snap_cfg;
+    int snap_bucket_sec = 600;
+    bool enable_shm = true;
+    std::string shm_name = kDefaultShmName;
+    int shm_history = 256;
+    int metrics_port = 9101; // Prometheus endpoint on 127.0.0.1; 0 disables
+    std::string control_socket; // empty = no runtime control
+    bool enable_history = true; // /history on the metrics port
+    std::string params_path = "config/tracker_params.json";
+    bool params_explicit = false;
+    int gate_override = -1; // -1 = from params file
+    double gate_threshold = -1;
+    int quality_override = -1; // -1 = from params file
+    bool adaptive_redetect = false;
+    std::string calib_path;
+    bool pose_flag = false;
+    int undistort_step = 0;  // 0 = raw image coordinates
+    std::string undistort_cache;
+    std::string detect_tiles;  // "CxR"; empty = from params file
+    int detect_threads = -1;
+    std::string track_mode;
+    std::string lk_backend;
+    int pyramid_workers = 0;  // 0 = build LK pyramids inline (--lk-backend cpu)
+    int pyramid_depth = 0;    // 0 = workers + 2
+    std::string topology_path;
+    std::string pin_spec;
+    double display_hz = 30;
+    double overlay_scale = 1.0;
+    LiveEncoder::Config live_cfg;
+    FrameRecorder::Config rec_cfg;
+    double record_hz = 0;   // 0 = every captured frame
+    int record_queue = 32;
+    bool warmup = true;
 
     for (int i=1;i<argc;i++) {
         std::string a(argv[i]);
@@ -58,173 +115,498 @@ int main(int argc, char** argv) {
         else if (a == "--no-live") { enable_live = false; }
         else if (a == "--no-csv") { enable_csv = false; }
         else if (a == "--no-metrics") { enable_metrics = false; }
+        else if (a == "--udp-binary") { udp_binary = true; }
+        else if (a == "--snapshot-workers" && i+1<argc) { snap_cfg.workers = atoi(argv[++i]); }
+        else if (a == "--snapshot-queue" && i+1<argc) { snap_cfg.max_queue = static_cast<size_t>(atoi(argv[++i])); }
+        else if (a == "--snapshot-quality" && i+1<argc) { snap_cfg.jpeg_quality = atoi(argv[++i]); }
+        else if (a == "--snapshot-bucket-sec" && i+1<argc) { snap_bucket_sec = atoi(argv[++i]); }
+        else if (a == "--no-shm") { enable_shm = false; }
+        else if (a == "--shm-name" && i+1<argc) { shm_name = argv[++i]; }
+        else if (a == "--shm-history" && i+1<argc) { shm_history = atoi(argv[++i]); }
+        else if (a == "--metrics-port" && i+1<argc) { metrics_port = atoi(argv[++i]); }
+        else if (a == "--control-socket" && i+1<argc) { control_socket = argv[++i]; }
+        else if (a == "--no-history") { enable_history = false; }
+        else if (a == "--params" && i+1<argc) { params_path = argv[++i]; params_explicit = true; }
+        else if (a == "--track-mode" && i+1<argc) { track_mode = argv[++i]; }
+        else if (a == "--lk-backend" && i+1<argc) { lk_backend = argv[++i]; }
+        else if (a == "--pyramid-workers" && i+1<argc) { pyramid_workers = atoi(argv[++i]); }
+        else if (a == "--pyramid-depth" && i+1<argc) { pyramid_depth = atoi(argv[++i]); }
+        else if (a == "--gate") { gate_override = 1; }
+        else if (a == "--no-gate") { gate_override = 0; }
+        else if (a == "--gate-threshold" && i+1<argc) { gate_threshold = atof(argv[++i]); }
+        else if (a == "--quality") { quality_override = 1; }
+        else if (a == "--no-quality") { quality_override = 0; }
+        else if (a == "--adaptive-redetect") { adaptive_redetect = true; }
+        else if (a == "--calib" && i+1<argc) { calib_path = argv[++i]; }
+        else if (a == "--pose") { pose_flag = true; }
+        else if (a == "--undistort") { if (undistort_step <= 0) undistort_step = 8; }
+        else if (a == "--undistort-step" && i+1<argc) { undistort_step = atoi(argv[++i]); }
+        else if (a == "--undistort-cache" && i+1<argc) { undistort_cache = argv[++i]; }
+        else if (a == "--detect-tiles" && i+1<argc) { detect_tiles = argv[++i]; }
+        else if (a == "--detect-threads" && i+1<argc) { detect_threads = atoi(argv[++i]); }
+        else if (a == "--topology" && i+1<argc) { topology_path = argv[++i]; }
+        else if (a == "--pin" && i+1<argc) { pin_spec = argv[++i]; }
+        else if (a == "--display-hz" && i+1<argc) { display_hz = atof(argv[++i]); }
+        else if (a == "--live-hz" && i+1<argc) { live_cfg.hz = atof(argv[++i]); }
+        else if (a == "--overlay-scale" && i+1<argc) { overlay_scale = atof(argv[++i]); }
+        else if (a == "--record" && i+1<argc) { rec_cfg.path = argv[++i]; }
+        else if (a == "--record-fps" && i+1<argc) { rec_cfg.fps = atof(argv[++i]); }
+        else if (a == "--record-hz" && i+1<argc) { record_hz = atof(argv[++i]); }
+        else if (a == "--record-queue" && i+1<argc) { record_queue = atoi(argv[++i]); }
+        else if (a == "--record-fourcc" && i+1<argc) { rec_cfg.fourcc = argv[++i]; }
+        else if (a == "--no-warmup") { warmup = false; }
+    }
+
+    // Thread placement must be known before any worker thread starts.
+    // --pin entries override the same roles from --topology.
+    auto& topo = ThreadTopology::instance();
+    if (!topology_path.empty() && !topo.load(topology_path)) {
+        std::cerr << "Failed to load --topology " << topology_path << std::endl;
+        return -1;
+    }
+    if (!pin_spec.empty() && !topo.parse(pin_spec)) {
+        std::cerr << "Invalid --pin spec: " << pin_spec << " (expected role=CPUS[:PRIO],...)" << std::endl;
+        return -1;
+    }
+
+    // Instrumentation build only: count cv::Mat buffers with the heap allocations
+    alloc_trace::install();
+
+    // Tracking parameters (LK, re-detection cadence, motion smoothing)
+    TrackerParams params;
+    if (load_tracker_params(params_path, params)) {
+        std::cerr << "Loaded tracker parameters from " << params_path << std::endl;
+    } else if (params_explicit) {
+        std::cerr << "Failed to load --params " << params_path << std::endl;
+        return -1;
+    }
+    if (!track_mode.empty() && !parse_track_mode(track_mode, params.track_mode)) {
+        std::cerr << "Unknown --track-mode " << track_mode << " (lk|homography)" << std::endl;
+        return -1;
+    }
+    if (!lk_backend.empty() && !parse_lk_backend(lk_backend, params.lk_backend)) {
+        std::cerr << "Unknown --lk-backend " << lk_backend << " (cuda|cpu)" << std::endl;
+        return -1;
+    }
+    if (gate_override >= 0) params.gate.enabled = gate_override != 0;
+    if (gate_threshold >= 0) params.gate.threshold = gate_threshold;
+    if (quality_override >= 0) params.quality.enabled = quality_override != 0;
+    if (adaptive_redetect) params.redetect.adaptive = true;
+    if (!detect_tiles.empty()) {
+        int c = 0, r = 0;
+        if (sscanf(detect_tiles.c_str(), "%dx%d", &c, &r) != 2 || c < 1 || r < 1) {
+            std::cerr << "Bad --detect-tiles " << detect_tiles << " (expected CxR, e.g. 2x2)" << std::endl;
+            return -1;
+        }
+        params.tiles.cols = c;
+        params.tiles.rows = r;
+        params.tiles.enabled = c * r > 1;
+    }
+    if (detect_threads >= 0) params.tiles.threads = detect_threads;
+
+    // Camera intrinsics for the metric pose stage
+    CameraCalibration calib;
+    if (!calib_path.empty() && !load_camera_calibration(calib_path, calib)) {
+        std::cerr << "Failed to load --calib " << calib_path << std::endl;
+        return -1;
+    }
+    if (pose_flag) params.pose.enabled = true;
+    if (params.pose.enabled && !calib.valid())
+        std::cerr << "Warning: pose stage enabled without --calib; no pose will be solved" << std::endl;
+    if (undistort_step > 0 && !calib.valid()) {
+        std::cerr << "--undistort needs --calib" << std::endl;
+        return -1;
     }
 
+    // Warm-up, in parallel with GStreamer start-up (which can wait up to 1 s
+    // for PLAYING): CUDA context, LK and detector run once on synthetic
+    // frames, and the output sinks are created and the JPEG encoder loaded,
+    // so the first real frame costs what every later frame costs.
+    std::unique_ptr<ArucoTracker> tracker_ptr;
+    auto warm_tracker = std::async(std::launch::async, [&]{
+        tracker_ptr = std::make_unique<ArucoTracker>(params);
+        if (calib.valid()) tracker_ptr->setCalibration(calib);
+        if (undistort_step > 0) tracker_ptr->setUndistortion(undistort_step, undistort_cache);
+        ArucoTracker::Options opts{enable_save, enable_csv, enable_metrics};
+        opts.metrics_binary = udp_binary;
+        tracker_ptr->setOptions(opts);
+        if (warmup) tracker_ptr->warmUp(cv::Size(width, height));
+        StartupTimeline::instance().mark("tracker_warm");
+    });
+    auto warm_outputs = std::async(std::launch::async, [&]{
+        // Initialize CSV logger (out dir from ARUCO_OUT_DIR or default)
+        CsvLogger::instance().init();
+
+        // Snapshot writer: output dirs and encoder pool are set up once, off the hot path
+        if (enable_save) {
+            snap_cfg.out_dir = CsvLogger::instance().outDir();
+            if (snap_bucket_sec > 0) snap_cfg.bucket_us = static_cast<uint64_t>(snap_bucket_sec) * 1000000ULL;
+            SnapshotWriter::instance().init(snap_cfg);
+        }
+        if (warmup && (enable_save || enable_live)) {
+            std::vector<uchar> jpg;
+            cv::imencode(".jpg", cv::Mat(height, width, CV_8UC3, cv::Scalar::all(0)), jpg);
+        }
+        StartupTimeline::instance().mark("outputs_ready");
+    });
+
     // REQUIRED for GStreamer
     gst_init(&argc, &argv);
-
-    // Initialize CSV logger (out dir from ARUCO_OUT_DIR or default)
-    CsvLogger::instance().init();
+    StartupTimeline::instance().mark("gst_init");
 
     // create FrameSource based on --source
-    std::string source = "camera";
-    std::string source_path;
+    SourceConfig src_cfg;
+    src_cfg.width = width; src_cfg.height = height; src_cfg.framerate = framerate;
+    src_cfg.io_mode = io_mode; src_cfg.queue = queue_sz; src_cfg.max_buffers = max_buffers;
+    src_cfg.reuse_buffer = reuse_buffer; src_cfg.device = device;
     for (int i=1;i<argc;i++) {
         std::string a(argv[i]);
-        if (a == "--source" && i+1<argc) source = argv[++i];
-        else if (a == "--source-path" && i+1<argc) source_path = argv[++i];
-    }
-
-    std::unique_ptr<FrameSource> camp;
-    if (source == "camera") {
-        std::unique_ptr<V4L2CameraSource> cam =
-            std::make_unique<V4L2CameraSource>(width, height, framerate, 1, io_mode, queue_sz, max_buffers, true, false, reuse_buffer, device);
-        if (!cam->open()) { std::cerr << "Camera open failed\n"; return -1; }
-        camp = std::move(cam);
-    } else if (source == "csi") {
-        auto cam = std::make_unique<NvArgusSource>(width, height, framerate, 1, max_buffers, true, false);
-        if (!cam->open()) { std::cerr << "CSI camera open failed\n"; return -1; }
-        camp = std::move(cam);
-    } else if (source == "video") {
-        if (source_path.empty()) { std::cerr << "--source-path required for video\n"; return -1; }
-        auto vf = std::make_unique<VideoFileSource>(source_path);
-        if (!vf->open()) { std::cerr << "Video file open failed\n"; return -1; }
-        camp = std::move(vf);
-    } else if (source == "sequence") {
-        if (source_path.empty()) { std::cerr << "--source-path required for sequence\n"; return -1; }
-        auto seq = std::make_unique<ImageSequenceSource>(source_path);
-        if (!seq->open()) { std::cerr << "Image sequence open failed\n"; return -1; }
-        camp = std::move(seq);
-    } else {
-        std::cerr << "Unknown --source: " << source << std::endl;
-        return -1;
+        if (a == "--source" && i+1<argc) src_cfg.source = argv[++i];
+        else if (a == "--source-path" && i+1<argc) src_cfg.path = argv[++i];
     }
+    const std::string& source = src_cfg.source;
 
-    ArucoTracker tracker;
-    tracker.setOptions({enable_save, enable_live, enable_csv, enable_metrics});
+    std::unique_ptr<FrameSource> camp = open_frame_source(src_cfg);
+    if (!camp) return -1;
+    StartupTimeline::instance().mark("source_open");
 
-    if (display) {
-        cv::namedWindow("Live", cv::WINDOW_AUTOSIZE);
-        // Quick check: is display usable? If not, warn the user.
-        double prop = cv::getWindowProperty("Live", cv::WND_PROP_AUTOSIZE);
-        if (prop < 0) {
-            std::cerr << "Warning: display window could not be created; are you running headless or without X?\n";
-        }
+    // both warm-ups overlap the pipeline start above; returns before this
+    // point still join them through the futures' destructors
+    warm_tracker.get();
+    warm_outputs.get();
+    StartupTimeline::instance().mark("ready");
+    ArucoTracker& tracker = *tracker_ptr;
+
+    // Shared-memory state for local consumers (seqlock, no serialisation)
+    StateShmPublisher shm;
+    if (enable_shm && !shm.open(shm_name, static_cast<uint32_t>(std::max(1, shm_history)))) {
+        std::cerr << "Warning: shared-memory state publication disabled\n";
     }
 
     // FPS counters
     std::atomic<int> proc_fps_cnt{0};
     std::atomic<int> cap_fps_cnt{0};
-    std::atomic<int> dropped_cnt{0};
     auto t0_report = std::chrono::high_resolution_clock::now();
+    uint64_t last_trk_dropped = 0;
     std::atomic<int> total_frames{0};
 
-    // Define a simple frame item for the ring buffer
-    struct FrameItem { cv::Mat frame; uint64_t ts; };
+    // Frame bus: capture publishes once, every consumer gets its own bounded
+    // queue over the same reference-counted frame
+    FrameBus bus;
+    auto trk_sub = bus.subscribe({"tracker", static_cast<size_t>(std::max(1, ring_size)),
+                                  ring_drop_oldest ? DropPolicy::DropOldest : DropPolicy::DropNewest, 0});
+    std::shared_ptr<FrameSubscription> overlay_sub, rec_sub;
+    // one renderer serves the window and the live feed, at the faster of the two rates
+    if (display || enable_live)
+        overlay_sub = bus.subscribe({"overlay", 1, DropPolicy::DropOldest,
+                                     std::max(display ? display_hz : 0.0, enable_live ? live_cfg.hz : 0.0)});
+    if (!rec_cfg.path.empty())
+        rec_sub = bus.subscribe({"recorder", static_cast<size_t>(std::max(1, record_queue)), DropPolicy::DropNewest, record_hz});
+    StateSnapshot overlay_state;
 
-    RingBuffer<FrameItem> ring(ring_size, ring_drop_oldest);
+    // Metrics: hot-path updates are relaxed atomics; the rest is sampled at scrape time
+    auto& metrics = MetricsRegistry::instance();
+    Counter& m_captured = metrics.counter("tracker_frames_captured_total", "Frames published on the frame bus");
+    Counter& m_processed = metrics.counter("tracker_frames_processed_total", "Frames run through ArucoTracker::process");
+    Histogram& m_proc_lat = metrics.histogram("tracker_process_seconds", "Wall time of ArucoTracker::process");
+    Histogram& m_cap_interval = metrics.histogram("tracker_capture_interval_seconds", "Timestamp delta between captured frames",
+                                                  {2e-3, 4e-3, 6e-3, 8e-3, 8.33e-3, 9e-3, 10e-3, 12e-3, 16.7e-3, 25e-3, 50e-3, 100e-3});
+    // tracker queue keeps the old ring metric names
+    metrics.callback("tracker_frames_dropped_total", "Frames rejected by a full tracker queue (drop-new policy)", "counter",
+                     [&]{ return ring_drop_oldest ? 0.0 : static_cast<double>(trk_sub->stats().dropped); });
+    metrics.callback("tracker_ring_evicted_total", "Frames evicted from the tracker queue (drop-oldest policy)", "counter",
+                     [&]{ return ring_drop_oldest ? static_cast<double>(trk_sub->stats().dropped) : 0.0; });
+    metrics.callback("tracker_ring_occupancy", "Frames waiting in the tracker queue", "gauge",
+                     [&]{ return static_cast<double>(trk_sub->stats().queued); });
+    for (auto sub : {trk_sub, overlay_sub, rec_sub}) {
+        if (!sub) continue;
+        std::string lb = "subscriber=\"" + sub->config().name + "\"";
+        FrameSubscription* sp = sub.get();
+        metrics.callback("tracker_bus_delivered_total", "Frames handed to a bus subscriber", "counter",
+                         [sp]{ return static_cast<double>(sp->stats().delivered); }, lb);
+        metrics.callback("tracker_bus_dropped_total", "Frames lost to a full subscriber queue", "counter",
+                         [sp]{ return static_cast<double>(sp->stats().dropped); }, lb);
+        metrics.callback("tracker_bus_rate_skipped_total", "Frames thinned by a subscriber rate limit", "counter",
+                         [sp]{ return static_cast<double>(sp->stats().rate_skipped); }, lb);
+        metrics.callback("tracker_bus_queue_depth", "Frames waiting in a subscriber queue", "gauge",
+                         [sp]{ return static_cast<double>(sp->stats().queued); }, lb);
+        metrics.callback("tracker_bus_lag_frames", "Frames published after the one a subscriber last took", "gauge",
+                         [sp]{ return static_cast<double>(sp->stats().lag_frames); }, lb);
+        metrics.callback("tracker_bus_lag_seconds", "Publish-to-pop latency of a subscriber's last frame", "gauge",
+                         [sp]{ return sp->stats().lag_s; }, lb);
+    }
+    metrics.callback("tracker_csv_dropped_total", "CSV lines dropped by the bounded logger queue", "counter",
+                     []{ return static_cast<double>(CsvLogger::instance().dropped()); });
+    metrics.callback("tracker_csv_queue_depth", "CSV lines waiting to be written", "gauge",
+                     []{ return static_cast<double>(CsvLogger::instance().queueDepth()); });
+    if (enable_save) {
+        metrics.callback("tracker_snapshot_queue_depth", "Snapshots waiting for the writer pool", "gauge",
+                         []{ return static_cast<double>(SnapshotWriter::instance().stats().queued); });
+        metrics.callback("tracker_snapshot_written_total", "Snapshots written to disk", "counter",
+                         []{ return static_cast<double>(SnapshotWriter::instance().stats().written); });
+        metrics.callback("tracker_snapshot_dropped_total", "Snapshots dropped due to writer backpressure", "counter",
+                         []{ return static_cast<double>(SnapshotWriter::instance().stats().dropped); });
+    }
 
-    // Capture thread: pushes frames into ring buffer
+    // Multi-resolution motion history for dashboards (fixed memory, served on /history)
+    std::unique_ptr<MotionHistory> history;
+    if (enable_history && metrics_port > 0) {
+        MotionHistory::Config hc;
+        hc.max_fps = std::max(1, framerate);
+        history = std::make_unique<MotionHistory>(hc);
+    }
+
+    HttpServer http;
+    if (metrics_port > 0) {
+        http.handle("/metrics", [](const std::string&) {
+            HttpServer::Response r;
+            r.body = MetricsRegistry::instance().render();
+            return r;
+        });
+        if (history) {
+            // /history?from=-3600&to=&res=auto|raw|1s|10s|1m&max_rows=2000
+            http.handle("/history", [&history](const std::string& q) {
+                HttpServer::Response r;
+                int res = -2;
+                if (!MotionHistory::parseRes(HttpServer::param(q, "res"), res)) {
+                    r.status = 400;
+                    r.body = "res must be raw, 1s, 10s, 1m or auto\n";
+                    return r;
+                }
+                auto num = [&q](const char* key) {
+                    const std::string v = HttpServer::param(q, key);
+                    return v.empty() ? std::nan("") : atof(v.c_str());
+                };
+                const std::string rows = HttpServer::param(q, "max_rows", "2000");
+                r.content_type = "application/json";
+                r.body = history->json(num("from"), num("to"), res, static_cast<size_t>(std::max(1, atoi(rows.c_str()))));
+                return r;
+            });
+        }
+        http.start(static_cast<uint16_t>(metrics_port));
+    }
+
+    // Runtime control: the socket thread publishes new config versions, the
+    // process loop picks them up between frames without taking a lock
+    RuntimeConfig runtime_init;
+    runtime_init.params = params;
+    runtime_init.options = {enable_save, enable_csv, enable_metrics};
+    runtime_init.options.metrics_binary = udp_binary;
+    runtime_init.process_every = process_every;
+    ConfigSnapshot<RuntimeConfig> runtime(runtime_init);
+    uint64_t params_version = runtime_init.params_version;
+    ControlServer control;
+    if (!control_socket.empty()) {
+        RuntimeLimits limits;
+        limits.save_available = enable_save;
+        add_runtime_commands(control, runtime, limits);
+        control.start(control_socket);
+        metrics.callback("tracker_config_version", "Runtime configuration version in use by the process loop", "gauge",
+                         [&runtime]{ return static_cast<double>(runtime.applied()); });
+    }
+
+    LiveEncoder live;
+    if (enable_live) live.start(live_cfg);
+    OverlayRenderer overlay;
+    if (overlay_sub) {
+        OverlayRenderer::Config oc;
+        oc.window = display;
+        oc.live_hz = enable_live ? live_cfg.hz : 0;
+        oc.scale = overlay_scale;
+        overlay.start(overlay_sub, overlay_state, oc, enable_live ? &live : nullptr, []{ running = false; });
+    }
+    FrameRecorder recorder;
+    if (rec_sub) recorder.start(rec_sub, rec_cfg);
+
+    // Capture thread: publishes every frame on the bus
     std::thread capture_thread([&](){
+        ThreadTopology::instance().applyToCurrentThread("capture");
+        // --reuse-buffer sources overwrite one scratch Mat; copy into recycled
+        // buffers so subscribers still holding a frame never see it change
+        FramePool pool(static_cast<size_t>(ring_size + record_queue + 4));
+        uint64_t last_ts = 0;
+        ALLOC_STAGE("capture");
+        bool cap_started = false;
         while (running) {
-            FrameItem it;
-            if (!camp->grab(it.frame, it.ts)) continue;
-            bool ok = ring.push(it);
-            if (ok) {
-                cap_fps_cnt++;
+            cv::Mat frame; // fresh header: never write into a frame subscribers may hold
+            uint64_t ts = 0;
+            if (!camp->grab(frame, ts)) continue;
+            if (!cap_started) { StartupTimeline::instance().mark("first_frame"); cap_started = true; }
+            if (last_ts && ts > last_ts) m_cap_interval.observe((ts - last_ts) * 1e-6);
+            last_ts = ts;
+            if (reuse_buffer && source == "camera") {
+                cv::Mat own = pool.acquire(frame.rows, frame.cols, frame.type());
+                frame.copyTo(own);
+                ALLOC_TRACE_COPY(frame.total() * frame.elemSize());
+                bus.publish(own, ts);
             } else {
-                dropped_cnt++;
+                bus.publish(frame, ts);
             }
+            cap_fps_cnt++;
+            m_captured.inc();
         }
         // on exit, ensure consumers wake up
-        ring.close();
+        bus.close();
     });
 
-    // Processing loop: pop frames from ring and process
-    bool overlay_on = true;
+    // CPU LK: pyramids for the next frames are built on worker threads while
+    // this loop tracks; a feeder moves frames from the bus into the pipeline
+    std::unique_ptr<PyramidPipeline> pyramids;
+    std::thread pyramid_feed;
+    if (params.lk_backend == LkBackend::Cpu && pyramid_workers > 0) {
+        PyramidPipeline::Config pc;
+        pc.workers = pyramid_workers;
+        pc.depth = pyramid_depth > 0 ? pyramid_depth : pyramid_workers + 2;
+        pc.win_size = params.lk_win_size;
+        pc.max_level = params.lk_max_level;
+        pyramids = std::make_unique<PyramidPipeline>(pc);
+        pyramid_feed = std::thread([&]{
+            FramePtr f;
+            while (trk_sub->pop(f))
+                if (!pyramids->push(f->image, f->ts_us)) break;
+            pyramids->close();
+        });
+        metrics.callback("tracker_pyramid_in_flight", "Frames in the pyramid pipeline (building or waiting in order)", "gauge",
+                         [&]{ return static_cast<double>(pyramids->stats().in_flight); });
+        metrics.callback("tracker_pyramid_reordered_total", "Pyramids finished while an earlier frame was still building", "counter",
+                         [&]{ return static_cast<double>(pyramids->stats().reordered); });
+    }
+
+    // Processing loop: pop frames from the tracker subscription and process
+    topo.applyToCurrentThread("process");
+    ALLOC_STAGE("process");
+    Gauge& m_ttft = metrics.gauge("tracker_time_to_first_tracked_frame_seconds",
+                                  "Process start to the first frame with the marker tracked");
+    bool first_tracked = false;
     while (running) {
-        FrameItem it;
-        if (!ring.pop(it)) break; // closed and empty
+        cv::Mat image;
+        uint64_t ts_us = 0;
+        PyramidPtr pyr;
+        if (pyramids) {
+            PyramidPipeline::Item item;
+            if (!pyramids->pop(item)) break; // closed and drained
+            image = item.frame;
+            ts_us = item.ts_us;
+            pyr = std::move(item.pyr);
+        } else {
+            FramePtr it;
+            if (!trk_sub->pop(it)) break; // closed and drained
+            image = it->image;
+            ts_us = it->ts_us;
+        }
+
+        // frame boundary: apply a configuration published by the control socket
+        if (const RuntimeConfig* rc = runtime.poll()) {
+            if (rc->params_version != params_version) {
+                params = rc->params;
+                params_version = rc->params_version;
+                tracker.setParams(params);
+                if (pyramids) pyramids->setGeometry(params.lk_win_size, params.lk_max_level);
+            }
+            tracker.setOptions(rc->options);
+            process_every = rc->process_every;
+            std::cerr << "Control: applied configuration version " << runtime.applied() << std::endl;
+        }
 
         int tf = ++total_frames;
         if (tf % process_every == 0) {
-            tracker.process(it.frame, it.ts);
+            auto tp0 = std::chrono::steady_clock::now();
+            tracker.process(image, ts_us, std::move(pyr));
+            if (tf == process_every) StartupTimeline::instance().mark("first_processed");
+            m_proc_lat.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - tp0).count());
+            shm.publish(tracker.state(), ts_us);
+            if (history) history->push(tracker.state(), ts_us);
+            if (overlay_sub)
+                overlay_state.publish(tracker.state(), params.spectrum.enabled ? &tracker.spectrum() : nullptr, ts_us);
             proc_fps_cnt++;
+            m_processed.inc();
+            if (!first_tracked && tracker.isTracking()) {
+                first_tracked = true;
+                double t = StartupTimeline::instance().mark("first_tracked");
+                m_ttft.set(t);
+                StartupTimeline::instance().report(std::cout);
+                std::cout << "Time to first tracked frame: " << std::fixed << std::setprecision(1)
+                          << t * 1e3 << " ms" << std::endl;
+            }
         }
 
         auto t1_report = std::chrono::high_resolution_clock::now();
         if (std::chrono::duration<double>(t1_report - t0_report).count() >= 1.0) {
+            auto trk = trk_sub->stats();
             std::cout << "Processing FPS: " << proc_fps_cnt.load() << " | Capture FPS: " << cap_fps_cnt.load()
-                      << " | Dropped: " << dropped_cnt.load() << " | Ring size: " << ring.size() << std::endl;
+                      << " | Dropped: " << (trk.dropped - last_trk_dropped) << " | Ring size: " << trk.queued;
+            last_trk_dropped = trk.dropped;
+            for (auto& bs : bus.stats()) {
+                if (bs.name == "tracker") continue;
+                std::cout << " | " << bs.name << " lag/drop: " << std::fixed << std::setprecision(1)
+                          << bs.lag_s * 1e3 << "ms/" << bs.dropped;
+            }
+            if (enable_save) {
+                auto ss = SnapshotWriter::instance().stats();
+                std::cout << " | Snapshots q/written/dropped: " << ss.queued << "/" << ss.written << "/" << ss.dropped;
+            }
+            if (params.gate.enabled) {
+                const auto& gs = tracker.gateStats();
+                std::cout << " | Gate skip: " << std::fixed << std::setprecision(1)
+                          << (gs.checked ? 100.0 * gs.skipped / gs.checked : 0.0) << "%";
+            }
+            if (params.quality.enabled)
+                std::cout << " | Bad frames: " << tracker.qualityStats().rejected;
+            std::cout << std::endl;
             proc_fps_cnt = 0;
             cap_fps_cnt = 0;
-            dropped_cnt = 0;
             t0_report = t1_report;
         }
-
-        if (display) {
-            cv::Mat vis;
-            if (it.frame.channels() == 1) cv::cvtColor(it.frame, vis, cv::COLOR_GRAY2BGR);
-            else vis = it.frame.clone();
-
-            auto& s = tracker.state();
-
-            if (s.tracking) {
-                // draw bbox and marker id
-                if (overlay_on) {
-                    cv::rectangle(vis, s.marker_bbox, cv::Scalar(0,255,0), 2);
-                    std::string idtxt = "ID: " + std::to_string(s.marker_id);
-                    cv::putText(vis, idtxt, {s.marker_bbox.x, std::max(0, s.marker_bbox.y-6)}, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0,255,0), 1);
-                }
-
-                // Draw each quadrant
-                for (int i=0;i<4;i++) {
-                    cv::Scalar col = s.q[i].valid ? cv::Scalar(0,0,255) : cv::Scalar(0,128,255);
-                    cv::Point2f center;
-                    if (s.q[i].valid) center = s.q[i].motion.pos;
-                    else center = cv::Point2f(s.marker_bbox.x + s.marker_bbox.width * (i%2 ? 0.75f : 0.25f),
-                                              s.marker_bbox.y + s.marker_bbox.height * (i<2 ? 0.25f : 0.75f));
-
-                    int ix = cv::saturate_cast<int>(center.x);
-                    int iy = cv::saturate_cast<int>(center.y);
-
-                    if (s.q[i].valid) {
-                        cv::circle(vis, {ix, iy}, 4, col, -1);
-                        if (overlay_on) {
-                            // draw velocity arrow (scaled for visibility)
-                            float vx = s.q[i].motion.vel.x;
-                            float vy = s.q[i].motion.vel.y;
-                            float scale = 0.05f; // px per (velocity unit)
-                            cv::Point dst(cv::saturate_cast<int>(ix + vx*scale), cv::saturate_cast<int>(iy + vy*scale));
-                            cv::arrowedLine(vis, {ix,iy}, dst, cv::Scalar(255,0,0), 1, cv::LINE_AA, 0, 0.3);
-                            // put small text for vx,vy
-                            std::ostringstream os; os << std::fixed << std::setprecision(1) << "v=" << vx << "," << vy;
-                            cv::putText(vis, os.str(), {ix+6, iy-6}, cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(255,255,255), 1);
-                        }
-                    } else {
-                        // draw small X
-                        cv::line(vis, {ix-3,iy-3},{ix+3,iy+3}, col, 1);
-                        cv::line(vis, {ix+3,iy-3},{ix-3,iy+3}, col, 1);
-                    }
-                }
-            }
-
-            cv::imshow("Live", vis);
-            int k = cv::waitKey(1);
-            if (k == 'q' || k == 'Q') {
-                running = false;
-                break;
-            } else if (k == 'o' || k == 'O') {
-                overlay_on = !overlay_on;
-            }
-        }
     }
 
-    // shutdown
-    ring.close();
+    // shutdown (report first, while worker threads are still alive)
+    if (!first_tracked) StartupTimeline::instance().report(std::cout);
+    topo.report(std::cout);
+    http.stop();
+    control.stop();
+    running = false;
+    bus.close();
     if (capture_thread.joinable()) capture_thread.join();
+    if (pyramids) pyramids->close();
+    if (pyramid_feed.joinable()) pyramid_feed.join();
+    overlay.stop();
+    live.stop();
+    recorder.stop();
+    std::cout << "Frame bus: " << bus.published() << " published" << std::endl;
+    for (auto& bs : bus.stats())
+        std::cout << "  " << std::left << std::setw(10) << bs.name << std::right << " delivered " << bs.delivered
+                  << ", dropped " << bs.dropped << ", rate-skipped " << bs.rate_skipped
+                  << ", max lag " << std::fixed << std::setprecision(1) << bs.max_lag_s * 1e3 << " ms" << std::endl;
+    if (rec_sub)
+        std::cout << "Recorder: " << recorder.written() << " frames to " << rec_cfg.path
+                  << (recorder.failed() ? " (open failed)" : "") << std::endl;
 
     CsvLogger::instance().shutdown();
+    if (enable_save) {
+        SnapshotWriter::instance().shutdown(); // flushes queued snapshots
+        auto ss = SnapshotWriter::instance().stats();
+        std::cout << "Snapshots: written " << ss.written << ", dropped " << ss.dropped
+                  << ", failed " << ss.failed << ", max backlog " << ss.high_water << std::endl;
+    }
+    if (params.gate.enabled) {
+        const auto& gs = tracker.gateStats();
+        std::cout << "Motion gate: skipped " << gs.skipped << "/" << gs.checked << " frames ("
+                  << std::fixed << std::setprecision(1) << (gs.checked ? 100.0 * gs.skipped / gs.checked : 0.0)
+                  << "%), ~" << std::setprecision(2) << gs.saved_s << " s CPU saved" << std::endl;
+    }
+    if (params.quality.enabled) {
+        const auto& qs = tracker.qualityStats();
+        const auto& gs = tracker.qualityGate().stats();
+        std::cout << "Quality gate: skipped " << qs.rejected << "/" << gs.checked << " frames (blur " << gs.blurry
+                  << ", exposure " << gs.exposure << ", forced through " << gs.forced << "), "
+                  << qs.detections_skipped << " detections avoided" << std::endl;
+    }
+    if (pyramids) {
+        auto ps = pyramids->stats();
+        std::cout << "Pyramid pipeline: built " << ps.built << ", out of order " << ps.reordered
+                  << ", pool buffers " << ps.pool_allocated << std::endl;
+    }
+    alloc_trace::report(std::cout, static_cast<uint64_t>(total_frames.load()));
     camp->close();
     return 0;
 }
@@ -8,7 +8,7 @@
 #include <iostream>
 #include <cstdint>
 
-inline void send_metrics_udp(const std::string& json_str, const char* host = "127.0.0.1", uint16_t port = 5001)
+inline void send_metrics_udp(const char* data, size_t len, const char* host = "127.0.0.1", uint16_t port = 5001)
 {
     static int sock = -1;
     if (sock == -1) {
@@ -24,13 +24,18 @@ inline void send_metrics_udp(const std::string& json_str, const char* host = "12
     addr.sin_port = htons(port);
     inet_pton(AF_INET, host, &addr.sin_addr);
 
-    ssize_t r = sendto(sock, json_str.c_str(), json_str.size(), 0,
+    ssize_t r = sendto(sock, data, len, 0,
                        (sockaddr*)&addr, sizeof(addr));
     if (r < 0) {
         std::cerr << "UDP: sendto failed" << std::endl;
     }
 }
 
+inline void send_metrics_udp(const std::string& json_str, const char* host = "127.0.0.1", uint16_t port = 5001)
+{
+    send_metrics_udp(json_str.data(), json_str.size(), host, port);
+}
+
 // Send a JPEG image via UDP in fixed-size chunks with a simple header.
 // Header (12 bytes): "IMG0" (4 bytes) | frame_id (4 bytes BE) | total_chunks (2 bytes BE) | chunk_idx (2 bytes BE)
 inline void send_jpeg_udp(const std::vector<uchar>& jpeg,
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <gst/gst.h>
+
+#include <string>
+
+#include "../util/thread_topology.h"
+
+// GStreamer creates its streaming threads internally. Each one posts a
+// STREAM_STATUS/ENTER message from inside the new thread, so a synchronous
+// bus handler can apply the "gstreamer" topology role right there.
+inline GstBusSyncReply gst_thread_topology_sync(GstBus*, GstMessage* msg, gpointer)
+{
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STREAM_STATUS) {
+        GstStreamStatusType type;
+        GstElement* owner = nullptr;
+        gst_message_parse_stream_status(msg, &type, &owner);
+        if (type == GST_STREAM_STATUS_TYPE_ENTER) {
+            std::string name = "gst";
+            if (owner) {
+                gchar* n = gst_element_get_name(owner);
+                name += ":";
+                name += n;
+                g_free(n);
+            }
+            ThreadTopology::instance().applyToCurrentThread("gstreamer", name);
+        }
+    }
+    return GST_BUS_PASS;
+}
+
+// Call before setting the pipeline to PLAYING.
+inline void gst_install_thread_hook(GstElement* pipeline)
+{
+    GstBus* bus = gst_element_get_bus(pipeline);
+    if (!bus) return;
+    gst_bus_set_sync_handler(bus, gst_thread_topology_sync, nullptr, nullptr);
+    gst_object_unref(bus);
+}
@@ -0,0 +1,416 @@
+#include "multi_camera.h"
+#include "../processing/aruco_tracker.h"
+#include "../io/writer.h"
+#include "../io/state_publisher.h"
+#include "../io/http_server.h"
+#include "../util/csv_logger.h"
+#include "../util/frame_bus.h"
+#include "../util/metrics.h"
+#include "../util/thread_topology.h"
+
+#include <gst/gst.h>
+#include <opencv2/core.hpp>
+#include <sched.h>
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <thread>
+
+namespace {
+
+std::atomic<bool> g_running(true);
+
+void on_sigint(int) { g_running = false; }
+
+template <typename T>
+void read_if(const cv::FileNode& n, const char* key, T& out) {
+    cv::FileNode v = n[key];
+    if (!v.empty()) v >> out;
+}
+
+// The name ends up in the shm segment name, Prometheus labels, snapshot
+// paths and CSV rows, so it is kept to characters that are safe in all four.
+constexpr size_t kMaxCameraName = 32;
+
+bool valid_camera_name(const std::string& s) {
+    if (s.empty() || s.size() > kMaxCameraName) return false;
+    for (char c : s)
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-') return false;
+    return true;
+}
+
+void read_cpus(const cv::FileNode& n, std::vector<int>& out) {
+    if (n.isSeq()) {
+        for (auto c = n.begin(); c != n.end(); ++c) out.push_back(static_cast<int>(*c));
+    } else if (n.isInt()) {
+        out.push_back(static_cast<int>(n));
+    }
+}
+
+// Spread cameras without explicit CPUs over the cores this process may use.
+// The first core stays with the shared output/logger threads; each camera's
+// capture and process threads take the next free cores, wrapping round when
+// there are more threads than cores.
+void auto_place(std::vector<CameraConfig>& cams, ThreadTopology& topo) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return;
+    std::vector<int> cpus;
+    for (int c = 0; c < CPU_SETSIZE; c++)
+        if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    if (cpus.size() < 2) return;
+
+    const bool gen_capture = topo.has("capture"), gen_process = topo.has("process");
+    const size_t n = cpus.size() - 1;
+    size_t next = 0;
+    for (auto& c : cams) {
+        if (c.capture_cpus.empty() && !gen_capture) c.capture_cpus = {cpus[1 + next++ % n]};
+        if (c.process_cpus.empty() && !gen_process) c.process_cpus = {cpus[1 + next++ % n]};
+    }
+    for (const char* role : {"output", "logger"})
+        if (!topo.has(role)) topo.set(role, ThreadPolicy{{cpus[0]}, 0});
+}
+
+struct CameraWorker {
+    CameraConfig cfg;
+    std::unique_ptr<FrameSource> src;
+    std::unique_ptr<ArucoTracker> tracker;
+    FrameBus bus;
+    std::shared_ptr<FrameSubscription> sub;
+    StateShmPublisher shm;
+    std::string capture_role = "capture", process_role = "process";
+
+    std::thread capture_thread, process_thread;
+    std::atomic<uint64_t> captured{0}, processed{0};
+    std::atomic<bool> process_done{false};
+
+    Histogram* m_proc_lat = nullptr;
+
+    void run_capture() {
+        ThreadTopology::instance().applyToCurrentThread(capture_role, "capture." + cfg.name);
+        while (g_running) {
+            cv::Mat frame;
+            uint64_t ts = 0;
+            if (!src->grab(frame, ts)) {
+                // live cameras retry; files and synthetic clips are finished
+                if (!source_uses_gstreamer(cfg.source)) break;
+                continue;
+            }
+            if (cfg.source.reuse_buffer) frame = frame.clone();
+            bus.publish(frame, ts);
+            captured.fetch_add(1, std::memory_order_relaxed);
+        }
+        bus.close();
+    }
+
+    void run_process() {
+        ThreadTopology::instance().applyToCurrentThread(process_role, "process." + cfg.name);
+        uint64_t n = 0;
+        FramePtr f;
+        while (sub->pop(f)) {
+            if (++n % static_cast<uint64_t>(std::max(1, cfg.process_every)) != 0) continue;
+            auto t0 = std::chrono::steady_clock::now();
+            tracker->process(f->image, f->ts_us);
+            m_proc_lat->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+            shm.publish(tracker->state(), f->ts_us);
+            processed.fetch_add(1, std::memory_order_relaxed);
+        }
+        process_done = true;
+    }
+};
+
+} // namespace
+
+bool load_camera_configs(const std::string& path, std::vector<CameraConfig>& out) {
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+        cv::FileNode cams = fs["cameras"];
+        if (!cams.isSeq()) {
+            std::cerr << "Cameras: " << path << " has no \"cameras\" list" << std::endl;
+            return false;
+        }
+        std::set<std::string> names;
+        for (auto it = cams.begin(); it != cams.end(); ++it) {
+            cv::FileNode n = *it;
+            CameraConfig c;
+            c.name = "cam" + std::to_string(out.size());
+            read_if(n, "name", c.name);
+            if (!valid_camera_name(c.name)) {
+                std::cerr << "Cameras: invalid camera name '" << c.name << "' (1-" << kMaxCameraName
+                          << " characters from A-Z a-z 0-9 _ -)" << std::endl;
+                return false;
+            }
+            read_if(n, "source", c.source.source);
+            read_if(n, "path", c.source.path);
+            read_if(n, "device", c.source.device);
+            read_if(n, "width", c.source.width);
+            read_if(n, "height", c.source.height);
+            read_if(n, "framerate", c.source.framerate);
+            read_if(n, "io_mode", c.source.io_mode);
+            read_if(n, "queue", c.source.queue);
+            read_if(n, "max_buffers", c.source.max_buffers);
+            int reuse = c.source.reuse_buffer ? 1 : 0;
+            read_if(n, "reuse_buffer", reuse);
+            c.source.reuse_buffer = reuse != 0;
+            int seed = static_cast<int>(out.size()) + 1; // synthetic cameras differ by default
+            read_if(n, "seed", seed);
+            c.source.seed = static_cast<uint64_t>(seed);
+            read_if(n, "frames", c.source.frames);
+            read_if(n, "params", c.params_path);
+            read_if(n, "calib", c.calib_path);
+            read_if(n, "undistort_step", c.undistort_step);
+            read_if(n, "undistort_cache", c.undistort_cache);
+            read_if(n, "ring_size", c.ring_size);
+            int drop_oldest = c.ring_drop_oldest ? 1 : 0;
+            read_if(n, "ring_drop_oldest", drop_oldest);
+            c.ring_drop_oldest = drop_oldest != 0;
+            read_if(n, "process_every", c.process_every);
+            read_cpus(n["capture_cpus"], c.capture_cpus);
+            read_cpus(n["process_cpus"], c.process_cpus);
+            read_if(n, "capture_priority", c.capture_priority);
+            read_if(n, "process_priority", c.process_priority);
+            if (!names.insert(c.name).second) {
+                std::cerr << "Cameras: duplicate camera name '" << c.name << "'" << std::endl;
+                return false;
+            }
+            out.push_back(std::move(c));
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "Cameras: failed to parse " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return !out.empty();
+}
+
+int multi_camera_main(int argc, char** argv) {
+    signal(SIGINT, on_sigint);
+
+    std::string cameras_path;
+    std::string params_path = "config/tracker_params.json";
+    bool params_explicit = false;
+    std::string calib_path;
+    int undistort_step = 0;
+    bool enable_save = true, enable_csv = true, enable_metrics = true, enable_shm = true;
+    bool udp_binary = false;
+    std::string shm_name = kDefaultShmName;
+    int shm_history = 256;
+    int metrics_port = 9101;
+    double seconds = 0; // 0 = until Ctrl-C or every source ends
+    std::string topology_path, pin_spec;
+    bool placement = true;
+    SnapshotWriter::Config snap_cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--cameras" && i+1<argc) cameras_path = argv[++i];
+        else if (a == "--params" && i+1<argc) { params_path = argv[++i]; params_explicit = true; }
+        else if (a == "--calib" && i+1<argc) calib_path = argv[++i];
+        else if (a == "--undistort") { if (undistort_step <= 0) undistort_step = 8; }
+        else if (a == "--undistort-step" && i+1<argc) undistort_step = atoi(argv[++i]);
+        else if (a == "--no-save") enable_save = false;
+        else if (a == "--no-csv") enable_csv = false;
+        else if (a == "--no-metrics") enable_metrics = false;
+        else if (a == "--udp-binary") udp_binary = true;
+        else if (a == "--no-shm") enable_shm = false;
+        else if (a == "--shm-name" && i+1<argc) shm_name = argv[++i];
+        else if (a == "--shm-history" && i+1<argc) shm_history = atoi(argv[++i]);
+        else if (a == "--metrics-port" && i+1<argc) metrics_port = atoi(argv[++i]);
+        else if (a == "--seconds" && i+1<argc) seconds = atof(argv[++i]);
+        else if (a == "--topology" && i+1<argc) topology_path = argv[++i];
+        else if (a == "--pin" && i+1<argc) pin_spec = argv[++i];
+        else if (a == "--no-auto-place") placement = false;
+        else if (a == "--snapshot-workers" && i+1<argc) snap_cfg.workers = atoi(argv[++i]);
+        else if (a == "--snapshot-queue" && i+1<argc) snap_cfg.max_queue = static_cast<size_t>(atoi(argv[++i]));
+        else if (a == "--snapshot-quality" && i+1<argc) snap_cfg.jpeg_quality = atoi(argv[++i]);
+    }
+
+    std::vector<CameraConfig> cams;
+    if (!load_camera_configs(cameras_path, cams)) {
+        std::cerr << "Failed to load --cameras " << cameras_path << std::endl;
+        return -1;
+    }
+
+    TrackerParams shared_params;
+    if (load_tracker_params(params_path, shared_params)) {
+        std::cerr << "Loaded tracker parameters from " << params_path << std::endl;
+    } else if (params_explicit) {
+        std::cerr << "Failed to load --params " << params_path << std::endl;
+        return -1;
+    }
+
+    // Placement: per-camera CPUs from the file, then --topology/--pin, then
+    // automatic spreading for whatever is still unplaced
+    auto& topo = ThreadTopology::instance();
+    if (!topology_path.empty() && !topo.load(topology_path)) {
+        std::cerr << "Failed to load --topology " << topology_path << std::endl;
+        return -1;
+    }
+    if (!pin_spec.empty() && !topo.parse(pin_spec)) {
+        std::cerr << "Invalid --pin spec: " << pin_spec << " (expected role=CPUS[:PRIO],...)" << std::endl;
+        return -1;
+    }
+    if (placement) auto_place(cams, topo);
+
+    bool need_gst = false;
+    for (const auto& c : cams) need_gst = need_gst || source_uses_gstreamer(c.source);
+    if (need_gst) gst_init(&argc, &argv);
+
+    // One shared output stage: a tagged CSV, one snapshot pool, one /metrics
+    if (enable_csv) CsvLogger::instance().init(CsvLogger::defaultOutDir(), true);
+    if (enable_save) {
+        snap_cfg.out_dir = CsvLogger::defaultOutDir();
+        SnapshotWriter::instance().init(snap_cfg);
+    }
+
+    auto& metrics = MetricsRegistry::instance();
+    std::vector<std::unique_ptr<CameraWorker>> workers;
+    for (auto& c : cams) {
+        auto w = std::make_unique<CameraWorker>();
+        w->cfg = c;
+        w->src = open_frame_source(c.source);
+        if (!w->src) {
+            std::cerr << "Camera " << c.name << ": source failed to open" << std::endl;
+            return -1;
+        }
+        TrackerParams p = shared_params;
+        if (!c.params_path.empty() && !load_tracker_params(c.params_path, p)) {
+            std::cerr << "Camera " << c.name << ": failed to load params " << c.params_path << std::endl;
+            return -1;
+        }
+        w->tracker = std::make_unique<ArucoTracker>(p, c.name);
+        const std::string& cp = c.calib_path.empty() ? calib_path : c.calib_path;
+        CameraCalibration calib;
+        if (!cp.empty() && !load_camera_calibration(cp, calib)) {
+            std::cerr << "Camera " << c.name << ": failed to load calibration " << cp << std::endl;
+            return -1;
+        }
+        if (calib.valid()) w->tracker->setCalibration(calib);
+        const int ustep = c.undistort_step >= 0 ? c.undistort_step : undistort_step;
+        if (ustep > 0 && calib.valid()) w->tracker->setUndistortion(ustep, c.undistort_cache);
+        else if (ustep > 0) std::cerr << "Camera " << c.name << ": undistortion needs a calibration" << std::endl;
+        ArucoTracker::Options opts{enable_save, enable_csv, enable_metrics};
+        opts.metrics_binary = udp_binary;
+        w->tracker->setOptions(opts);
+        w->sub = w->bus.subscribe({"tracker", static_cast<size_t>(std::max(1, c.ring_size)),
+                                   c.ring_drop_oldest ? DropPolicy::DropOldest : DropPolicy::DropNewest, 0});
+        if (enable_shm && !w->shm.open(shm_name + "_" + c.name, static_cast<uint32_t>(std::max(1, shm_history))))
+            std::cerr << "Camera " << c.name << ": shared-memory state publication disabled\n";
+
+        if (!c.capture_cpus.empty()) {
+            w->capture_role = "capture." + c.name;
+            topo.set(w->capture_role, ThreadPolicy{c.capture_cpus, c.capture_priority});
+        }
+        if (!c.process_cpus.empty()) {
+            w->process_role = "process." + c.name;
+            topo.set(w->process_role, ThreadPolicy{c.process_cpus, c.process_priority});
+        }
+
+        const std::string lb = "camera=\"" + c.name + "\"";
+        CameraWorker* wp = w.get();
+        metrics.callback("tracker_camera_frames_captured_total", "Frames captured per camera", "counter",
+                         [wp]{ return static_cast<double>(wp->captured.load(std::memory_order_relaxed)); }, lb);
+        metrics.callback("tracker_camera_frames_processed_total", "Frames tracked per camera", "counter",
+                         [wp]{ return static_cast<double>(wp->processed.load(std::memory_order_relaxed)); }, lb);
+        metrics.callback("tracker_camera_frames_dropped_total", "Frames lost to a full per-camera tracker queue", "counter",
+                         [wp]{ return static_cast<double>(wp->sub->stats().dropped); }, lb);
+        metrics.callback("tracker_camera_queue_depth", "Frames waiting in a per-camera tracker queue", "gauge",
+                         [wp]{ return static_cast<double>(wp->sub->stats().queued); }, lb);
+        w->m_proc_lat = &metrics.histogram("tracker_camera_process_seconds", "Wall time of ArucoTracker::process per camera",
+                                           latency_buckets(), lb);
+        workers.push_back(std::move(w));
+    }
+    metrics.callback("tracker_csv_dropped_total", "CSV lines dropped by the bounded logger queue", "counter",
+                     []{ return static_cast<double>(CsvLogger::instance().dropped()); });
+    if (enable_save)
+        metrics.callback("tracker_snapshot_dropped_total", "Snapshots dropped due to writer backpressure", "counter",
+                         []{ return static_cast<double>(SnapshotWriter::instance().stats().dropped); });
+
+    HttpServer http;
+    if (metrics_port > 0) {
+        http.handle("/metrics", [](const std::string&) {
+            HttpServer::Response r;
+            r.body = MetricsRegistry::instance().render();
+            return r;
+        });
+        http.start(static_cast<uint16_t>(metrics_port));
+    }
+
+    std::cout << "Running " << workers.size() << " cameras:" << std::endl;
+    for (auto& w : workers) {
+        auto cpus = [](const std::vector<int>& v) {
+            std::string s;
+            for (int c : v) s += (s.empty() ? "" : "+") + std::to_string(c);
+            return s.empty() ? std::string("-") : s;
+        };
+        std::cout << "  " << std::left << std::setw(10) << w->cfg.name << std::right << w->cfg.source.source
+                  << " " << w->cfg.source.width << "x" << w->cfg.source.height
+                  << "  capture cpus " << cpus(w->cfg.capture_cpus) << ", process cpus " << cpus(w->cfg.process_cpus)
+                  << std::endl;
+        CameraWorker* wp = w.get();
+        w->process_thread = std::thread([wp]{ wp->run_process(); });
+        w->capture_thread = std::thread([wp]{ wp->run_capture(); });
+    }
+
+    // 1 Hz per-camera report until Ctrl-C, --seconds, or every source ends
+    struct Last { uint64_t cap = 0, proc = 0, drop = 0; };
+    std::vector<Last> last(workers.size());
+    auto t_start = std::chrono::steady_clock::now();
+    auto t_report = t_start;
+    while (g_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        bool all_done = true;
+        for (auto& w : workers) all_done = all_done && w->process_done;
+        auto now = std::chrono::steady_clock::now();
+        if (seconds > 0 && std::chrono::duration<double>(now - t_start).count() >= seconds) break;
+        double dt = std::chrono::duration<double>(now - t_report).count();
+        if (dt >= 1.0 || all_done) {
+            for (size_t k = 0; k < workers.size(); k++) {
+                auto& w = *workers[k];
+                uint64_t cap = w.captured, proc = w.processed;
+                auto st = w.sub->stats();
+                std::cout << "[" << w.cfg.name << "] Processing FPS: " << std::fixed << std::setprecision(1)
+                          << (proc - last[k].proc) / dt << " | Capture FPS: " << (cap - last[k].cap) / dt
+                          << " | Dropped: " << (st.dropped - last[k].drop) << " | Queue: " << st.queued
+                          << (w.tracker->isTracking() ? " | tracking" : "") << std::endl;
+                last[k] = {cap, proc, st.dropped};
+            }
+            t_report = now;
+        }
+        if (all_done) break;
+    }
+
+    g_running = false;
+    for (auto& w : workers) {
+        w->bus.close();
+        if (w->capture_thread.joinable()) w->capture_thread.join();
+        if (w->process_thread.joinable()) w->process_thread.join();
+    }
+    topo.report(std::cout);
+    http.stop();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+    std::cout << "Cameras (" << std::fixed << std::setprecision(1) << elapsed << " s):" << std::endl;
+    for (auto& w : workers) {
+        auto st = w->sub->stats();
+        std::cout << "  " << std::left << std::setw(10) << w->cfg.name << std::right
+                  << " captured " << w->captured << ", processed " << w->processed << ", dropped " << st.dropped
+                  << ", detections " << w->tracker->detections()
+                  << ", mean FPS " << std::setprecision(1) << (elapsed > 0 ? w->processed / elapsed : 0.0) << std::endl;
+        w->src->close();
+    }
+
+    CsvLogger::instance().shutdown();
+    if (enable_save) {
+        SnapshotWriter::instance().shutdown();
+        auto ss = SnapshotWriter::instance().stats();
+        std::cout << "Snapshots: written " << ss.written << ", dropped " << ss.dropped
+                  << ", failed " << ss.failed << std::endl;
+    }
+    return 0;
+}
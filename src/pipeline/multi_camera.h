@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "source_factory.h"
+
+// One entry of a --cameras file. Each camera gets its own source, capture
+// thread, frame bus, tracker and processing thread; CSV, snapshots, UDP and
+// /metrics are shared and tagged with the camera name.
+struct CameraConfig {
+    std::string name;
+    SourceConfig source;
+    std::string params_path;        // empty = the shared --params file
+    std::string calib_path;         // empty = the shared --calib file
+    int undistort_step = -1;        // -1 = the shared --undistort-step, 0 = off
+    std::string undistort_cache;
+    int ring_size = 8;
+    bool ring_drop_oldest = true;
+    int process_every = 1;
+    // Placement of this camera's threads (roles "capture.<name>" and
+    // "process.<name>"). Empty = automatic, or the generic "capture" /
+    // "process" roles when --topology/--pin define them.
+    std::vector<int> capture_cpus;
+    std::vector<int> process_cpus;
+    int capture_priority = 0;
+    int process_priority = 0;
+};
+
+// JSON/YAML: { "cameras": [ { "name": "left", "source": "synthetic", ... } ] }
+// Missing keys keep the CameraConfig defaults; names must be unique, at most
+// 32 characters from [A-Za-z0-9_-].
+bool load_camera_configs(const std::string& path, std::vector<CameraConfig>& out);
+
+// Entry point for `jetson_motion_tracker --cameras FILE ...`.
+int multi_camera_main(int argc, char** argv);
@@ -1,4 +1,6 @@
 #include "nvargus_source.h"
+#include "gst_thread_hook.h"
+#include "../util/alloc_trace.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -24,6 +26,7 @@ bool NvArgusSource::open() {
         gst_object_unref(pipeline_); pipeline_ = nullptr; return false;
     }
 
+    gst_install_thread_hook(pipeline_);
     GstStateChangeReturn ret = gst_element_set_state(pipeline_, GST_STATE_PLAYING);
     if (ret == GST_STATE_CHANGE_FAILURE) {
         std::cerr << "GStreamer: nvargus pipeline failed to PLAY" << std::endl;
@@ -59,6 +62,7 @@ bool NvArgusSource::grab(cv::Mat& frame, uint64_t& ts_us) {
     // data is GRAY8
     gint w=width_, h=height_;
     frame = cv::Mat(h, w, CV_8UC1, (void*)map.data).clone();
+    ALLOC_TRACE_COPY(frame.total());
     gst_buffer_unmap(buffer, &map);
 
     GstClockTime pts = GST_BUFFER_PTS(buffer);
@@ -0,0 +1,40 @@
+#include "source_factory.h"
+#include "v4l2_source.h"
+#include "nvargus_source.h"
+#include "video_file_source.h"
+#include "image_sequence_source.h"
+#include "synthetic_source.h"
+
+#include <iostream>
+
+std::unique_ptr<FrameSource> open_frame_source(const SourceConfig& c) {
+    std::unique_ptr<FrameSource> src;
+    if (c.source == "camera") {
+        src = std::make_unique<V4L2CameraSource>(c.width, c.height, c.framerate, 1, c.io_mode, c.queue, c.max_buffers,
+                                                 true, false, c.reuse_buffer, c.device);
+        if (!src->open()) { std::cerr << "Camera open failed\n"; return nullptr; }
+    } else if (c.source == "csi") {
+        src = std::make_unique<NvArgusSource>(c.width, c.height, c.framerate, 1, c.max_buffers, true, false);
+        if (!src->open()) { std::cerr << "CSI camera open failed\n"; return nullptr; }
+    } else if (c.source == "video") {
+        if (c.path.empty()) { std::cerr << "--source-path required for video\n"; return nullptr; }
+        src = std::make_unique<VideoFileSource>(c.path);
+        if (!src->open()) { std::cerr << "Video file open failed\n"; return nullptr; }
+    } else if (c.source == "sequence") {
+        if (c.path.empty()) { std::cerr << "--source-path required for sequence\n"; return nullptr; }
+        src = std::make_unique<ImageSequenceSource>(c.path);
+        if (!src->open()) { std::cerr << "Image sequence open failed\n"; return nullptr; }
+    } else if (c.source == "synthetic") {
+        SyntheticSource::Config sc;
+        sc.width = c.width; sc.height = c.height; sc.fps = c.framerate;
+        sc.seed = c.seed;
+        sc.frames = c.frames;
+        sc.realtime = true;
+        src = std::make_unique<SyntheticSource>(sc);
+        if (!src->open()) { std::cerr << "Synthetic source open failed\n"; return nullptr; }
+    } else {
+        std::cerr << "Unknown --source: " << c.source << std::endl;
+        return nullptr;
+    }
+    return src;
+}
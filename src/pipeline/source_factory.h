@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "frame_source.h"
+
+// Everything needed to build and open one FrameSource, whether it comes from
+// the command line or from a camera entry in a --cameras file.
+struct SourceConfig {
+    std::string source = "camera"; // camera | csi | video | sequence | synthetic
+    std::string path;              // video file or image directory
+    std::string device = "/dev/video0";
+    int width = 640;
+    int height = 480;
+    int framerate = 120;
+    int io_mode = 0;
+    int queue = 8;
+    int max_buffers = 8;
+    bool reuse_buffer = false;     // V4L2 only
+    uint64_t seed = 1;             // synthetic only
+    int frames = 0;                // synthetic only, 0 = unbounded
+};
+
+// Build and open the configured source. Prints the reason and returns null
+// on failure.
+std::unique_ptr<FrameSource> open_frame_source(const SourceConfig& c);
+
+// True for sources that run a GStreamer pipeline (gst_init required).
+inline bool source_uses_gstreamer(const SourceConfig& c) {
+    return c.source == "camera" || c.source == "csi";
+}
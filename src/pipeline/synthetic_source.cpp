@@ -0,0 +1,83 @@
+#include "synthetic_source.h"
+#include <opencv2/aruco.hpp>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+static constexpr uint64_t kSyntheticStartUs = 1000000ULL;
+
+bool SyntheticSource::open() {
+    if (cfg_.width <= 0 || cfg_.height <= 0 || cfg_.fps <= 0 || cfg_.marker_px < 16) return false;
+
+    rng_ = cv::RNG(cfg_.seed);
+
+    // mid-grey background with low-contrast texture
+    background_.create(cfg_.height, cfg_.width, CV_8UC1);
+    rng_.fill(background_, cv::RNG::UNIFORM, 100, 156);
+    cv::GaussianBlur(background_, background_, cv::Size(0, 0), 3.0);
+
+    // marker plus a white quiet zone of a quarter marker on each side
+    cv::Mat marker;
+    auto dict = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    cv::aruco::drawMarker(dict, cfg_.marker_id, cfg_.marker_px, marker, 1);
+    int pad = cfg_.marker_px / 4;
+    cv::copyMakeBorder(marker, patch_, pad, pad, pad, pad, cv::BORDER_CONSTANT, cv::Scalar(255));
+
+    index_ = 0;
+    opened_ = true;
+    t0_ticks_ = cv::getTickCount();
+    return true;
+}
+
+SyntheticSource::Truth SyntheticSource::truthAt(double t) const {
+    const double w1 = 2.0 * CV_PI * cfg_.sweep_hz;
+    const double w2 = 2.0 * CV_PI * cfg_.vib_hz;
+    Truth tr;
+    tr.center.x = static_cast<float>(cfg_.width * 0.5 + cfg_.sweep_px_x * std::sin(w1 * t) + cfg_.vib_px * std::sin(w2 * t));
+    tr.center.y = static_cast<float>(cfg_.height * 0.5 + cfg_.sweep_px_y * std::sin(w1 * t + 0.7));
+    tr.vel.x = static_cast<float>(cfg_.sweep_px_x * w1 * std::cos(w1 * t) + cfg_.vib_px * w2 * std::cos(w2 * t));
+    tr.vel.y = static_cast<float>(cfg_.sweep_px_y * w1 * std::cos(w1 * t + 0.7));
+
+    const float d = cfg_.marker_px * 0.25f;
+    static const int sx[4] = {-1, 1, -1, 1};
+    static const int sy[4] = {-1, -1, 1, 1};
+    for (int i = 0; i < 4; i++)
+        tr.quadrant[i] = cv::Point2f(tr.center.x + sx[i] * d, tr.center.y + sy[i] * d);
+    return tr;
+}
+
+bool SyntheticSource::grab(cv::Mat& frame, uint64_t& ts_us) {
+    if (!opened_) return false;
+    if (cfg_.frames > 0 && index_ >= cfg_.frames) return false;
+
+    const double t = index_ / cfg_.fps;
+    if (cfg_.realtime) {
+        double elapsed = (cv::getTickCount() - t0_ticks_) / cv::getTickFrequency();
+        if (t > elapsed) std::this_thread::sleep_for(std::chrono::duration<double>(t - elapsed));
+    }
+
+    truth_ = truthAt(t);
+
+    // map patch pixel centres so the marker centre lands on truth_.center
+    const double c = (patch_.cols - 1) * 0.5;
+    cv::Matx23d M(1, 0, truth_.center.x - c,
+                  0, 1, truth_.center.y - c);
+    frame = background_.clone();
+    cv::warpAffine(patch_, frame, M, frame.size(), cv::INTER_LINEAR, cv::BORDER_TRANSPARENT);
+
+    if (cfg_.noise_sigma > 0) {
+        noise_.create(frame.size(), CV_16SC1);
+        rng_.fill(noise_, cv::RNG::NORMAL, 0, cfg_.noise_sigma);
+        cv::add(frame, noise_, frame, cv::noArray(), CV_8U);
+    }
+
+    ts_us = kSyntheticStartUs + static_cast<uint64_t>(std::llround(t * 1e6));
+    index_++;
+    return true;
+}
+
+void SyntheticSource::close() {
+    opened_ = false;
+    background_.release();
+    patch_.release();
+}
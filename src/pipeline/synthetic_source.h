@@ -0,0 +1,58 @@
+#pragma once
+#include "frame_source.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+// Renders an ArUco marker (DICT_4X4_50) moving along a known trajectory:
+// a slow sweep plus a small high-frequency vibration. Timestamps advance
+// by exactly 1/fps, and the ground truth of the last frame is available
+// from truth(), so tuners and benchmarks can score tracking error.
+class SyntheticSource : public FrameSource {
+public:
+    struct Config {
+        int width = 640;
+        int height = 480;
+        double fps = 120.0;
+        int frames = 0;            // 0 = unbounded
+        int marker_id = 0;
+        int marker_px = 120;       // marker side incl. black border
+        double sweep_px_x = 40.0;  // slow sweep amplitude
+        double sweep_px_y = 20.0;
+        double sweep_hz = 0.5;
+        double vib_px = 3.0;       // vibration amplitude
+        double vib_hz = 12.0;
+        double noise_sigma = 2.0;  // additive gaussian noise (grey levels)
+        bool realtime = false;     // pace grab() to fps
+        uint64_t seed = 1;
+    };
+
+    struct Truth {
+        cv::Point2f center;
+        cv::Point2f vel;           // px/s
+        cv::Point2f quadrant[4];   // same order as TrackerState::q
+    };
+
+    SyntheticSource() : SyntheticSource(Config()) {}
+    explicit SyntheticSource(const Config& cfg) : cfg_(cfg) {}
+
+    bool open() override;
+    bool grab(cv::Mat& frame, uint64_t& ts_us) override;
+    void close() override;
+
+    const Truth& truth() const { return truth_; }
+    const Config& config() const { return cfg_; }
+
+    // Ground truth at an arbitrary time (seconds since the first frame).
+    Truth truthAt(double t) const;
+
+private:
+    Config cfg_;
+    cv::Mat background_;
+    cv::Mat patch_;            // marker with white quiet zone
+    cv::Mat noise_;
+    cv::RNG rng_;
+    int index_ = 0;
+    Truth truth_;
+    bool opened_ = false;
+    int64_t t0_ticks_ = 0;
+};
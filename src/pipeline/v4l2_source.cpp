@@ -1,4 +1,6 @@
 #include "v4l2_source.h"
+#include "gst_thread_hook.h"
+#include "../util/alloc_trace.h"
 
 #include <opencv2/opencv.hpp>
 #include <string>
@@ -22,6 +24,7 @@ static bool gst_start_pipeline(GstElement*& pipeline, GstElement*& sink, const s
         gst_object_unref(pipeline); pipeline = nullptr;
         return false;
     }
+    gst_install_thread_hook(pipeline);
     GstStateChangeReturn ret = gst_element_set_state(pipeline, GST_STATE_PLAYING);
     if (ret == GST_STATE_CHANGE_FAILURE) {
         std::cerr << "GStreamer: failed to set pipeline PLAYING" << std::endl;
@@ -111,10 +114,12 @@ bool V4L2CameraSource::grab(cv::Mat& frame, uint64_t& ts_us) {
     if (reuse_buffer_) {
         // copy into persistent scratch buffer (avoid repeated allocations)
         memcpy(scratch_.data, map.data, sz);
+        ALLOC_TRACE_COPY(sz);
         frame = scratch_; // header copy only; scratch_ will be overwritten next frame
     } else {
         // safe clone for independent lifetime
         frame = cv::Mat(height_, width_, CV_8UC1, (void*)map.data).clone();
+        ALLOC_TRACE_COPY(sz);
     }
 
     gst_buffer_unmap(buffer, &map);
@@ -1,152 +1,386 @@
 #include "aruco_tracker.h"
 #include "motion_update.h"
-#include "frame_writer.h"
+#include "../io/writer.h"
 #include "../network/udp_sender.h"
 #include "../util/csv_logger.h"
+#include "../util/state_schema.h"
+#include "../util/alloc_trace.h"
+#include "../pipeline/synthetic_source.h"
 
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
 
 using namespace cv;
 
-ArucoTracker::ArucoTracker() {
+ArucoTracker::ArucoTracker(const TrackerParams& params, const std::string& camera)
+    : camera_(camera), out_buf_(state_schema::kMaxText) {
     dict_ = aruco::getPredefinedDictionary(aruco::DICT_4X4_50);
     lk_ = cuda::SparsePyrLKOpticalFlow::create();
-    // Tune LK for speed: fewer pyramid levels and smaller window
-    lk_->setMaxLevel(2);            // default 3
-    lk_->setWinSize({15,15});       // default 21x21
-    lk_->setNumIters(10);           // keep iterations moderate
+    setParams(params);
+
+    auto& reg = MetricsRegistry::instance();
+    const std::string lb = camera_.empty() ? std::string() : "camera=\"" + camera_ + "\"";
+    m_detect_calls_ = &reg.counter("tracker_detect_calls_total", "Marker detection passes run", lb);
+    m_detect_found_ = &reg.counter("tracker_detect_found_total", "Detection passes that found a marker", lb);
+    m_lk_points_ = &reg.counter("tracker_lk_points_total", "Points submitted to LK optical flow", lb);
+    m_lk_failures_ = &reg.counter("tracker_lk_failures_total", "LK points returned with status=0", lb);
+    m_redetect_forced_ = &reg.counter("tracker_redetect_forced_total", "Re-detections triggered by a quadrant losing all its points", lb);
+    m_homog_aligns_ = &reg.counter("tracker_homography_aligns_total", "Homography (ECC) alignments attempted", lb);
+    m_homog_failures_ = &reg.counter("tracker_homography_failures_total", "Alignments that failed or fell below homog_min_cc", lb);
+    m_gate_checked_ = &reg.counter("tracker_gate_checked_total", "Frames checked by the motion gate", lb);
+    m_gate_skipped_ = &reg.counter("tracker_gate_skipped_total", "Frames the motion gate found unchanged", lb);
+    m_gate_saved_ = &reg.gauge("tracker_gate_cpu_saved_seconds", "Estimated processing time avoided by the motion gate", lb);
 }
 
-void ArucoTracker::process(const Mat& frame, uint64_t ts_us) {
-    d_curr_.upload(frame);
-    frame_count_++;
+void ArucoTracker::setCalibration(const CameraCalibration& c) {
+    calib_ = c;
+    lut_.release();
+    // with undistorted input points the pose solve must not undistort again
+    CameraCalibration pc = c;
+    if (undistort_step_ > 0) pc.dist.release();
+    pose_.setCalibration(pc);
+}
 
-    if (!state_.tracking || frame_count_ % 20 == 0)
-        detect_marker(frame);
+void ArucoTracker::setUndistortion(int step, const std::string& cache) {
+    undistort_step_ = std::max(0, step);
+    undistort_cache_ = cache;
+    setCalibration(calib_);
+}
 
-    if (state_.tracking && have_prev_)
-        track(frame, ts_us);
+void ArucoTracker::prepare_lut(const Size& size) {
+    if (undistort_step_ <= 0 || !calib_.valid() || (lut_.ready() && lut_.frameSize() == size)) return;
+    if (!lut_.prepare(calib_, size, undistort_step_, undistort_cache_)) {
+        // unusable calibration: report raw coordinates, and give the pose
+        // solve its distortion model back
+        undistort_step_ = 0;
+        setCalibration(calib_);
+    }
+}
 
-    // Append CSV metrics for each processed frame (asynchronous logger)
-    if (options_.enable_csv) {
-        CsvLogger::instance().log(ts_us, state_);
-    }
-
-    // Optionally save frame + metrics once per second
-    if (options_.enable_save && state_.tracking && ts_us - state_.last_saved_us > 1000000ULL) {
-        // build JSON metrics with per-quadrant "valid" flag and safer values
-        std::ostringstream os;
-        os << std::fixed << std::setprecision(2);
-        os << "{\"marker_id\":" << state_.marker_id << ",\"ts_us\":" << ts_us << ",\"quadrants\":[";
-        for (int i=0;i<4;i++) {
-            auto& q = state_.q[i];
-            if (i) os << ",";
-            if (!q.valid) {
-                os << "{\"valid\":false,\"cx\":null,\"cy\":null,\"vx\":null,\"vy\":null,\"ax\":null,\"ay\":null}";
-            } else {
-                auto& m = q.motion;
-                os << "{\"valid\":true,\"cx\":" << m.pos.x << ",\"cy\":" << m.pos.y
-                   << ",\"vx\":" << m.vel.x << ",\"vy\":" << m.vel.y
-                   << ",\"ax\":" << m.acc.x << ",\"ay\":" << m.acc.y << "}";
+void ArucoTracker::setParams(const TrackerParams& p) {
+    // Filters, template, pose, gate references, quality baselines and the
+    // spectrum window restart only when their own parameters change, so a
+    // live LK or cadence change (control socket) leaves them alone.
+    const bool mode_changed = p.track_mode != params_.track_mode || p.lk_backend != params_.lk_backend;
+    const bool kalman_changed = !configured_ || mode_changed || p.kalman.enabled != params_.kalman.enabled
+        || p.kalman.jerk_psd != params_.kalman.jerk_psd || p.kalman.meas_sigma != params_.kalman.meas_sigma
+        || p.kalman.max_gap_s != params_.kalman.max_gap_s;
+    const bool pose_changed = !configured_ || p.pose.enabled != params_.pose.enabled || p.pose.marker_mm != params_.pose.marker_mm;
+    const bool homog_changed = !configured_ || mode_changed || p.homog.template_px != params_.homog.template_px
+        || p.homog.levels != params_.homog.levels;
+    const MotionGateParams& g = p.gate;
+    const bool gate_changed = !configured_ || g.enabled != params_.gate.enabled || g.threshold != params_.gate.threshold
+        || g.decimation != params_.gate.decimation || g.margin_px != params_.gate.margin_px
+        || g.max_skip != params_.gate.max_skip;
+    const QualityGateParams& qg = p.quality;
+    const bool quality_changed = !configured_ || qg.enabled != params_.quality.enabled
+        || qg.decimation != params_.quality.decimation || qg.margin_px != params_.quality.margin_px
+        || qg.blur_ratio != params_.quality.blur_ratio || qg.min_sharpness != params_.quality.min_sharpness
+        || qg.max_clipped != params_.quality.max_clipped || qg.dark_level != params_.quality.dark_level
+        || qg.sat_level != params_.quality.sat_level || qg.max_skip != params_.quality.max_skip;
+    const SpectrumParams& sp = p.spectrum;
+    const bool spectrum_changed = !configured_ || sp.enabled != params_.spectrum.enabled
+        || sp.window != params_.spectrum.window || sp.sample_hz != params_.spectrum.sample_hz
+        || sp.min_hz != params_.spectrum.min_hz || sp.max_hz != params_.spectrum.max_hz
+        || sp.update_hz != params_.spectrum.update_hz || sp.max_gap_s != params_.spectrum.max_gap_s;
+    configured_ = true;
+    if (mode_changed) state_.tracking = false; // start the new mode (or LK backend) from a detection
+    params_ = p;
+    // Defaults favour speed: 2 pyramid levels (OpenCV default 3), 15x15 window (default 21x21)
+    lk_->setMaxLevel(params_.lk_max_level);
+    lk_->setWinSize({params_.lk_win_size, params_.lk_win_size});
+    lk_->setNumIters(params_.lk_iters);
+    // With the Kalman filter on, LK starts from the predicted position
+    lk_->setUseInitialFlow(params_.kalman.enabled);
+    if (kalman_changed) {
+        for (auto& k : kf_) k.reset();
+        for (auto& k : held_kf_) k.reset();
+    }
+    if (gate_changed) gate_.setParams(params_.gate);
+    if (quality_changed) quality_.setParams(params_.quality);
+    track_conf_ = 1.0f;
+    if (homog_changed) aligner_.reset();
+    if (pose_changed) {
+        pose_.reset(); // marker points are re-derived (with the new size) at the next detection
+        state_.pose = PoseState();
+    }
+    if (spectrum_changed) spectrum_.configure(params_.spectrum);
+    if (params_.spectrum.enabled && !m_vib_freq_[0][0]) {
+        auto& reg = MetricsRegistry::instance();
+        for (int q = 0; q < 4; q++)
+            for (int a = 0; a < 2; a++) {
+                std::string lb = "quadrant=\"" + std::to_string(q) + "\",axis=\"" + (a ? "y" : "x") + "\"";
+                if (!camera_.empty()) lb = "camera=\"" + camera_ + "\"," + lb;
+                m_vib_freq_[q][a] = &reg.gauge("tracker_vibration_frequency_hz", "Dominant vibration frequency", lb);
+                m_vib_amp_[q][a] = &reg.gauge("tracker_vibration_amplitude_px", "Amplitude of the dominant vibration", lb);
+                m_vib_rms_[q][a] = &reg.gauge("tracker_vibration_rms_px", "RMS displacement over the spectrum window", lb);
             }
+    }
+    if (params_.pose.enabled && !m_pose_warm_) {
+        auto& reg = MetricsRegistry::instance();
+        const std::string cam = camera_.empty() ? std::string() : "camera=\"" + camera_ + "\"";
+        const std::string sep = cam.empty() ? "" : ",";
+        m_pose_warm_ = &reg.counter("tracker_pose_solves_total", "Pose solves by kind", cam + sep + "kind=\"warm\"");
+        m_pose_cold_ = &reg.counter("tracker_pose_solves_total", "Pose solves by kind", cam + sep + "kind=\"cold\"");
+        m_pose_failed_ = &reg.counter("tracker_pose_failures_total", "Pose solves rejected (behind camera or non-finite)", cam);
+        m_pose_lat_ = &reg.histogram("tracker_pose_seconds", "Wall time of the pose stage",
+                                     {10e-6, 20e-6, 50e-6, 100e-6, 200e-6, 500e-6, 1e-3, 2e-3, 5e-3}, cam);
+        m_pose_reproj_ = &reg.gauge("tracker_pose_reprojection_px", "RMS reprojection error of the last pose", cam);
+        for (int a = 0; a < 3; a++) {
+            std::string lb = cam + sep + "axis=\"" + "xyz"[a] + "\"";
+            m_pose_t_[a] = &reg.gauge("tracker_pose_translation_mm", "Marker centre in camera coordinates", lb);
+            m_pose_v_[a] = &reg.gauge("tracker_pose_velocity_mm_s", "Marker centre velocity in camera coordinates", lb);
         }
-        os << "]}";
-        std::string json = os.str();
+    }
+    if (params_.redetect.adaptive && !m_track_conf_) {
+        auto& reg = MetricsRegistry::instance();
+        const std::string lb = camera_.empty() ? std::string() : "camera=\"" + camera_ + "\"";
+        m_redetect_low_conf_ = &reg.counter("tracker_redetect_low_confidence_total", "Re-detections triggered by low track confidence", lb);
+        m_fb_rejected_ = &reg.counter("tracker_lk_fb_rejected_total", "LK points dropped by the forward-backward check", lb);
+        m_track_conf_ = &reg.gauge("tracker_track_confidence", "Weakest quadrant's confidence in the last LK pass", lb);
+    }
+    if (params_.quality.enabled && !m_quality_lat_) {
+        auto& reg = MetricsRegistry::instance();
+        const std::string cam = camera_.empty() ? std::string() : "camera=\"" + camera_ + "\"";
+        const std::string sep = cam.empty() ? "" : ",";
+        m_quality_rejected_[0] = &reg.counter("tracker_quality_rejected_total", "Frames skipped by the quality gate", cam + sep + "reason=\"blur\"");
+        m_quality_rejected_[1] = &reg.counter("tracker_quality_rejected_total", "Frames skipped by the quality gate", cam + sep + "reason=\"exposure\"");
+        m_quality_detect_skipped_ = &reg.counter("tracker_quality_detections_skipped_total", "Detection passes avoided on rejected frames", cam);
+        m_quality_sharpness_ = &reg.gauge("tracker_quality_sharpness", "Laplacian variance of the last checked ROI", cam);
+        m_quality_clipped_ = &reg.gauge("tracker_quality_clipped_ratio", "Crushed or saturated fraction of the last checked ROI", cam);
+        m_quality_lat_ = &reg.histogram("tracker_quality_seconds", "Wall time of the quality estimate",
+                                        {5e-6, 10e-6, 20e-6, 50e-6, 100e-6, 200e-6, 500e-6, 1e-3}, cam);
+    }
+    if (params_.tiles.enabled && !m_tile_merged_) {
+        const std::string lb = camera_.empty() ? std::string() : "camera=\"" + camera_ + "\"";
+        m_tile_merged_ = &MetricsRegistry::instance().counter(
+            "tracker_detect_tile_duplicates_total", "Detections found by more than one tile and merged", lb);
+    }
+}
 
-        // Save frame and metrics (background work)
-        save_frame_and_metrics(frame, json, ts_us);
+void ArucoTracker::process(const Mat& frame, uint64_t ts_us, PyramidPtr pyr) {
+    using clock = std::chrono::steady_clock;
 
-        state_.last_saved_us = ts_us;
+    // Motion gate: a static scene skips upload, detection and LK entirely
+    bool skipped = false;
+    if (params_.gate.enabled && have_prev_) {
+        ALLOC_STAGE("gate");
+        auto tg0 = clock::now();
+        skipped = gate_.unchanged(frame, state_.tracking ? state_.marker_bbox : Rect());
+        double gate_s = std::chrono::duration<double>(clock::now() - tg0).count();
+        gate_stats_.checked++;
+        m_gate_checked_->inc();
+        if (skipped) {
+            double saved = std::max(0.0, full_cost_ema_s_ - gate_s);
+            gate_stats_.skipped++;
+            gate_stats_.saved_s += saved;
+            m_gate_skipped_->inc();
+            m_gate_saved_->add(saved);
+        }
     }
 
-    // Send UDP metrics at 10Hz independently of saving
-    const uint64_t METRIC_PERIOD_US = 100000ULL; // 100ms
-    if (options_.enable_metrics && state_.tracking && ts_us - state_.last_metrics_us > METRIC_PERIOD_US) {
-        // Reuse latest JSON; if none, build a compact one
-        std::ostringstream os;
-        os << std::fixed << std::setprecision(2);
-        os << "{\"marker_id\":" << state_.marker_id << ",\"ts_us\":" << ts_us << ",\"quadrants\":[";
-        for (int i=0;i<4;i++) {
-            auto& q = state_.q[i];
-            if (i) os << ",";
-            if (!q.valid) {
-                os << "{\"valid\":false,\"vx\":null,\"vy\":null,\"ax\":null,\"ay\":null}";
-            } else {
-                auto& m = q.motion;
-                os << "{\"valid\":true,\"vx\":" << m.vel.x << ",\"vy\":" << m.vel.y
-                   << ",\"ax\":" << m.acc.x << ",\"ay\":" << m.acc.y << "}";
+    // Quality gate: a blurred or badly exposed frame would only make detection
+    // and LK fail, so it skips both and the motion prediction is carried
+    bool rejected = false;
+    state_.quality = FrameQuality();
+    if (params_.quality.enabled && !skipped) {
+        ALLOC_STAGE("quality");
+        auto tq0 = clock::now();
+        rejected = !quality_.check(frame, state_.tracking ? state_.marker_bbox : Rect(), state_.quality);
+        m_quality_lat_->observe(std::chrono::duration<double>(clock::now() - tq0).count());
+        if (state_.quality.checked) {
+            m_quality_sharpness_->set(state_.quality.sharpness);
+            m_quality_clipped_->set(state_.quality.clipped);
+        }
+        if (rejected) {
+            quality_stats_.rejected++;
+            m_quality_rejected_[state_.quality.clipped > params_.quality.max_clipped ? 1 : 0]->inc();
+            if (detection_due()) {
+                quality_stats_.detections_skipped++;
+                m_quality_detect_skipped_->inc();
             }
         }
-        os << "]}";
-        send_metrics_udp(os.str());
-        state_.last_metrics_us = ts_us;
     }
 
-    // Write a low-rate live jpg snapshot for MJPEG streaming (default 10 FPS)
-    const uint64_t LIVE_PERIOD_US = 100000ULL; // 100ms -> 10FPS
-    if (options_.enable_live && ts_us - state_.last_live_us > LIVE_PERIOD_US) {
-        try {
-            Mat vis;
-            if (frame.channels() == 1) cvtColor(frame, vis, COLOR_GRAY2BGR);
-            else vis = frame.clone();
-
-            // draw bbox, marker id, quadrant markers, and velocities
-            if (state_.tracking) {
-                rectangle(vis, state_.marker_bbox, Scalar(0,255,0), 2);
-                std::string idtxt = "ID: " + std::to_string(state_.marker_id);
-                putText(vis, idtxt, {state_.marker_bbox.x, std::max(0, state_.marker_bbox.y-6)}, FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0,255,0), 1);
-
-                for (int i=0;i<4;i++) {
-                    if (state_.q[i].valid) {
-                        auto p = state_.q[i].motion.pos;
-                        int ix = cv::saturate_cast<int>(p.x);
-                        int iy = cv::saturate_cast<int>(p.y);
-                        circle(vis, Point(ix, iy), 4, Scalar(0,0,255), -1);
-
-                        // velocity arrow and text
-                        float vx = state_.q[i].motion.vel.x;
-                        float vy = state_.q[i].motion.vel.y;
-                        float scale = 0.05f;
-                        Point dst(cv::saturate_cast<int>(ix + vx*scale), cv::saturate_cast<int>(iy + vy*scale));
-                        arrowedLine(vis, Point(ix,iy), dst, Scalar(255,0,0), 1, LINE_AA, 0, 0.3);
-                        std::ostringstream os; os << std::fixed << std::setprecision(1) << "v=" << vx << "," << vy;
-                        putText(vis, os.str(), {ix+6, iy-6}, FONT_HERSHEY_SIMPLEX, 0.4, Scalar(255,255,255), 1);
-                    } else {
-                        cv::Point2f c;
-                        c.x = state_.marker_bbox.x + state_.marker_bbox.width * (i%2 ? 0.75f : 0.25f);
-                        c.y = state_.marker_bbox.y + state_.marker_bbox.height * (i<2 ? 0.25f : 0.75f);
-                        int ix = cv::saturate_cast<int>(c.x), iy = cv::saturate_cast<int>(c.y);
-                        cv::line(vis, {ix-3,iy-3},{ix+3,iy+3}, cv::Scalar(0,128,255), 1);
-                        cv::line(vis, {ix+3,iy-3},{ix-3,iy+3}, cv::Scalar(0,128,255), 1);
-                    }
+    prepare_lut(frame.size());
+    const int detections_before = detections_;
+    if (skipped && !coasting_) {
+        hold_state(ts_us);
+    } else if (skipped || rejected) {
+        coast_state(ts_us);
+    } else {
+        if (holding_) {
+            // LK measures from the last full pass, so the filters continue from there
+            for (int i = 0; i < 4; i++) {
+                state_.q[i].motion = held_[i];
+                kf_[i] = held_kf_[i];
+            }
+            holding_ = coasting_ = false;
+        }
+        auto tp0 = clock::now();
+        frame_count_++;
+        since_detect_++;
+        if (params_.track_mode == TrackMode::Homography) {
+            ALLOC_STAGE("homography");
+            track_homography(frame, ts_us);
+        } else {
+            ALLOC_STAGE("lk");
+            if (params_.lk_backend == LkBackend::Cpu) {
+                // prebuilt by the pyramid pipeline; inline when missing or built for other LK geometry
+                const Size win(params_.lk_win_size, params_.lk_win_size);
+                if (pyr && pyr->matches(win, params_.lk_max_level)) {
+                    curr_pyr_ = std::move(pyr);
+                } else {
+                    curr_pyr_ = pyr_pool_.acquire();
+                    build_lk_pyramid(frame, *curr_pyr_, win, params_.lk_max_level);
                 }
+            } else {
+                d_curr_.upload(frame);
             }
 
-            std::vector<int> jpg_params = {cv::IMWRITE_JPEG_QUALITY, 75};
-            std::vector<uchar> enc;
-            cv::imencode(".jpg", vis, enc, jpg_params);
-            // write to /tmp/live.jpg without re-encoding
-            {
-                std::ofstream f("/tmp/live.jpg", std::ios::binary);
-                if (f.good()) f.write(reinterpret_cast<const char*>(enc.data()), static_cast<std::streamsize>(enc.size()));
+            if (redetect_due(false)) {
+                ALLOC_STAGE("detect");
+                if (need_redetect_) m_redetect_forced_->inc();
+                else if (params_.redetect.adaptive && state_.tracking && track_conf_ < params_.redetect.min_confidence)
+                    m_redetect_low_conf_->inc();
+                detect_marker(frame);
             }
-            // also send via UDP for Flask receiver
-            send_jpeg_udp(enc, "127.0.0.1", 5002);
-            state_.last_live_us = ts_us;
-        } catch (const std::exception& e) {
-            std::cerr << "Live snapshot write failed: " << e.what() << std::endl;
+
+            if (state_.tracking && have_prev_)
+                track(frame, ts_us);
+        }
+
+        if (params_.gate.enabled) {
+            gate_.setReference(frame, state_.tracking ? state_.marker_bbox : Rect());
+            double cost = std::chrono::duration<double>(clock::now() - tp0).count();
+            full_cost_ema_s_ = full_cost_ema_s_ > 0 ? 0.9 * full_cost_ema_s_ + 0.1 * cost : cost;
+        }
+    }
+
+    // Metric pose from the quadrant points; an LK detection frame solves at
+    // the fresh anchors (the quadrant states still hold the previous frame)
+    if (params_.pose.enabled) {
+        ALLOC_STAGE("pose");
+        update_pose(frame, ts_us, params_.track_mode == TrackMode::LK && detections_ != detections_before);
+    }
+
+    // Streaming spectrum: resampled onto a uniform grid, O(bins) per sample
+    if (params_.spectrum.enabled) {
+        ALLOC_STAGE("spectrum");
+        if (spectrum_.push(state_, ts_us)) publish_spectrum();
+    }
+
+    // Append CSV metrics for each processed frame (asynchronous logger)
+    if (options_.enable_csv) {
+        ALLOC_STAGE("csv");
+        CsvLogger::instance().log(ts_us, state_, camera_);
+    }
+
+    // Optionally save frame + metrics once per second (options_.save_period_us)
+    if (options_.enable_save && state_.tracking && ts_us - state_.last_saved_us > options_.save_period_us) {
+        ALLOC_STAGE("snapshot");
+        const size_t n = state_schema::write_json(out_buf_.data(), out_buf_.size(), {state_, ts_us},
+                                                  state_schema::kSnapshot, camera_);
+
+        // Hand off to the snapshot writer pool; drops instead of blocking when backlogged
+        if (n) SnapshotWriter::instance().submit(frame, std::string_view(out_buf_.data(), n), ts_us, camera_);
+
+        state_.last_saved_us = ts_us;
+    }
+
+    // Send UDP metrics at 10Hz (options_.metrics_period_us) independently of saving
+    if (options_.enable_metrics && state_.tracking && ts_us - state_.last_metrics_us > options_.metrics_period_us) {
+        ALLOC_STAGE("udp");
+        const state_schema::Record rec{state_, ts_us};
+        const size_t n = options_.metrics_binary
+            ? state_schema::write_binary(out_buf_.data(), out_buf_.size(), rec, camera_)
+            : state_schema::write_json(out_buf_.data(), out_buf_.size(), rec, state_schema::kUdp, camera_);
+        if (n) send_metrics_udp(out_buf_.data(), n);
+        state_.last_metrics_us = ts_us;
+    }
+
+    if (!skipped) {
+        d_prev_ = d_curr_;
+        prev_pyr_ = curr_pyr_;
+        have_prev_ = true;
+    }
+}
+
+void ArucoTracker::warmUp(const Size& size) {
+    prepare_lut(size);
+    SyntheticSource::Config sc;
+    sc.width = size.width;
+    sc.height = size.height;
+    sc.marker_px = std::min(sc.marker_px, std::min(size.width, size.height) / 2);
+    sc.frames = 2;
+    SyntheticSource src(sc);
+    Mat f[2];
+    uint64_t ts = 0;
+    if (!src.open() || !src.grab(f[0], ts) || !src.grab(f[1], ts)) return;
+
+    std::vector<int> ids;
+    std::vector<std::vector<Point2f>> corners;
+    if (params_.tiles.enabled)
+        tiled_.detect(f[0], dict_, params_.tiles, corners, ids); // also starts the pool threads
+    else
+        aruco::detectMarkers(f[0], dict_, corners, ids);
+
+    std::vector<Point2f> pts;
+    goodFeaturesToTrack(f[0], pts, 16, params_.feature_quality, 3);
+    if (pts.empty()) pts.push_back(Point2f(size.width * 0.5f, size.height * 0.5f));
+
+    Mat h_pts(1, static_cast<int>(pts.size()), CV_32FC2, pts.data());
+    Mat h_out;
+    if (params_.lk_backend == LkBackend::Cpu) {
+        // pool buffers and LK scratch at the real frame size
+        const Size win(params_.lk_win_size, params_.lk_win_size);
+        PyramidPtr p0 = pyr_pool_.acquire(), p1 = pyr_pool_.acquire();
+        build_lk_pyramid(f[0], *p0, win, params_.lk_max_level);
+        build_lk_pyramid(f[1], *p1, win, params_.lk_max_level);
+        Mat status, err;
+        calcOpticalFlowPyrLK(p0->levels, p1->levels, h_pts, h_out, status, err, win, params_.lk_max_level);
+    } else {
+        // CUDA context, LK kernels and pyramid buffers at the real frame size;
+        // the members keep their device allocations for the first real frames
+        d_prev_.upload(f[0]);
+        d_curr_.upload(f[1]);
+        d_prev_pts_.upload(h_pts);
+        d_curr_pts_.upload(h_pts); // initial flow when the Kalman seed is on
+        lk_->calc(d_prev_, d_curr_, d_prev_pts_, d_curr_pts_, d_status_);
+        if (params_.redetect.adaptive) {
+            // error output and the backward pass of the confidence check
+            lk_->calc(d_prev_, d_curr_, d_prev_pts_, d_curr_pts_, d_status_, d_err_);
+            d_prev_pts_.copyTo(d_back_pts_);
+            lk_->calc(d_curr_, d_prev_, d_curr_pts_, d_back_pts_, d_back_status_);
         }
+        d_curr_pts_.download(h_out);
     }
 
-    d_prev_ = d_curr_;
-    have_prev_ = true;
+    if (params_.track_mode == TrackMode::Homography && !ids.empty()) {
+        aligner_.init(f[0], corners[0], params_.homog);
+        aligner_.align(f[1], params_.homog);
+        aligner_.reset();
+    }
+    have_prev_ = false;
 }
 
 void ArucoTracker::detect_marker(const Mat& frame) {
     std::vector<int> ids;
     std::vector<std::vector<Point2f>> corners;
-    aruco::detectMarkers(frame, dict_, corners, ids);
+    if (params_.tiles.enabled) {
+        // duplicates from overlapping tiles are merged here, before bbox and seeds
+        const uint64_t merged = tiled_.stats().merged;
+        tiled_.detect(frame, dict_, params_.tiles, corners, ids);
+        m_tile_merged_->inc(tiled_.stats().merged - merged);
+    } else {
+        aruco::detectMarkers(frame, dict_, corners, ids);
+    }
+    m_detect_calls_->inc();
+    detections_++;
+    since_detect_ = 0;
+    track_conf_ = 1.0f;
 
     if (ids.empty()) {
         state_.tracking = false;
@@ -154,34 +388,352 @@ void ArucoTracker::detect_marker(const Mat& frame) {
         return;
     }
 
+    m_detect_found_->inc();
+    if (!state_.tracking)
+        for (auto& k : kf_) k.reset(); // reacquired: old motion no longer applies
     state_.marker_bbox = boundingRect(corners[0]);
     state_.tracking = true;
     state_.marker_id = ids[0];
+    need_redetect_ = false;
 
-    Mat pts(1, 4, CV_32FC2);
-    for (int i = 0; i < 4; i++)
-        pts.at<Point2f>(0, i) = quadrant_center(i);
+    const Point2f c[4] = {undistorted(corners[0][0]), undistorted(corners[0][1]),
+                          undistorted(corners[0][2]), undistorted(corners[0][3])};
+    if (params_.track_mode == TrackMode::Homography) {
+        if (aligner_.init(frame, corners[0], params_.homog) && params_.pose.enabled) {
+            Point2f qc[4];
+            for (int q = 0; q < 4; q++) qc[q] = undistorted(aligner_.quadrantCenter(q));
+            pose_.setMarker(c, qc, params_.pose.marker_mm);
+        }
+        return;
+    }
 
-    d_prev_pts_.upload(pts);
+    select_points(frame, corners[0]);
+    if (params_.pose.enabled) {
+        Point2f qa[4];
+        for (int q = 0; q < 4; q++) qa[q] = undistorted(anchor_[q]);
+        pose_.setMarker(c, qa, params_.pose.marker_mm);
+    }
+    if (params_.lk_backend == LkBackend::Cuda) d_prev_pts_.upload(h_prev_pts_);
     have_prev_ = false;
 }
 
+// Up to K Shi-Tomasi corners per quadrant, restricted to the marker polygon
+// (the black/white cell corners are the best-conditioned LK features). Each
+// quadrant keeps its geometric centre as anchor and is later reported as
+// anchor + median displacement of its points, so a quadrant with K=1 and no
+// texture falls back to exactly the old single centre point.
+void ArucoTracker::select_points(const Mat& frame, const std::vector<Point2f>& poly) {
+    const int K = std::max(1, params_.points_per_quadrant);
+    std::vector<Point2f> pts;
+    pt_quad_.clear();
+    for (int q = 0; q < 4; q++) anchor_[q] = quadrant_center(q);
+
+    if (K > 1 && frame.type() == CV_8UC1) {
+        const Rect full(0, 0, frame.cols, frame.rows);
+        const Rect& b = state_.marker_bbox;
+        const Rect roi = b & full;
+        Mat poly_mask = Mat::zeros(roi.height, roi.width, CV_8UC1);
+        std::vector<Point> ipoly;
+        for (const auto& c : poly) ipoly.emplace_back(cvRound(c.x) - roi.x, cvRound(c.y) - roi.y);
+        fillConvexPoly(poly_mask, ipoly, Scalar(255));
+
+        const double min_dist = std::max(2.0, std::min(b.width, b.height) / 16.0);
+        const int hw = b.width / 2, hh = b.height / 2;
+        for (int q = 0; q < 4; q++) {
+            Rect qr(b.x + (q % 2 ? hw : 0), b.y + (q < 2 ? 0 : hh), q % 2 ? b.width - hw : hw, q < 2 ? hh : b.height - hh);
+            qr &= roi;
+            std::vector<Point2f> found;
+            if (qr.area() > 0) {
+                Rect local(qr.x - roi.x, qr.y - roi.y, qr.width, qr.height);
+                goodFeaturesToTrack(frame(qr), found, K, params_.feature_quality, min_dist, poly_mask(local));
+            }
+            for (auto& f : found) {
+                pts.push_back(f + Point2f(static_cast<float>(qr.x), static_cast<float>(qr.y)));
+                pt_quad_.push_back(q);
+            }
+            if (found.empty()) {
+                pts.push_back(anchor_[q]);
+                pt_quad_.push_back(q);
+            }
+        }
+    } else {
+        for (int q = 0; q < 4; q++) {
+            pts.push_back(anchor_[q]);
+            pt_quad_.push_back(q);
+        }
+    }
+
+    h_prev_pts_.create(1, static_cast<int>(pts.size()), CV_32FC2);
+    for (size_t j = 0; j < pts.size(); j++) h_prev_pts_.at<Point2f>(0, static_cast<int>(j)) = pts[j];
+    h_prev_pts_.copyTo(h_ref_pts_);
+    pt_alive_.assign(pts.size(), 1);
+    for (int q = 0; q < 4; q++) {
+        dx_[q].reserve(static_cast<size_t>(K));
+        dy_[q].reserve(static_cast<size_t>(K));
+    }
+}
+
 void ArucoTracker::track(const Mat&, uint64_t ts_us) {
-    lk_->calc(d_prev_, d_curr_, d_prev_pts_, d_curr_pts_, d_status_);
+    if (params_.kalman.enabled) {
+        // Seed LK with the predicted displacement so fast motion stays inside
+        // a small window/pyramid; points without a filter start where they were.
+        // With undistortion the filters run in undistorted px; over one
+        // frame's motion the lens mapping is close enough to identity.
+        Point2f shift[4];
+        for (int q = 0; q < 4; q++)
+            shift[q] = kf_[q].ready() && state_.q[q].valid ? kf_[q].predict(ts_us) - kf_[q].position() : Point2f();
+        h_prev_pts_.copyTo(h_seed_pts_);
+        for (int j = 0; j < h_seed_pts_.cols; j++)
+            h_seed_pts_.at<Point2f>(0, j) += shift[pt_quad_[j]];
+        if (params_.lk_backend == LkBackend::Cuda) d_curr_pts_.upload(h_seed_pts_);
+    }
+    // All quadrants' points in one batched call
+    const RedetectParams& rp = params_.redetect;
+    Mat h_pts, h_status, h_err, h_back, h_back_status;
+    if (params_.lk_backend == LkBackend::Cpu) {
+        track_cpu(h_pts, h_status, h_err, h_back, h_back_status);
+    } else if (rp.adaptive) {
+        lk_->calc(d_prev_, d_curr_, d_prev_pts_, d_curr_pts_, d_status_, d_err_);
+        d_err_.download(h_err);
+        if (rp.forward_backward) {
+            // back from the tracked points to the previous frame, starting where they came from
+            d_prev_pts_.copyTo(d_back_pts_);
+            lk_->calc(d_curr_, d_prev_, d_curr_pts_, d_back_pts_, d_back_status_);
+            d_back_pts_.download(h_back);
+            d_back_status_.download(h_back_status);
+        }
+    } else {
+        lk_->calc(d_prev_, d_curr_, d_prev_pts_, d_curr_pts_, d_status_);
+    }
+    if (params_.lk_backend == LkBackend::Cuda) {
+        d_curr_pts_.download(h_pts);
+        d_status_.download(h_status);
+    }
+
+    const int n = h_pts.cols;
+    m_lk_points_->inc(static_cast<uint64_t>(n));
+    for (int q = 0; q < 4; q++) { dx_[q].clear(); dy_[q].clear(); }
+    // Per-point confidence exp(-err / err_scale) * (1 - fb / fb_max_px); a
+    // quadrant's confidence is the mean over the points it started with, so
+    // lost points count as zero.
+    float q_conf[4] = {}, q_total[4] = {};
+    for (int j = 0; j < n; j++) {
+        q_total[pt_quad_[j]] += 1;
+        if (!pt_alive_[j]) continue;
+        if (!h_status.at<uchar>(0, j)) { pt_alive_[j] = 0; m_lk_failures_->inc(); continue; }
+        if (rp.adaptive) {
+            float conf = std::exp(-h_err.at<float>(0, j) / static_cast<float>(rp.err_scale));
+            if (rp.forward_backward) {
+                const Point2f e = h_back.at<Point2f>(0, j) - h_prev_pts_.at<Point2f>(0, j);
+                const float fb = std::sqrt(e.x * e.x + e.y * e.y);
+                if (!h_back_status.at<uchar>(0, j) || fb > rp.fb_max_px) {
+                    pt_alive_[j] = 0;
+                    m_fb_rejected_->inc();
+                    continue;
+                }
+                conf *= 1.0f - fb / static_cast<float>(rp.fb_max_px);
+            }
+            q_conf[pt_quad_[j]] += conf;
+        }
+        Point2f d = h_pts.at<Point2f>(0, j) - h_ref_pts_.at<Point2f>(0, j);
+        dx_[pt_quad_[j]].push_back(d.x);
+        dy_[pt_quad_[j]].push_back(d.y);
+    }
+    if (rp.adaptive) {
+        track_conf_ = 1.0f;
+        for (int q = 0; q < 4; q++) track_conf_ = std::min(track_conf_, q_total[q] > 0 ? q_conf[q] / q_total[q] : 0.0f);
+        m_track_conf_->set(track_conf_);
+    }
+
+    // Robust per-quadrant estimate: component-wise median of the displacements
+    auto median = [](std::vector<float>& v) {
+        size_t m = v.size() / 2;
+        std::nth_element(v.begin(), v.begin() + m, v.end());
+        float hi = v[m];
+        if (v.size() % 2) return hi;
+        return 0.5f * (hi + *std::max_element(v.begin(), v.begin() + m));
+    };
+    for (int q = 0; q < 4; q++) {
+        if (dx_[q].empty()) {
+            // every point of the quadrant is gone; re-detect on the next frame
+            state_.q[q].valid = false;
+            need_redetect_ = true;
+            continue;
+        }
+        const Point2f p = anchor_[q] + Point2f(median(dx_[q]), median(dy_[q]));
+        update_point(q, undistorted(p), ts_us);
+        state_.q[q].image_pos = p;
+        state_.q[q].valid = true;
+    }
+
+    if (params_.lk_backend == LkBackend::Cuda) d_prev_pts_ = d_curr_pts_.clone();
+    h_prev_pts_ = h_pts;
+}
 
-    Mat h_pts, h_status;
-    d_curr_pts_.download(h_pts);
-    d_status_.download(h_status);
+// Same outputs as the CUDA calls in track(), as 1xN rows, from the pyramids
+// of the previous and current frame; no image work happens here.
+void ArucoTracker::track_cpu(Mat& pts, Mat& status, Mat& err, Mat& back, Mat& back_status) {
+    const RedetectParams& rp = params_.redetect;
+    const Size win(params_.lk_win_size, params_.lk_win_size);
+    const TermCriteria crit(TermCriteria::COUNT, params_.lk_iters, 0);
+    if (!prev_pyr_ || !curr_pyr_ || !prev_pyr_->matches(win, params_.lk_max_level)) {
+        // LK geometry changed since the previous frame: no points, re-detect
+        pts.release();
+        return;
+    }
+    int flags = 0;
+    if (params_.kalman.enabled && h_seed_pts_.cols == h_prev_pts_.cols) {
+        h_seed_pts_.copyTo(pts);
+        flags = OPTFLOW_USE_INITIAL_FLOW;
+    }
+    calcOpticalFlowPyrLK(prev_pyr_->levels, curr_pyr_->levels, h_prev_pts_, pts, status, err,
+                         win, params_.lk_max_level, crit, flags);
+    status = status.reshape(1, 1);
+    err = err.reshape(1, 1);
+    if (rp.adaptive && rp.forward_backward) {
+        h_prev_pts_.copyTo(back);
+        calcOpticalFlowPyrLK(curr_pyr_->levels, prev_pyr_->levels, pts, back, back_status, noArray(),
+                             win, params_.lk_max_level, crit, OPTFLOW_USE_INITIAL_FLOW);
+        back_status = back_status.reshape(1, 1);
+    }
+}
 
+// One ECC alignment of the marker template per frame; detection only runs to
+// (re)acquire the marker or when the alignment is lost. Quadrants are the
+// template's quadrant centres mapped through H, so they follow rotation and
+// perspective of the marker.
+void ArucoTracker::track_homography(const Mat& frame, uint64_t ts_us) {
+    bool aligned = false;
+    if (state_.tracking && aligner_.ready()) {
+        m_homog_aligns_->inc();
+        aligned = aligner_.align(frame, params_.homog);
+        if (!aligned) {
+            m_homog_failures_->inc();
+            m_redetect_forced_->inc();
+        }
+    }
+    if (!aligned) {
+        detect_marker(frame);
+        if (!state_.tracking || !aligner_.ready()) return;
+    }
+
+    Point2f c[4];
+    aligner_.corners(c);
+    state_.marker_bbox = boundingRect(std::vector<Point2f>(c, c + 4));
+    for (int q = 0; q < 4; q++) {
+        const Point2f p = aligner_.quadrantCenter(q);
+        update_point(q, undistorted(p), ts_us);
+        state_.q[q].image_pos = p;
+        state_.q[q].valid = true;
+    }
+}
+
+// Keep the filters as the last full pass left them. d_prev_ and the LK
+// points stay on that frame too, so the next full pass measures the whole
+// displacement since then and must fold it in over the whole interval.
+void ArucoTracker::set_aside() {
+    if (holding_) return;
+    for (int i = 0; i < 4; i++) {
+        held_[i] = state_.q[i].motion;
+        held_kf_[i] = kf_[i];
+    }
+    holding_ = true;
+}
+
+// "Unchanged" update for gated frames: reported as LK seeing zero
+// displacement, so velocity decays through the usual smoothing and
+// timestamps stay current. The measurements only go into the reported
+// state; the set-aside filters are restored before the next full pass.
+void ArucoTracker::hold_state(uint64_t ts_us) {
+    if (!state_.tracking) return;
+    set_aside();
+    for (int i = 0; i < 4; i++) {
+        if (!state_.q[i].valid) continue;
+        update_point(i, state_.q[i].motion.pos, ts_us);
+    }
+}
+
+// Bad frame: report each quadrant where its motion model puts it, without a
+// measurement. Like hold_state, the state of the last full pass is kept
+// aside and restored before the next one, so neither the EMA nor the Kalman
+// filter sees the extrapolated positions as measurements.
+void ArucoTracker::coast_state(uint64_t ts_us) {
+    if (!state_.tracking) return;
+    set_aside();
+    coasting_ = true;
     for (int i = 0; i < 4; i++) {
-        if (!h_status.at<uchar>(0, i)) continue;
-        update_motion(state_.q[i].motion,
-                      h_pts.at<Point2f>(0, i),
-                      ts_us);
-        state_.q[i].valid = true;
+        const MotionState& h = held_[i];
+        if (!state_.q[i].valid || ts_us <= h.last_ts_us) continue;
+        MotionState& m = state_.q[i].motion;
+        if (params_.kalman.enabled && held_kf_[i].ready()) {
+            m.pos = held_kf_[i].predict(ts_us);
+        } else {
+            const float dt = static_cast<float>((ts_us - h.last_ts_us) * 1e-6);
+            m.pos = h.pos + h.vel * dt + h.acc * (0.5f * dt * dt);
+        }
     }
+}
+
+// Whether the next full pass would run a detection.
+bool ArucoTracker::detection_due() const {
+    if (params_.track_mode == TrackMode::Homography) return !state_.tracking;
+    return redetect_due(true);
+}
+
+// LK mode: detect when lost, when a quadrant lost all its points, and then
+// either on the fixed cadence or when the track confidence says so (with
+// max_interval as the safety net). `next`: asked before the frame counters
+// advance.
+bool ArucoTracker::redetect_due(bool next) const {
+    if (!state_.tracking || need_redetect_) return true;
+    const int ahead = next ? 1 : 0;
+    if (!params_.redetect.adaptive) return (frame_count_ + ahead) % params_.redetect_interval == 0;
+    return since_detect_ + ahead >= params_.redetect.max_interval || track_conf_ < params_.redetect.min_confidence;
+}
+
+void ArucoTracker::publish_spectrum() {
+    for (int q = 0; q < 4; q++)
+        for (int a = 0; a < 2; a++) {
+            const SpectrumPeak& pk = spectrum_.peak(q, a);
+            if (!pk.valid || !m_vib_freq_[q][a]) continue;
+            m_vib_freq_[q][a]->set(pk.freq_hz);
+            m_vib_amp_[q][a]->set(pk.amp_px);
+            m_vib_rms_[q][a]->set(pk.rms_px);
+        }
+}
+
+void ArucoTracker::update_pose(const Mat& frame, uint64_t ts_us, bool at_anchor) {
+    bool all = state_.tracking && pose_.hasCalibration();
+    for (int q = 0; q < 4 && all; q++) all = state_.q[q].valid || at_anchor;
+    if (!all) {
+        state_.pose.valid = false;
+        return;
+    }
+    Point2f img[4];
+    for (int q = 0; q < 4; q++) img[q] = at_anchor ? undistorted(anchor_[q]) : state_.q[q].motion.pos;
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = pose_.update(img, frame.size(), ts_us, params_.pose, state_.pose);
+    m_pose_lat_->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    if (!ok) {
+        m_pose_failed_->inc();
+        return;
+    }
+    (pose_.lastWarm() ? m_pose_warm_ : m_pose_cold_)->inc();
+    m_pose_reproj_->set(state_.pose.reproj_px);
+    const double t[3] = {state_.pose.t.x, state_.pose.t.y, state_.pose.t.z};
+    const double v[3] = {state_.pose.vel.x, state_.pose.vel.y, state_.pose.vel.z};
+    for (int a = 0; a < 3; a++) {
+        m_pose_t_[a]->set(t[a]);
+        m_pose_v_[a]->set(v[a]);
+    }
+}
 
-    d_prev_pts_ = d_curr_pts_.clone();
+void ArucoTracker::update_point(int i, const Point2f& pos, uint64_t ts_us) {
+    if (params_.kalman.enabled)
+        kf_[i].update(pos, ts_us, params_.kalman, state_.q[i].motion);
+    else
+        update_motion(state_.q[i].motion, pos, ts_us, params_.motion);
 }
 
 Point2f ArucoTracker::quadrant_center(int i) const {
@@ -6,38 +6,173 @@
 #include <opencv2/cudaarithm.hpp>
 
 #include "motion_types.h"
+#include "tracker_params.h"
+#include "motion_gate.h"
+#include "kalman_point.h"
+#include "homography_aligner.h"
+#include "vibration_spectrum.h"
+#include "pose_estimator.h"
+#include "undistort_lut.h"
+#include "tiled_detector.h"
+#include "pyramid_pipeline.h"
+#include "../util/metrics.h"
 
 class ArucoTracker {
 public:
+    struct GateStats {
+        uint64_t checked = 0;    // frames offered to the change detector
+        uint64_t skipped = 0;    // frames that took the "unchanged" path
+        double saved_s = 0;      // estimated pipeline time avoided, net of gate cost
+    };
+
+    struct QualityStats {
+        uint64_t rejected = 0;           // frames that skipped detection and LK
+        uint64_t detections_skipped = 0; // of those, frames that were due a detection
+    };
+
     struct Options {
         bool enable_save = true;   // frame+json snapshots once per second
-        bool enable_live = true;   // live JPEG/UDP snapshots (~10 FPS)
         bool enable_csv = true;    // per-frame CSV logging
         bool enable_metrics = true;// UDP metrics output
+        uint64_t save_period_us = 1000000;   // snapshot interval
+        uint64_t metrics_period_us = 100000; // UDP metrics interval
+        bool metrics_binary = false;         // UDP as a state_schema binary record instead of JSON
     };
 
-    ArucoTracker();
-    void process(const cv::Mat& frame, uint64_t ts_us);
+    // `camera` names this tracker when several run side by side: it labels
+    // the tracker's metrics and tags its CSV rows, snapshots and UDP JSON.
+    explicit ArucoTracker(const TrackerParams& params = TrackerParams(), const std::string& camera = std::string());
+    // With params().lk_backend == Cpu, `pyr` is the frame's LK pyramid when
+    // a PyramidPipeline built it ahead; otherwise it is built inline.
+    void process(const cv::Mat& frame, uint64_t ts_us, PyramidPtr pyr = nullptr);
+    // Run the CUDA upload, LK, marker detection, feature selection and (in
+    // homography mode) ECC alignment once on synthetic frames of `size`, so
+    // the first real process() call pays no lazy initialisation. Tracking
+    // state, counters and metrics are left untouched.
+    void warmUp(const cv::Size& size);
     void setOptions(const Options& opt) { options_ = opt; }
+    void setParams(const TrackerParams& p);
+    // Intrinsics for the pose stage (params().pose); without them no pose is solved.
+    void setCalibration(const CameraCalibration& c);
+    bool hasCalibration() const { return calib_.valid(); }
+    // Report quadrant positions (and feed the pose stage) in undistorted
+    // pixel coordinates, through a lookup grid with a node every `step` px,
+    // built for the first frame size (or loaded from `cache`). Needs a
+    // calibration; step <= 0 turns it off. Tracking itself (LK, ECC, the
+    // marker bbox and the gate ROI) stays in image coordinates.
+    void setUndistortion(int step, const std::string& cache = std::string());
+    const UndistortLut& undistortLut() const { return lut_; }
+    const PoseEstimator& pose() const { return pose_; }
+    const TrackerParams& params() const { return params_; }
+    int detections() const { return detections_; }
+    // Confidence of the last LK pass (params().redetect.adaptive only; 1 otherwise).
+    float trackConfidence() const { return track_conf_; }
+    const GateStats& gateStats() const { return gate_stats_; }
+    const QualityStats& qualityStats() const { return quality_stats_; }
+    const QualityGate& qualityGate() const { return quality_; }
+    const VibrationSpectrum& spectrum() const { return spectrum_; }
     bool isTracking() const { return state_.tracking; }
     const TrackerState& state() const { return state_; }
+    const std::string& camera() const { return camera_; }
 
 private:
     void detect_marker(const cv::Mat& frame);
+    void select_points(const cv::Mat& frame, const std::vector<cv::Point2f>& poly);
     void track(const cv::Mat& frame, uint64_t ts_us);
+    void track_cpu(cv::Mat& pts, cv::Mat& status, cv::Mat& err, cv::Mat& back, cv::Mat& back_status);
+    void track_homography(const cv::Mat& frame, uint64_t ts_us);
+    void set_aside();
+    void hold_state(uint64_t ts_us);
+    void coast_state(uint64_t ts_us);
+    bool detection_due() const;
+    bool redetect_due(bool next) const;
+    void update_point(int i, const cv::Point2f& pos, uint64_t ts_us);
+    void publish_spectrum();
+    void update_pose(const cv::Mat& frame, uint64_t ts_us, bool at_anchor);
+    void prepare_lut(const cv::Size& size);
+    cv::Point2f undistorted(const cv::Point2f& p) const { return lut_.ready() ? lut_.map(p) : p; }
     cv::Point2f quadrant_center(int idx) const;
 
 private:
     TrackerState state_;
+    std::string camera_;
+    std::vector<char> out_buf_;   // snapshot/UDP serialisation, sized once
 
     cv::Ptr<cv::aruco::Dictionary> dict_;
     cv::Ptr<cv::cuda::SparsePyrLKOpticalFlow> lk_;
 
     cv::cuda::GpuMat d_prev_, d_curr_;
     cv::cuda::GpuMat d_prev_pts_, d_curr_pts_, d_status_;
+    cv::cuda::GpuMat d_err_, d_back_pts_, d_back_status_; // confidence-driven re-detection only
+    PyramidPtr prev_pyr_, curr_pyr_; // LkBackend::Cpu only
+    PyramidPool pyr_pool_{4};     // inline builds when no pipeline supplies the pyramid
+    cv::Mat h_prev_pts_;          // host copy of d_prev_pts_ (1xN CV_32FC2)
+    cv::Mat h_seed_pts_;          // predicted positions for LK initial flow
+    cv::Mat h_ref_pts_;           // point positions at the last detection
+    std::vector<int> pt_quad_;    // quadrant of each tracked point
+    std::vector<uint8_t> pt_alive_;
+    cv::Point2f anchor_[4];       // quadrant centres at the last detection
+    std::vector<float> dx_[4], dy_[4]; // per-quadrant LK displacements, reused every frame
+    bool need_redetect_ = false;
+    float track_conf_ = 1.0f;     // weakest quadrant's confidence in the last LK pass
+    int since_detect_ = 0;        // LK passes since the last detection
+
+    KalmanPoint kf_[4];
+    HomographyAligner aligner_;
+    VibrationSpectrum spectrum_;
+    PoseEstimator pose_;
+    CameraCalibration calib_;
+    UndistortLut lut_;
+    int undistort_step_ = 0;      // 0 = off
+    std::string undistort_cache_;
+    TiledDetector tiled_;
 
     bool have_prev_ = false;
     int frame_count_ = 0;
+    int detections_ = 0;
 
     Options options_{};
+    TrackerParams params_{};
+    bool configured_ = false;     // setParams() has run once
+
+    MotionGate gate_;
+    GateStats gate_stats_;
+    QualityGate quality_;
+    QualityStats quality_stats_;
+    MotionState held_[4];         // state of the last full pass, restored before the next one
+    KalmanPoint held_kf_[4];
+    bool holding_ = false;        // held_ is set aside (gated or rejected frames since the last full pass)
+    bool coasting_ = false;       // a rejected frame since the last full pass
+    double full_cost_ema_s_ = 0; // mean cost of a full pass, for the savings estimate
+
+    // owned by MetricsRegistry
+    Counter* m_detect_calls_ = nullptr;
+    Counter* m_detect_found_ = nullptr;
+    Counter* m_lk_points_ = nullptr;
+    Counter* m_lk_failures_ = nullptr;
+    Counter* m_redetect_forced_ = nullptr;
+    Counter* m_homog_aligns_ = nullptr;
+    Counter* m_homog_failures_ = nullptr;
+    Counter* m_gate_checked_ = nullptr;
+    Counter* m_gate_skipped_ = nullptr;
+    Gauge* m_gate_saved_ = nullptr;
+    Counter* m_quality_rejected_[2] = {}; // registered once the quality gate is enabled; [blur, exposure]
+    Counter* m_quality_detect_skipped_ = nullptr;
+    Gauge* m_quality_sharpness_ = nullptr;
+    Gauge* m_quality_clipped_ = nullptr;
+    Histogram* m_quality_lat_ = nullptr;
+    Gauge* m_vib_freq_[4][2] = {};   // registered once the spectrum is enabled
+    Gauge* m_vib_amp_[4][2] = {};
+    Gauge* m_vib_rms_[4][2] = {};
+    Counter* m_pose_warm_ = nullptr;   // registered once the pose stage is enabled
+    Counter* m_pose_cold_ = nullptr;
+    Counter* m_pose_failed_ = nullptr;
+    Histogram* m_pose_lat_ = nullptr;
+    Gauge* m_pose_t_[3] = {};
+    Gauge* m_pose_v_[3] = {};
+    Gauge* m_pose_reproj_ = nullptr;
+    Counter* m_redetect_low_conf_ = nullptr; // registered once adaptive re-detection is enabled
+    Counter* m_fb_rejected_ = nullptr;
+    Gauge* m_track_conf_ = nullptr;
+    Counter* m_tile_merged_ = nullptr; // registered once tiled detection is enabled
 };
@@ -0,0 +1,109 @@
+#include "homography_aligner.h"
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+bool HomographyAligner::init(const cv::Mat& frame, const std::vector<cv::Point2f>& corners, const HomographyParams& p) {
+    ready_ = false;
+    if (corners.size() != 4 || frame.type() != CV_8UC1) return false;
+    tmpl_px_ = p.template_px;
+    margin_ = p.margin_px;
+    const float a = static_cast<float>(margin_), b = static_cast<float>(margin_ + tmpl_px_);
+    std::vector<cv::Point2f> src{{a, a}, {b, a}, {b, b}, {a, b}};
+    cv::Mat H = cv::getPerspectiveTransform(src, corners);
+    for (int i = 0; i < 9; i++) H_[i] = H.at<double>(i / 3, i % 3);
+
+    // Template = marker plus quiet zone, resampled into the canonical square
+    const int side = tmpl_px_ + 2 * margin_;
+    tmpl_pyr_.resize(static_cast<size_t>(std::max(1, p.levels)));
+    cv::warpPerspective(frame, tmpl_pyr_[0], H, cv::Size(side, side), cv::INTER_LINEAR | cv::WARP_INVERSE_MAP);
+    for (size_t l = 1; l < tmpl_pyr_.size(); l++) cv::pyrDown(tmpl_pyr_[l - 1], tmpl_pyr_[l]);
+    cc_ = 1.0;
+    ready_ = true;
+    return true;
+}
+
+bool HomographyAligner::align(const cv::Mat& frame, const HomographyParams& p) {
+    if (!ready_ || frame.type() != CV_8UC1) return false;
+
+    // Search window: template footprint under the last pose, grown by `search`
+    const float side = static_cast<float>(tmpl_px_ + 2 * margin_);
+    cv::Point2f c[4] = {map({0, 0}), map({side, 0}), map({side, side}), map({0, side})};
+    float x0 = c[0].x, x1 = c[0].x, y0 = c[0].y, y1 = c[0].y;
+    for (const auto& q : c) {
+        x0 = std::min(x0, q.x); x1 = std::max(x1, q.x);
+        y0 = std::min(y0, q.y); y1 = std::max(y1, q.y);
+    }
+    const float grow = static_cast<float>(p.search) * std::max(x1 - x0, y1 - y0) + 4.0f;
+    cv::Rect roi(cv::Point(static_cast<int>(x0 - grow), static_cast<int>(y0 - grow)),
+                 cv::Point(static_cast<int>(x1 + grow) + 1, static_cast<int>(y1 + grow) + 1));
+    roi &= cv::Rect(0, 0, frame.cols, frame.rows);
+    if (roi.width < 8 || roi.height < 8) return false;
+
+    const int levels = static_cast<int>(tmpl_pyr_.size());
+    img_pyr_.resize(tmpl_pyr_.size());
+    frame(roi).copyTo(img_pyr_[0]);
+    for (int l = 1; l < levels; l++) cv::pyrDown(img_pyr_[l - 1], img_pyr_[l]);
+
+    // H relative to the ROI origin
+    double h[9];
+    std::copy(H_, H_ + 9, h);
+    for (int j = 0; j < 3; j++) {
+        h[j] -= roi.x * h[6 + j];
+        h[3 + j] -= roi.y * h[6 + j];
+    }
+
+    cv::Mat W(3, 3, CV_32F);
+    double cc = 0;
+    try {
+        for (int l = levels - 1; l >= 0; l--) {
+            // level-l warp: S H S^-1 with S = diag(s, s, 1)
+            const double s = 1.0 / (1 << l);
+            const double w[9] = {h[0], h[1], h[2] * s, h[3], h[4], h[5] * s, h[6] / s, h[7] / s, h[8]};
+            for (int i = 0; i < 9; i++) W.at<float>(i / 3, i % 3) = static_cast<float>(w[i] / w[8]);
+            cc = cv::findTransformECC(tmpl_pyr_[l], img_pyr_[l], W, cv::MOTION_HOMOGRAPHY,
+                                      cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, p.iters, p.eps),
+                                      cv::noArray(), 1);
+            for (int i = 0; i < 9; i++) {
+                double v = W.at<float>(i / 3, i % 3);
+                if (i == 2 || i == 5) v /= s;
+                else if (i == 6 || i == 7) v *= s;
+                h[i] = v;
+            }
+        }
+    } catch (const cv::Exception&) {
+        cc_ = 0;
+        return false; // did not converge
+    }
+    cc_ = cc;
+    if (!std::isfinite(cc) || cc < p.min_cc) return false;
+
+    for (int j = 0; j < 3; j++) {
+        h[j] += roi.x * h[6 + j];
+        h[3 + j] += roi.y * h[6 + j];
+    }
+    std::copy(h, h + 9, H_);
+    return true;
+}
+
+cv::Point2f HomographyAligner::map(const cv::Point2f& t) const {
+    const double w = H_[6] * t.x + H_[7] * t.y + H_[8];
+    return {static_cast<float>((H_[0] * t.x + H_[1] * t.y + H_[2]) / w),
+            static_cast<float>((H_[3] * t.x + H_[4] * t.y + H_[5]) / w)};
+}
+
+void HomographyAligner::corners(cv::Point2f out[4]) const {
+    const float a = static_cast<float>(margin_), b = static_cast<float>(margin_ + tmpl_px_);
+    out[0] = map({a, a});
+    out[1] = map({b, a});
+    out[2] = map({b, b});
+    out[3] = map({a, b});
+}
+
+cv::Point2f HomographyAligner::quadrantCenter(int i) const {
+    const float q1 = margin_ + 0.25f * tmpl_px_, q3 = margin_ + 0.75f * tmpl_px_;
+    return map({i % 2 ? q3 : q1, i < 2 ? q1 : q3});
+}
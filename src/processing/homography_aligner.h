@@ -0,0 +1,44 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+struct HomographyParams {
+    int template_px = 64;   // marker side in the canonical template
+    int margin_px = 8;      // quiet-zone border kept around the marker
+    int levels = 2;         // pyramid levels (1 = full resolution only)
+    int iters = 30;         // ECC iterations per level
+    double eps = 1e-4;      // ECC convergence threshold
+    double min_cc = 0.80;   // correlation below this counts as lost
+    double search = 0.25;   // ROI growth around the last pose (fraction of marker size)
+};
+
+// Direct alignment of a canonical marker template to each frame with an
+// 8-DOF homography (ECC, coarse-to-fine). H maps template pixels to frame
+// pixels; the template is re-cut from the frame on every detection.
+class HomographyAligner {
+public:
+    // Build the template from a detected marker (corners in aruco order TL, TR, BR, BL).
+    bool init(const cv::Mat& frame, const std::vector<cv::Point2f>& corners, const HomographyParams& p);
+    // Refine H against `frame`, starting from the previous pose.
+    bool align(const cv::Mat& frame, const HomographyParams& p);
+
+    bool ready() const { return ready_; }
+    void reset() { ready_ = false; }
+    double lastCC() const { return cc_; }
+
+    cv::Point2f map(const cv::Point2f& t) const;
+    // Marker corners and quadrant centres in frame coordinates. Quadrants
+    // follow the marker's own axes: 0 TL, 1 TR, 2 BL, 3 BR.
+    void corners(cv::Point2f out[4]) const;
+    cv::Point2f quadrantCenter(int i) const;
+
+private:
+    double H_[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    std::vector<cv::Mat> tmpl_pyr_;
+    std::vector<cv::Mat> img_pyr_;  // reused between frames
+    int tmpl_px_ = 0, margin_ = 0;
+    double cc_ = 0;
+    bool ready_ = false;
+};
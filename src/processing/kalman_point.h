@@ -0,0 +1,99 @@
+#pragma once
+#include "motion_types.h"
+
+#include <cstdint>
+
+// Constant-acceleration Kalman filter for one image point. x and y are
+// independent 3-state filters [p, v, a] driven by white jerk noise, so each
+// step is a handful of scalar multiply-adds and never allocates.
+struct KalmanParams {
+    bool enabled = false;
+    double jerk_psd = 1e8;     // white-jerk spectral density (px^2/s^5); higher = more responsive
+    double meas_sigma = 0.3;   // LK measurement noise (px)
+    double max_gap_s = 0.25;   // longer gaps restart the filter
+};
+
+class KalmanPoint {
+public:
+    bool ready() const { return ready_; }
+    void reset() { ready_ = false; }
+
+    // Position expected at ts_us (does not change the filter).
+    cv::Point2f predict(uint64_t ts_us) const {
+        if (!ready_ || ts_us <= ts_us_) return position();
+        double dt = (ts_us - ts_us_) * 1e-6;
+        return {static_cast<float>(x_.p + x_.v * dt + 0.5 * x_.a * dt * dt),
+                static_cast<float>(y_.p + y_.v * dt + 0.5 * y_.a * dt * dt)};
+    }
+
+    cv::Point2f position() const { return {static_cast<float>(x_.p), static_cast<float>(y_.p)}; }
+
+    // Fold in a measurement and write the filtered estimate into `out`.
+    void update(const cv::Point2f& z, uint64_t ts_us, const KalmanParams& kp, MotionState& out) {
+        double dt = ready_ && ts_us > ts_us_ ? (ts_us - ts_us_) * 1e-6 : -1.0;
+        if (!ready_ || dt > kp.max_gap_s) {
+            x_.init(z.x, kp.meas_sigma);
+            y_.init(z.y, kp.meas_sigma);
+            ready_ = true;
+        } else if (dt > 0) {
+            const double r = kp.meas_sigma * kp.meas_sigma;
+            x_.step(z.x, dt, kp.jerk_psd, r);
+            y_.step(z.y, dt, kp.jerk_psd, r);
+        } else {
+            return; // duplicate or out-of-order timestamp
+        }
+        ts_us_ = ts_us;
+        out.pos = {static_cast<float>(x_.p), static_cast<float>(y_.p)};
+        out.vel = {static_cast<float>(x_.v), static_cast<float>(y_.v)};
+        out.acc = {static_cast<float>(x_.a), static_cast<float>(y_.a)};
+        out.last_ts_us = ts_us;
+    }
+
+private:
+    struct Axis {
+        double p = 0, v = 0, a = 0;
+        double P[3][3] = {};
+
+        void init(double z, double sigma) {
+            p = z; v = 0; a = 0;
+            for (auto& row : P) for (double& e : row) e = 0;
+            P[0][0] = sigma * sigma;
+            P[1][1] = 1e4;   // (100 px/s)^2
+            P[2][2] = 1e8;   // (1e4 px/s^2)^2
+        }
+
+        void step(double z, double dt, double q, double r) {
+            const double dt2 = dt * dt, dt3 = dt2 * dt, dt4 = dt3 * dt, dt5 = dt4 * dt;
+            // predict: x = F x
+            p += v * dt + 0.5 * a * dt2;
+            v += a * dt;
+            // P = F P F^T + Q
+            const double F[3][3] = {{1, dt, 0.5 * dt2}, {0, 1, dt}, {0, 0, 1}};
+            double FP[3][3];
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++)
+                    FP[i][j] = F[i][0] * P[0][j] + F[i][1] * P[1][j] + F[i][2] * P[2][j];
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++)
+                    P[i][j] = FP[i][0] * F[j][0] + FP[i][1] * F[j][1] + FP[i][2] * F[j][2];
+            const double Q[3][3] = {{dt5 / 20, dt4 / 8, dt3 / 6}, {dt4 / 8, dt3 / 3, dt2 / 2}, {dt3 / 6, dt2 / 2, dt}};
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++) P[i][j] += q * Q[i][j];
+            // update with H = [1 0 0]
+            const double s = P[0][0] + r;
+            const double k0 = P[0][0] / s, k1 = P[1][0] / s, k2 = P[2][0] / s;
+            const double y = z - p;
+            p += k0 * y; v += k1 * y; a += k2 * y;
+            const double r0[3] = {P[0][0], P[0][1], P[0][2]};
+            for (int j = 0; j < 3; j++) {
+                P[0][j] -= k0 * r0[j];
+                P[1][j] -= k1 * r0[j];
+                P[2][j] -= k2 * r0[j];
+            }
+        }
+    };
+
+    Axis x_, y_;
+    uint64_t ts_us_ = 0;
+    bool ready_ = false;
+};
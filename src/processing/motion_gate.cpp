@@ -0,0 +1,77 @@
+#include "motion_gate.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+uint64_t MotionGate::sad_u8(const uint8_t* a, const uint8_t* b, size_t n) {
+    uint64_t sum = 0;
+    size_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t d = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        acc = vpadalq_u16(acc, vpaddlq_u8(d));
+    }
+    uint64x2_t s = vpaddlq_u32(acc);
+    sum = vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1);
+#elif defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    sum = static_cast<uint64_t>(_mm_cvtsi128_si64(acc)) +
+          static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+#endif
+    for (; i < n; i++) sum += static_cast<uint64_t>(std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+    return sum;
+}
+
+cv::Rect MotionGate::sampleRect(const cv::Mat& frame, const cv::Rect& roi) const {
+    cv::Rect full(0, 0, frame.cols, frame.rows);
+    if (roi.area() <= 0) return full;
+    cv::Rect r(roi.x - p_.margin_px, roi.y - p_.margin_px, roi.width + 2 * p_.margin_px, roi.height + 2 * p_.margin_px);
+    r &= full;
+    return r.area() > 0 ? r : full;
+}
+
+bool MotionGate::unchanged(const cv::Mat& frame, const cv::Rect& roi) {
+    if (!p_.enabled || ref_.empty() || frame.type() != CV_8UC1) return false;
+    if (skips_ >= p_.max_skip) return false;
+
+    // Keep the reference geometry while skipping; a new ROI means a new reference.
+    cv::Rect r = sampleRect(frame, roi);
+    if (r != ref_rect_) return false;
+
+    const int step = std::max(1, p_.decimation);
+    const size_t w = static_cast<size_t>(r.width);
+    uint64_t sad = 0;
+    size_t n = 0;
+    for (int y = r.y, k = 0; y < r.y + r.height; y += step, k++) {
+        sad += sad_u8(frame.ptr<uint8_t>(y) + r.x, ref_.data() + k * w, w);
+        n += w;
+    }
+    last_score_ = n ? static_cast<double>(sad) / static_cast<double>(n) : 0.0;
+    if (last_score_ > p_.threshold) return false;
+    skips_++;
+    return true;
+}
+
+void MotionGate::setReference(const cv::Mat& frame, const cv::Rect& roi) {
+    skips_ = 0;
+    if (!p_.enabled || frame.type() != CV_8UC1) { ref_.clear(); return; }
+    ref_rect_ = sampleRect(frame, roi);
+    const int step = std::max(1, p_.decimation);
+    const size_t w = static_cast<size_t>(ref_rect_.width);
+    const int rows = (ref_rect_.height + step - 1) / step;
+    ref_.resize(w * static_cast<size_t>(rows));
+    for (int y = ref_rect_.y, k = 0; y < ref_rect_.y + ref_rect_.height; y += step, k++)
+        std::copy_n(frame.ptr<uint8_t>(y) + ref_rect_.x, w, ref_.data() + k * w);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct MotionGateParams {
+    bool enabled = false;
+    double threshold = 3.0;  // mean |diff| per sampled pixel (grey levels) that counts as change
+    int decimation = 4;      // sample every Nth row of the ROI
+    int margin_px = 16;      // ROI = marker bbox grown by this much (whole frame when not tracking)
+    int max_skip = 60;       // force a full pass after this many consecutive skips
+};
+
+// Cheap change detector run ahead of the full tracking pipeline. Compares a
+// row-decimated view of the ROI against the same view of the last frame that
+// went through the full pipeline (not the previous frame, so slow drift still
+// accumulates until it crosses the threshold).
+class MotionGate {
+public:
+    explicit MotionGate(const MotionGateParams& p = MotionGateParams()) : p_(p) {}
+
+    void setParams(const MotionGateParams& p) { p_ = p; reset(); }
+    const MotionGateParams& params() const { return p_; }
+
+    // True when `frame` inside `roi` matches the reference closely enough to
+    // skip the full pipeline. Always false without a reference.
+    bool unchanged(const cv::Mat& frame, const cv::Rect& roi);
+    // Take the reference from `frame` after a full pass.
+    void setReference(const cv::Mat& frame, const cv::Rect& roi);
+    void reset() { ref_.clear(); skips_ = 0; }
+
+    double lastScore() const { return last_score_; }
+
+    // Sum of absolute differences of two byte rows (NEON / SSE2 / scalar).
+    static uint64_t sad_u8(const uint8_t* a, const uint8_t* b, size_t n);
+
+private:
+    cv::Rect sampleRect(const cv::Mat& frame, const cv::Rect& roi) const;
+
+    MotionGateParams p_;
+    cv::Rect ref_rect_;
+    std::vector<uint8_t> ref_; // sampled rows, packed
+    int skips_ = 0;
+    double last_score_ = 0;
+};
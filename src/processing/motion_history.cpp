@@ -0,0 +1,250 @@
+#include "motion_history.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+const uint64_t kPeriodUs[MotionHistory::kTiers] = {1000000ULL, 10000000ULL, 60000000ULL};
+
+} // namespace
+
+MotionHistory::MotionHistory() : MotionHistory(Config()) {}
+
+MotionHistory::MotionHistory(const Config& cfg) {
+    const size_t raw = static_cast<size_t>(std::max(1.0, std::ceil(cfg.raw_seconds * cfg.max_fps * 1.25)));
+    raw_.resize(raw);
+    for (int t = 0; t < kTiers; t++) {
+        tiers_[t].period_us = kPeriodUs[t];
+        tiers_[t].ring.resize(static_cast<size_t>(std::max(1, cfg.tier_buckets[t])));
+    }
+}
+
+void MotionHistory::reset(Bucket& b, uint64_t start_us) {
+    b.start_us = start_us;
+    for (int q = 0; q < 4; q++) {
+        b.n[q] = 0;
+        for (int c = 0; c < kChannels; c++) {
+            b.min[q][c] = std::numeric_limits<float>::max();
+            b.max[q][c] = std::numeric_limits<float>::lowest();
+            b.sum[q][c] = 0;
+        }
+    }
+}
+
+void MotionHistory::merge(Bucket& into, const Bucket& b) {
+    for (int q = 0; q < 4; q++) {
+        if (!b.n[q]) continue;
+        into.n[q] += b.n[q];
+        for (int c = 0; c < kChannels; c++) {
+            into.min[q][c] = std::min(into.min[q][c], b.min[q][c]);
+            into.max[q][c] = std::max(into.max[q][c], b.max[q][c]);
+            into.sum[q][c] += b.sum[q][c];
+        }
+    }
+}
+
+// Fold `b` into tier t's open bucket; a bucket that closes goes into the
+// ring and, folded whole, into the next tier.
+void MotionHistory::add_to_tier(int t, const Bucket& b) {
+    Tier& tier = tiers_[t];
+    const uint64_t start = b.start_us - b.start_us % tier.period_us;
+    if (tier.has_open && start != tier.open.start_us) {
+        tier.ring[tier.head] = tier.open;
+        tier.head = (tier.head + 1) % tier.ring.size();
+        tier.count = std::min(tier.count + 1, tier.ring.size());
+        tier.has_open = false;
+        if (t + 1 < kTiers) add_to_tier(t + 1, tier.open);
+    }
+    if (!tier.has_open) {
+        reset(tier.open, start);
+        tier.has_open = true;
+    }
+    merge(tier.open, b);
+}
+
+void MotionHistory::push(const TrackerState& st, uint64_t ts_us) {
+    std::lock_guard<std::mutex> lk(m_);
+    if (raw_count_) {
+        const Sample& last = raw_[(raw_head_ + raw_.size() - 1) % raw_.size()];
+        if (ts_us < last.ts_us) {
+            // frame clock restarted (file source looped): history no longer lines up
+            raw_count_ = raw_head_ = 0;
+            for (auto& tier : tiers_) {
+                tier.count = tier.head = 0;
+                tier.has_open = false;
+            }
+        }
+    }
+    if (!raw_count_) first_us_ = ts_us;
+    Sample& s = raw_[raw_head_];
+    s.ts_us = ts_us;
+    s.valid = 0;
+    reset(frame_, ts_us);
+    for (int q = 0; q < 4; q++) {
+        const MotionState& m = st.q[q].motion;
+        const float v[kChannels] = {m.vel.x, m.vel.y, m.acc.x, m.acc.y};
+        const bool valid = st.tracking && st.q[q].valid;
+        for (int c = 0; c < kChannels; c++) s.v[q][c] = v[c];
+        if (!valid) continue;
+        s.valid |= static_cast<uint8_t>(1u << q);
+        frame_.n[q] = 1;
+        for (int c = 0; c < kChannels; c++) {
+            frame_.min[q][c] = frame_.max[q][c] = v[c];
+            frame_.sum[q][c] = v[c];
+        }
+    }
+    raw_head_ = (raw_head_ + 1) % raw_.size();
+    raw_count_ = std::min(raw_count_ + 1, raw_.size());
+    add_to_tier(0, frame_);
+}
+
+uint64_t MotionHistory::periodUs(int res) {
+    return res >= 0 && res < kTiers ? kPeriodUs[res] : 0;
+}
+
+const char* MotionHistory::resName(int res) {
+    static const char* names[] = {"1s", "10s", "1m"};
+    return res >= 0 && res < kTiers ? names[res] : "raw";
+}
+
+bool MotionHistory::parseRes(const std::string& s, int& res) {
+    if (s == "raw") res = -1;
+    else if (s == "1s") res = 0;
+    else if (s == "10s") res = 1;
+    else if (s == "1m") res = 2;
+    else if (s == "auto" || s.empty()) res = -2;
+    else return false;
+    return true;
+}
+
+uint64_t MotionHistory::latestUs() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return raw_count_ ? raw_[(raw_head_ + raw_.size() - 1) % raw_.size()].ts_us : 0;
+}
+
+uint64_t MotionHistory::oldest_us(int res) const {
+    if (res < 0)
+        return raw_count_ ? raw_[(raw_head_ + raw_.size() - raw_count_) % raw_.size()].ts_us : 0;
+    const Tier& tier = tiers_[res];
+    if (tier.count) return tier.ring[(tier.head + tier.ring.size() - tier.count) % tier.ring.size()].start_us;
+    return tier.has_open ? tier.open.start_us : 0;
+}
+
+int MotionHistory::pick(uint64_t from_us, uint64_t to_us, size_t max_rows) const {
+    std::lock_guard<std::mutex> lk(m_);
+    // Nothing is held before the first frame, or before the coarsest tier's
+    // oldest bucket once it has wrapped, so a window reaching further back
+    // is no reason to fall through to a coarser tier.
+    if (raw_count_) from_us = std::max(from_us, std::max(first_us_, oldest_us(kTiers - 1)));
+    for (int res = -1; res < kTiers - 1; res++) {
+        if (oldest_us(res) > from_us) continue; // does not reach back far enough
+        size_t rows = 0;
+        if (res < 0) {
+            for (size_t i = 0; i < raw_count_; i++) {
+                const uint64_t ts = raw_[(raw_head_ + raw_.size() - raw_count_ + i) % raw_.size()].ts_us;
+                rows += ts >= from_us && ts <= to_us;
+            }
+        } else {
+            rows = static_cast<size_t>((to_us - std::min(to_us, from_us)) / kPeriodUs[res]) + 1;
+        }
+        if (rows <= max_rows) return res;
+    }
+    return kTiers - 1;
+}
+
+void MotionHistory::query(uint64_t from_us, uint64_t to_us, int res, std::vector<Bucket>& out) const {
+    out.clear();
+    std::lock_guard<std::mutex> lk(m_);
+    if (res < 0) {
+        Bucket b;
+        for (size_t i = 0; i < raw_count_; i++) {
+            const Sample& s = raw_[(raw_head_ + raw_.size() - raw_count_ + i) % raw_.size()];
+            if (s.ts_us < from_us || s.ts_us > to_us) continue;
+            reset(b, s.ts_us);
+            for (int q = 0; q < 4; q++) {
+                if (!(s.valid & (1u << q))) continue;
+                b.n[q] = 1;
+                for (int c = 0; c < kChannels; c++) {
+                    b.min[q][c] = b.max[q][c] = s.v[q][c];
+                    b.sum[q][c] = s.v[q][c];
+                }
+            }
+            out.push_back(b);
+        }
+        return;
+    }
+    const Tier& tier = tiers_[res];
+    for (size_t i = 0; i < tier.count; i++) {
+        const Bucket& b = tier.ring[(tier.head + tier.ring.size() - tier.count + i) % tier.ring.size()];
+        if (b.start_us + tier.period_us > from_us && b.start_us <= to_us) out.push_back(b);
+    }
+    // open buckets: this tier's, then the newer data still in finer tiers
+    std::vector<Bucket> tail;
+    for (int t = res; t >= 0; t--) {
+        if (!tiers_[t].has_open) continue;
+        const uint64_t start = tiers_[t].open.start_us - tiers_[t].open.start_us % tier.period_us;
+        if (tail.empty() || tail.back().start_us != start) {
+            tail.emplace_back();
+            reset(tail.back(), start);
+        }
+        merge(tail.back(), tiers_[t].open);
+    }
+    for (const auto& b : tail)
+        if (b.start_us + tier.period_us > from_us && b.start_us <= to_us) out.push_back(b);
+}
+
+std::string MotionHistory::json(double from, double to, int res, size_t max_rows) const {
+    const uint64_t latest = latestUs();
+    auto resolve = [latest](double v, uint64_t dflt) -> uint64_t {
+        if (std::isnan(v)) return dflt;
+        if (v < 0) {
+            const double back = -v * 1e6;
+            return back >= static_cast<double>(latest) ? 0 : latest - static_cast<uint64_t>(back);
+        }
+        return static_cast<uint64_t>(v);
+    };
+    const uint64_t from_us = resolve(from, latest > 60000000ULL ? latest - 60000000ULL : 0);
+    const uint64_t to_us = resolve(to, latest);
+    max_rows = std::max<size_t>(1, max_rows);
+    if (res == -2) res = pick(from_us, to_us, max_rows);
+
+    std::vector<Bucket> rows;
+    query(from_us, to_us, res, rows);
+    const bool truncated = rows.size() > max_rows;
+    if (truncated) rows.erase(rows.begin(), rows.end() - static_cast<std::ptrdiff_t>(max_rows)); // keep the newest
+
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2);
+    os << "{\"res\":\"" << resName(res) << "\",\"period_us\":" << periodUs(res) << ",\"from_us\":" << from_us
+       << ",\"to_us\":" << to_us << ",\"truncated\":" << (truncated ? "true" : "false")
+       << ",\"channels\":[\"vx\",\"vy\",\"ax\",\"ay\"],\"rows\":[";
+    auto arr = [&os](const float* v) {
+        os << "[" << v[0] << "," << v[1] << "," << v[2] << "," << v[3] << "]";
+    };
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Bucket& b = rows[i];
+        os << (i ? "," : "") << "{\"t\":" << b.start_us << ",\"q\":[";
+        for (int q = 0; q < 4; q++) {
+            if (q) os << ",";
+            if (!b.n[q]) { os << "null"; continue; }
+            float mean[kChannels];
+            for (int c = 0; c < kChannels; c++) mean[c] = static_cast<float>(b.sum[q][c] / b.n[q]);
+            os << "{\"n\":" << b.n[q] << ",\"mean\":";
+            arr(mean);
+            if (res >= 0) {
+                os << ",\"min\":";
+                arr(b.min[q]);
+                os << ",\"max\":";
+                arr(b.max[q]);
+            }
+            os << "}";
+        }
+        os << "]}";
+    }
+    os << "]}";
+    return os.str();
+}
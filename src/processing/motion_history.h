@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "motion_types.h"
+
+// In-process history of per-quadrant velocity and acceleration for plotting,
+// in fixed memory: every frame for the last raw_seconds, then min/max/mean
+// rollups at 1 s, 10 s and 1 min, each in its own ring. A frame updates the
+// raw ring and the open 1 s bucket; a closing bucket is folded into the next
+// tier's open bucket, so the per-frame cost is constant. Written by the
+// process thread, queried from the HTTP thread under a short lock.
+class MotionHistory {
+public:
+    enum Channel { VX, VY, AX, AY, kChannels };
+    static constexpr int kTiers = 3; // 1 s, 10 s, 1 min
+
+    struct Config {
+        double raw_seconds = 60;
+        double max_fps = 120;         // sizes the raw ring (with 25% headroom)
+        int tier_buckets[kTiers] = {3600, 2160, 1440}; // 1 h, 6 h, 24 h
+    };
+
+    // One row of a query: a rollup bucket, or a single frame (min = max = mean).
+    struct Bucket {
+        uint64_t start_us = 0;
+        uint32_t n[4] = {};           // frames with the quadrant valid
+        float min[4][kChannels];
+        float max[4][kChannels];
+        double sum[4][kChannels];
+    };
+
+    MotionHistory();
+    explicit MotionHistory(const Config& cfg);
+
+    void push(const TrackerState& st, uint64_t ts_us);
+
+    // Resolution: -1 = raw frames, 0..2 = tiers; pick() chooses the finest
+    // one that still covers `from_us` in at most max_rows rows.
+    int pick(uint64_t from_us, uint64_t to_us, size_t max_rows) const;
+    // Rows overlapping [from_us, to_us], oldest first; the still-open
+    // bucket of a tier is included (with the open finer buckets folded in).
+    void query(uint64_t from_us, uint64_t to_us, int res, std::vector<Bucket>& out) const;
+    uint64_t latestUs() const;
+    static uint64_t periodUs(int res); // 0 for raw
+    static const char* resName(int res);
+    static bool parseRes(const std::string& s, int& res); // raw|1s|10s|1m|auto (auto = -2)
+
+    // JSON for the HTTP endpoint: from/to in µs on the frame clock, or
+    // seconds relative to the newest frame when negative.
+    std::string json(double from, double to, int res, size_t max_rows) const;
+
+private:
+    struct Sample {
+        uint64_t ts_us;
+        uint8_t valid;               // bit per quadrant
+        float v[4][kChannels];
+    };
+    struct Tier {
+        uint64_t period_us = 0;
+        std::vector<Bucket> ring;
+        size_t head = 0, count = 0;  // next write slot, filled slots
+        Bucket open;
+        bool has_open = false;
+    };
+
+    static void reset(Bucket& b, uint64_t start_us);
+    static void merge(Bucket& into, const Bucket& b);
+    void add_to_tier(int t, const Bucket& b);
+    uint64_t oldest_us(int res) const;
+
+    std::vector<Sample> raw_;
+    size_t raw_head_ = 0, raw_count_ = 0;
+    uint64_t first_us_ = 0;          // oldest frame since start or the last clock restart
+    Tier tiers_[kTiers];
+    Bucket frame_;                   // scratch: the current frame as a bucket
+    mutable std::mutex m_;
+};
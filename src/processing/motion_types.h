@@ -9,17 +9,50 @@ struct MotionState {
     uint64_t last_ts_us = 0;
 };
 
+// Smoothing parameters for update_motion (see tracker_params.h for loading).
+struct MotionParams {
+    double vel_alpha = 0.5;     // EMA factor for velocity (0..1)
+    double max_accel = 10000.0; // acceleration clamp (px/s^2)
+};
+
 struct QuadrantState {
-    MotionState motion;
+    MotionState motion;           // tracking space (see TrackerState)
+    cv::Point2f image_pos{0,0};   // last measured centre in raw image px, for drawing
     bool valid = false;
 };
 
+// Marker pose from the quadrant points (PoseEstimator). Camera frame, mm.
+struct PoseState {
+    bool valid = false;
+    cv::Vec3d rvec{0,0,0};        // Rodrigues rotation, marker -> camera
+    cv::Point3d t{0,0,0};         // marker centre (mm)
+    cv::Point3d vel{0,0,0};       // marker centre velocity (mm/s), EMA-smoothed
+    cv::Point3d q_vel[4];         // quadrant centre velocities (mm/s)
+    double reproj_px = 0;         // RMS reprojection error of the solve
+};
+
+// Image quality of the current frame (QualityGate); checked = false when
+// the gate is off or did not run on this frame.
+struct FrameQuality {
+    bool checked = false;
+    bool ok = true;               // false: detection and LK were skipped, the prediction carried
+    float sharpness = 0;          // Laplacian variance over the ROI
+    float clipped = 0;            // fraction of ROI pixels crushed or saturated
+    float mean = 0;               // mean grey level of the ROI
+};
+
+// Coordinate spaces: marker_bbox and q[].image_pos are raw image pixels.
+// q[].motion (pos, vel, acc) is in tracking space: undistorted pixels (same
+// camera matrix) when point-space undistortion is on, raw pixels otherwise;
+// everything exported (CSV, JSON, shm, history, spectrum) uses it. pose is
+// in the camera frame, mm.
 struct TrackerState {
     QuadrantState q[4];
+    PoseState pose;
+    FrameQuality quality;
     cv::Rect marker_bbox;
     int marker_id = -1;
     uint64_t last_saved_us = 0;
-    uint64_t last_live_us = 0; // last time a live snapshot was written
     uint64_t last_metrics_us = 0; // last time metrics were sent
     bool tracking = false;
 };
@@ -3,10 +3,11 @@
 
 inline void update_motion(MotionState& s,
                           const cv::Point2f& new_pos,
-                          uint64_t ts_us) {
-    // Parameters: simple exponential moving average (EMA) for velocity
-    constexpr double VEL_ALPHA = 0.5;        // smoothing factor (0..1)
-    constexpr double MAX_ACCEL = 10000.0;    // clamp acceleration (px/s^2)
+                          uint64_t ts_us,
+                          const MotionParams& p = MotionParams()) {
+    // simple exponential moving average (EMA) for velocity, clamped acceleration
+    const double VEL_ALPHA = p.vel_alpha;
+    const double MAX_ACCEL = p.max_accel;
 
     if (s.last_ts_us == 0) {
         s.pos = new_pos;
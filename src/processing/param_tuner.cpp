@@ -0,0 +1,279 @@
+#include "param_tuner.h"
+#include "aruco_tracker.h"
+#include "../pipeline/video_file_source.h"
+#include "../pipeline/image_sequence_source.h"
+
+#include <opencv2/aruco.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+bool load_tuner_clip(FrameSource& src, int max_frames, TunerClip& clip) {
+    auto dict = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    cv::Mat f;
+    uint64_t ts = 0;
+    while ((max_frames <= 0 || static_cast<int>(clip.frames.size()) < max_frames) && src.grab(f, ts)) {
+        std::vector<int> ids;
+        std::vector<std::vector<cv::Point2f>> corners;
+        cv::aruco::detectMarkers(f, dict, corners, ids);
+
+        // same seeds as ArucoTracker::quadrant_center
+        std::array<cv::Point2f, 4> ref{};
+        if (!ids.empty()) {
+            cv::Rect b = cv::boundingRect(corners[0]);
+            float cx = b.x + b.width * 0.5f, cy = b.y + b.height * 0.5f;
+            float dx = b.width * 0.25f, dy = b.height * 0.25f;
+            static const int sx[4] = {-1, 1, -1, 1};
+            static const int sy[4] = {-1, -1, 1, 1};
+            for (int i = 0; i < 4; i++) ref[i] = {cx + sx[i] * dx, cy + sy[i] * dy};
+        }
+        clip.frames.push_back(f.clone());
+        clip.ts.push_back(ts);
+        clip.ref.push_back(ref);
+        clip.ref_valid.push_back(ids.empty() ? 0 : 1);
+    }
+    clip.has_vel = false;
+    return !clip.frames.empty();
+}
+
+void make_synthetic_clip(const SyntheticSource::Config& cfg, int frames, TunerClip& clip) {
+    SyntheticSource::Config c = cfg;
+    c.frames = frames;
+    c.realtime = false;
+    SyntheticSource src(c);
+    if (!src.open()) return;
+    cv::Mat f;
+    uint64_t ts = 0;
+    while (src.grab(f, ts)) {
+        const auto& tr = src.truth();
+        std::array<cv::Point2f, 4> ref;
+        for (int i = 0; i < 4; i++) ref[i] = tr.quadrant[i];
+        clip.frames.push_back(f);
+        clip.ts.push_back(ts);
+        clip.ref.push_back(ref);
+        clip.ref_valid.push_back(1);
+        clip.ref_vel.push_back(tr.vel);
+    }
+    clip.has_vel = true;
+    clip.label = "synthetic";
+}
+
+TunerResult evaluate_params(const TunerClip& clip, const TrackerParams& p, int warmup_frames, double miss_px) {
+    ArucoTracker tracker(p);
+    tracker.setOptions({false, false, false});
+
+    std::vector<double> cost_ms;
+    cost_ms.reserve(clip.frames.size());
+    double err_sum = 0, vel_sq = 0;
+    long err_n = 0, vel_n = 0, ref_n = 0, lost_n = 0, miss_n = 0;
+
+    for (size_t k = 0; k < clip.frames.size(); k++) {
+        auto t0 = std::chrono::steady_clock::now();
+        tracker.process(clip.frames[k], clip.ts[k]);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        if (static_cast<int>(k) < warmup_frames) continue;
+        cost_ms.push_back(ms);
+
+        if (!clip.ref_valid[k]) continue;
+        ref_n++;
+        const TrackerState& st = tracker.state();
+        if (!st.tracking) { lost_n++; miss_n++; continue; }
+        bool missed = false;
+        for (int i = 0; i < 4; i++) {
+            if (!st.q[i].valid) continue;
+            cv::Point2f d = st.q[i].motion.pos - clip.ref[k][i];
+            double e = std::sqrt(d.x * d.x + d.y * d.y);
+            err_sum += e;
+            err_n++;
+            if (e > miss_px) missed = true;
+            if (clip.has_vel) {
+                cv::Point2f dv = st.q[i].motion.vel - clip.ref_vel[k];
+                vel_sq += dv.x * dv.x + dv.y * dv.y;
+                vel_n++;
+            }
+        }
+        if (missed) miss_n++;
+    }
+
+    TunerResult r;
+    r.params = p;
+    if (!cost_ms.empty()) {
+        double sum = 0;
+        for (double c : cost_ms) sum += c;
+        r.cost_ms_mean = sum / cost_ms.size();
+        std::vector<double> sorted = cost_ms;
+        size_t idx = static_cast<size_t>(0.95 * (sorted.size() - 1));
+        std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+        r.cost_ms_p95 = sorted[idx];
+    }
+    r.err_px = err_n ? err_sum / err_n : 1e9;
+    r.loss_rate = ref_n ? static_cast<double>(lost_n) / ref_n : 1.0;
+    r.miss_rate = ref_n ? static_cast<double>(miss_n) / ref_n : 1.0;
+    r.vel_err = vel_n ? std::sqrt(vel_sq / vel_n) : -1.0;
+    r.detections = tracker.detections();
+    return r;
+}
+
+std::vector<size_t> pareto_front(const std::vector<TunerResult>& results, double max_loss) {
+    std::vector<size_t> idx;
+    for (size_t i = 0; i < results.size(); i++)
+        if (results[i].loss_rate <= max_loss) idx.push_back(i);
+    std::sort(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+        if (results[a].cost_ms_mean != results[b].cost_ms_mean) return results[a].cost_ms_mean < results[b].cost_ms_mean;
+        return results[a].err_px < results[b].err_px;
+    });
+    std::vector<size_t> front;
+    double best_err = 1e300;
+    for (size_t i : idx) {
+        if (results[i].err_px < best_err) {
+            front.push_back(i);
+            best_err = results[i].err_px;
+        }
+    }
+    return front;
+}
+
+static void print_row(std::ostream& os, const TunerResult& r) {
+    os << std::setw(5) << r.params.lk_max_level << std::setw(5) << r.params.lk_win_size
+       << std::setw(6) << r.params.lk_iters << std::setw(9) << r.params.redetect_interval
+       << std::setw(7) << std::setprecision(2) << r.params.motion.vel_alpha
+       << std::setw(10) << std::setprecision(3) << r.cost_ms_mean
+       << std::setw(10) << r.cost_ms_p95
+       << std::setw(9) << r.err_px
+       << std::setw(8) << std::setprecision(4) << r.loss_rate
+       << std::setw(10) << std::setprecision(1) << r.vel_err
+       << std::setw(6) << r.detections << "\n";
+}
+
+static const char* kHeader = "  lvl  win iters redetect  alpha   cost_ms   p95_ms   err_px    loss   vel_err  dets\n";
+
+int tuner_main(int argc, char** argv) {
+    std::string source = "synthetic";
+    std::string source_path;
+    std::string params_path;
+    std::string out_path;
+    std::string report_path;
+    int frames = 600;
+    double max_loss = 0.01;
+    double err_tol = 0.25;
+    bool quick = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--source" && i+1<argc) source = argv[++i];
+        else if (a == "--source-path" && i+1<argc) source_path = argv[++i];
+        else if (a == "--params" && i+1<argc) params_path = argv[++i];
+        else if (a == "--tune-out" && i+1<argc) out_path = argv[++i];
+        else if (a == "--tune-report" && i+1<argc) report_path = argv[++i];
+        else if (a == "--tune-frames" && i+1<argc) frames = atoi(argv[++i]);
+        else if (a == "--tune-max-loss" && i+1<argc) max_loss = atof(argv[++i]);
+        else if (a == "--tune-err-tol" && i+1<argc) err_tol = atof(argv[++i]);
+        else if (a == "--tune-quick") quick = true;
+    }
+
+    TrackerParams base;
+    if (!params_path.empty() && !load_tracker_params(params_path, base))
+        std::cerr << "Tuner: could not read " << params_path << ", using defaults" << std::endl;
+
+    TunerClip clip;
+    if (source == "synthetic") {
+        make_synthetic_clip(SyntheticSource::Config(), frames, clip);
+    } else if (source == "video" || source == "sequence") {
+        if (source_path.empty()) { std::cerr << "--source-path required for " << source << "\n"; return -1; }
+        std::unique_ptr<FrameSource> src;
+        if (source == "video") src = std::make_unique<VideoFileSource>(source_path);
+        else src = std::make_unique<ImageSequenceSource>(source_path);
+        if (!src->open() || !load_tuner_clip(*src, frames, clip)) {
+            std::cerr << "Tuner: failed to load clip from " << source_path << std::endl;
+            return -1;
+        }
+        src->close();
+        clip.label = source_path;
+    } else {
+        std::cerr << "Tuner: --source must be synthetic, video or sequence" << std::endl;
+        return -1;
+    }
+    std::cout << "Tuner: " << clip.frames.size() << " frames from " << clip.label << std::endl;
+
+    TunerGrid grid;
+    if (quick) {
+        grid.lk_max_level = {1, 2};
+        grid.lk_win_size = {11, 15};
+        grid.lk_iters = {5, 10};
+        grid.redetect_interval = {20, 40};
+    }
+
+    // Pass 1: LK + cadence grid
+    std::vector<TunerResult> results;
+    std::cout << std::fixed << kHeader;
+    for (int lvl : grid.lk_max_level)
+        for (int win : grid.lk_win_size)
+            for (int it : grid.lk_iters)
+                for (int rd : grid.redetect_interval) {
+                    TrackerParams p = base;
+                    p.lk_max_level = lvl;
+                    p.lk_win_size = win;
+                    p.lk_iters = it;
+                    p.redetect_interval = rd;
+                    results.push_back(evaluate_params(clip, p));
+                    print_row(std::cout, results.back());
+                }
+
+    std::vector<size_t> front = pareto_front(results, max_loss);
+    if (front.empty()) {
+        std::cerr << "Tuner: no configuration kept loss <= " << max_loss << std::endl;
+        return 1;
+    }
+    for (size_t i : front) results[i].pareto = true;
+
+    std::cout << "\nPareto-optimal configurations (loss <= " << max_loss << "):\n" << kHeader;
+    double min_err = 1e300;
+    for (size_t i : front) {
+        print_row(std::cout, results[i]);
+        min_err = std::min(min_err, results[i].err_px);
+    }
+
+    // cheapest front member within err_tol of the most accurate one
+    size_t chosen = front.back();
+    for (size_t i : front)
+        if (results[i].err_px <= min_err * (1.0 + err_tol)) { chosen = i; break; }
+    TunerResult best = results[chosen];
+
+    // Pass 2: velocity smoothing only changes velocity error, so sweep it on the chosen setting
+    if (clip.has_vel) {
+        for (double a : grid.vel_alpha) {
+            TrackerParams p = best.params;
+            p.motion.vel_alpha = a;
+            TunerResult r = evaluate_params(clip, p);
+            if (r.loss_rate <= max_loss && r.vel_err >= 0 && r.vel_err < best.vel_err) best = r;
+        }
+    }
+
+    std::cout << "\nChosen configuration:\n" << kHeader;
+    print_row(std::cout, best);
+
+    if (!report_path.empty()) {
+        std::ofstream rep(report_path);
+        rep << "lk_max_level,lk_win_size,lk_iters,redetect_interval,vel_alpha,cost_ms_mean,cost_ms_p95,err_px,loss_rate,vel_err,detections,pareto\n";
+        rep << std::fixed << std::setprecision(4);
+        for (const auto& r : results)
+            rep << r.params.lk_max_level << "," << r.params.lk_win_size << "," << r.params.lk_iters << ","
+                << r.params.redetect_interval << "," << r.params.motion.vel_alpha << "," << r.cost_ms_mean << ","
+                << r.cost_ms_p95 << "," << r.err_px << "," << r.loss_rate << "," << r.vel_err << ","
+                << r.detections << "," << (r.pareto ? 1 : 0) << "\n";
+        std::cout << "Report written to " << report_path << std::endl;
+    }
+    if (!out_path.empty()) {
+        if (!save_tracker_params(out_path, best.params)) {
+            std::cerr << "Tuner: failed to write " << out_path << std::endl;
+            return 1;
+        }
+        std::cout << "Parameters written to " << out_path << " (load with --params)" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "tracker_params.h"
+#include "../pipeline/frame_source.h"
+#include "../pipeline/synthetic_source.h"
+
+#include <opencv2/core.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+// Offline parameter tuner: replays an in-memory clip through ArucoTracker for
+// every point of a parameter grid, measures per-frame cost and tracking error,
+// and reports the Pareto-optimal (cost, error) configurations.
+
+struct TunerClip {
+    std::vector<cv::Mat> frames;
+    std::vector<uint64_t> ts;
+    std::vector<std::array<cv::Point2f, 4>> ref;  // reference quadrant centres
+    std::vector<uint8_t> ref_valid;
+    std::vector<cv::Point2f> ref_vel;             // px/s, synthetic clips only
+    bool has_vel = false;
+    std::string label;
+};
+
+// Recorded clip: reference positions come from running the detector on every frame.
+bool load_tuner_clip(FrameSource& src, int max_frames, TunerClip& clip);
+// Synthetic clip: reference positions and velocities are exact.
+void make_synthetic_clip(const SyntheticSource::Config& cfg, int frames, TunerClip& clip);
+
+struct TunerGrid {
+    std::vector<int> lk_max_level{1, 2, 3};
+    std::vector<int> lk_win_size{9, 11, 15, 21};
+    std::vector<int> lk_iters{5, 10, 20};
+    std::vector<int> redetect_interval{10, 20, 40, 80};
+    std::vector<double> vel_alpha{0.3, 0.5, 0.7, 0.85};  // second pass, on the chosen LK setting
+};
+
+struct TunerResult {
+    TrackerParams params;
+    double cost_ms_mean = 0;
+    double cost_ms_p95 = 0;
+    double err_px = 0;       // mean position error over tracked quadrants
+    double loss_rate = 0;    // fraction of reference frames without tracking
+    double miss_rate = 0;    // ... or with a valid quadrant more than miss_px off
+    double vel_err = -1;     // RMS velocity error (px/s); -1 without reference
+    int detections = 0;
+    bool pareto = false;
+};
+
+// Replay the clip once with the given parameters.
+TunerResult evaluate_params(const TunerClip& clip, const TrackerParams& p, int warmup_frames = 10,
+                            double miss_px = 5.0);
+
+// Indices of non-dominated results (lower cost and lower error), sorted by cost.
+std::vector<size_t> pareto_front(const std::vector<TunerResult>& results, double max_loss);
+
+// Entry point for `jetson_motion_tracker --tune ...`.
+int tuner_main(int argc, char** argv);
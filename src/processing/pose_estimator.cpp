@@ -0,0 +1,163 @@
+#include "pose_estimator.h"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <cmath>
+#include <iostream>
+
+using namespace cv;
+
+CameraCalibration CameraCalibration::scaledTo(const Size& s) const {
+    CameraCalibration c;
+    c.K = K.clone();
+    c.dist = dist;
+    c.size = s;
+    if (size.area() > 0 && s.area() > 0 && s != size) {
+        const double sx = static_cast<double>(s.width) / size.width;
+        const double sy = static_cast<double>(s.height) / size.height;
+        c.K.at<double>(0, 0) *= sx;
+        c.K.at<double>(0, 2) *= sx;
+        c.K.at<double>(1, 1) *= sy;
+        c.K.at<double>(1, 2) *= sy;
+    }
+    return c;
+}
+
+bool load_camera_calibration(const std::string& path, CameraCalibration& c) {
+    try {
+        FileStorage fs(path, FileStorage::READ);
+        if (!fs.isOpened()) return false;
+        Mat K, dist;
+        fs["camera_matrix"] >> K;
+        if (K.empty()) fs["K"] >> K;
+        fs["distortion_coefficients"] >> dist;
+        if (dist.empty()) fs["dist_coeffs"] >> dist;
+        if (K.rows != 3 || K.cols != 3) {
+            std::cerr << "Calibration: " << path << " has no 3x3 camera_matrix" << std::endl;
+            return false;
+        }
+        K.convertTo(c.K, CV_64F);
+        if (!dist.empty()) dist.convertTo(c.dist, CV_64F);
+        else c.dist.release();
+        int w = 0, h = 0;
+        if (!fs["image_width"].empty()) fs["image_width"] >> w;
+        if (!fs["image_height"].empty()) fs["image_height"] >> h;
+        c.size = Size(w, h);
+    } catch (const cv::Exception& e) {
+        std::cerr << "Calibration: failed to parse " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PoseEstimator::setCalibration(const CameraCalibration& c) {
+    calib_ = c;
+    scaled_ = CameraCalibration();
+    reset();
+}
+
+void PoseEstimator::setMarker(const Point2f corners[4], const Point2f quad[4], double marker_mm) {
+    // marker plane, origin at the centre, y up (same convention as
+    // aruco::estimatePoseSingleMarkers)
+    const float h = static_cast<float>(marker_mm * 0.5);
+    const Point2f plane[4] = {{-h, h}, {h, h}, {h, -h}, {-h, -h}};
+    Mat H = getPerspectiveTransform(corners, plane);
+    std::vector<Point2f> q(quad, quad + 4), qp;
+    perspectiveTransform(q, qp, H);
+    obj_.resize(4);
+    for (int i = 0; i < 4; i++) obj_[i] = Point3f(qp[i].x, qp[i].y, 0.f);
+    // The quadrant points moved on the marker plane: re-express the previous
+    // quadrant centres with the new points at the last pose, so the next
+    // q_vel difference does not see the change of points as motion.
+    if (last_ts_us_ && !rvec_.empty()) {
+        Matx33d R;
+        Rodrigues(rvec_, R);
+        for (int i = 0; i < 4; i++) {
+            Vec3d x = R * Vec3d(obj_[i].x, obj_[i].y, obj_[i].z);
+            last_q_[i] = Point3d(x[0], x[1], x[2]) + last_t_;
+        }
+    }
+    have_marker_ = true;
+    have_pose_ = false; // a new detection starts from a cold solve
+}
+
+void PoseEstimator::reset() {
+    have_marker_ = false;
+    have_pose_ = false;
+    last_ts_us_ = 0;
+}
+
+double PoseEstimator::reprojection(const Mat& rvec, const Mat& tvec) {
+    projectPoints(obj_, rvec, tvec, scaled_.K, scaled_.dist, proj_);
+    double e = 0;
+    for (size_t i = 0; i < proj_.size(); i++) {
+        Point2f d = proj_[i] - img_[i];
+        e += d.x * d.x + d.y * d.y;
+    }
+    return std::sqrt(e / std::max<size_t>(1, proj_.size()));
+}
+
+bool PoseEstimator::update(const Point2f quad[4], const Size& frame_size, uint64_t ts_us,
+                           const PoseParams& p, PoseState& out) {
+    out.valid = false;
+    if (!calib_.valid() || !have_marker_) return false;
+    if (scaled_.size != frame_size) scaled_ = calib_.scaledTo(frame_size);
+    img_.assign(quad, quad + 4);
+
+    // Warm: a few LM steps from the last pose. Frame-to-frame motion is
+    // small, so this converges in 1-2 iterations where a cold solve needs a
+    // homography initialisation plus a full LM run.
+    bool ok = false;
+    last_warm_ = false;
+    double err = 0;
+    if (p.warm_start && have_pose_) {
+        solvePnPRefineLM(obj_, img_, scaled_.K, scaled_.dist, rvec_, tvec_,
+                         TermCriteria(TermCriteria::COUNT | TermCriteria::EPS, std::max(1, p.refine_iters), 1e-6));
+        err = reprojection(rvec_, tvec_);
+        ok = err <= p.max_reproj_px;
+        if (ok) { stats_.warm++; last_warm_ = true; }
+    }
+    if (!ok) {
+        solvePnP(obj_, img_, scaled_.K, scaled_.dist, rvec_, tvec_, false, SOLVEPNP_ITERATIVE);
+        err = reprojection(rvec_, tvec_);
+        stats_.cold++;
+    }
+    if (tvec_.empty() || tvec_.at<double>(2) <= 0 || !std::isfinite(err)) {
+        stats_.failed++;
+        have_pose_ = false;
+        last_ts_us_ = 0;
+        return false;
+    }
+    have_pose_ = true;
+
+    Matx33d R;
+    Rodrigues(rvec_, R);
+    const Point3d t(tvec_.at<double>(0), tvec_.at<double>(1), tvec_.at<double>(2));
+    Point3d qc[4];
+    for (int i = 0; i < 4; i++) {
+        Vec3d x = R * Vec3d(obj_[i].x, obj_[i].y, obj_[i].z);
+        qc[i] = Point3d(x[0], x[1], x[2]) + t;
+    }
+
+    // EMA of finite differences, restarted after a gap in valid solves
+    const double dt = last_ts_us_ && ts_us > last_ts_us_ ? (ts_us - last_ts_us_) * 1e-6 : 0;
+    if (dt > 0) {
+        const double a = p.vel_alpha;
+        out.vel = a * (t - last_t_) * (1.0 / dt) + (1 - a) * out.vel;
+        for (int i = 0; i < 4; i++)
+            out.q_vel[i] = a * (qc[i] - last_q_[i]) * (1.0 / dt) + (1 - a) * out.q_vel[i];
+    } else {
+        out.vel = Point3d();
+        for (auto& v : out.q_vel) v = Point3d();
+    }
+    last_ts_us_ = ts_us;
+    last_t_ = t;
+    for (int i = 0; i < 4; i++) last_q_[i] = qc[i];
+
+    out.rvec = Vec3d(rvec_.at<double>(0), rvec_.at<double>(1), rvec_.at<double>(2));
+    out.t = t;
+    out.reproj_px = err;
+    out.valid = true;
+    return true;
+}
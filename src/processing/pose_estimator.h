@@ -0,0 +1,79 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include "motion_types.h"
+
+struct PoseParams {
+    bool enabled = false;
+    double marker_mm = 50.0;    // printed marker side length
+    bool warm_start = true;     // refine from the previous frame's pose
+    int refine_iters = 3;       // LM iteration cap for a warm refine
+    double max_reproj_px = 2.0; // warm results worse than this fall back to a cold solve
+    double vel_alpha = 0.5;     // EMA factor for the metric velocities
+};
+
+// Intrinsics from an OpenCV calibration file (camera_matrix /
+// distortion_coefficients, as written by the calibration samples).
+// image_width/image_height, when present, let K follow a different capture
+// resolution with the same aspect ratio.
+struct CameraCalibration {
+    cv::Mat K;       // 3x3 CV_64F
+    cv::Mat dist;    // distortion coefficients, CV_64F; empty = none
+    cv::Size size;   // calibrated resolution; 0x0 = unknown
+
+    bool valid() const { return !K.empty(); }
+    CameraCalibration scaledTo(const cv::Size& s) const;
+};
+
+bool load_camera_calibration(const std::string& path, CameraCalibration& c);
+
+// 6-DOF marker pose from the four tracked quadrant points. Their positions
+// on the marker plane are fixed at each detection (through the detected
+// corners), so the same solve works for LK and homography tracking. Each
+// frame refines the previous pose with a few LM iterations; a cold
+// iterative solve runs after a detection, when the warm result does not fit,
+// or always with warm_start off.
+class PoseEstimator {
+public:
+    struct Stats {
+        uint64_t warm = 0;     // accepted warm refines
+        uint64_t cold = 0;     // cold solves
+        uint64_t failed = 0;   // solves rejected (behind the camera / bad fit)
+    };
+
+    void setCalibration(const CameraCalibration& c);
+    bool hasCalibration() const { return calib_.valid(); }
+
+    // New detection: `corners` in aruco order (TL, TR, BR, BL), `quad` the
+    // image positions the quadrants will be tracked from.
+    void setMarker(const cv::Point2f corners[4], const cv::Point2f quad[4], double marker_mm);
+    void reset();
+
+    // Solve for the current quadrant positions; fills `out` (velocities are
+    // EMA-smoothed over successive valid solves). Returns out.valid.
+    bool update(const cv::Point2f quad[4], const cv::Size& frame_size, uint64_t ts_us,
+                const PoseParams& p, PoseState& out);
+
+    const Stats& stats() const { return stats_; }
+    bool lastWarm() const { return last_warm_; }
+
+private:
+    double reprojection(const cv::Mat& rvec, const cv::Mat& tvec);
+
+    CameraCalibration calib_;
+    CameraCalibration scaled_;    // calib_ at the current frame size
+    std::vector<cv::Point3f> obj_;
+    std::vector<cv::Point2f> img_, proj_;
+    cv::Mat rvec_, tvec_;
+    bool have_marker_ = false;
+    bool have_pose_ = false;
+    bool last_warm_ = false;
+
+    uint64_t last_ts_us_ = 0;
+    cv::Point3d last_t_, last_q_[4];
+    Stats stats_;
+};
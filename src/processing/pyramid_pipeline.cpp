@@ -0,0 +1,145 @@
+#include "pyramid_pipeline.h"
+#include "../util/thread_topology.h"
+
+#include <opencv2/video.hpp>
+
+#include <algorithm>
+#include <string>
+
+void build_lk_pyramid(const cv::Mat& grey, FramePyramid& out, const cv::Size& win, int max_level) {
+    // buildOpticalFlowPyramid re-creates a level only when its size changes
+    cv::buildOpticalFlowPyramid(grey, out.levels, win, max_level, true);
+    out.win = win;
+    out.max_level = max_level;
+}
+
+PyramidPool::PyramidPool(size_t capacity) : s_(std::make_shared<Shared>()) {
+    s_->capacity = capacity;
+}
+
+PyramidPtr PyramidPool::acquire() {
+    std::unique_ptr<FramePyramid> p;
+    {
+        std::lock_guard<std::mutex> lk(s_->m);
+        if (!s_->free.empty()) {
+            p = std::move(s_->free.back());
+            s_->free.pop_back();
+        } else {
+            s_->allocated++;
+        }
+    }
+    if (!p) p.reset(new FramePyramid);
+    std::shared_ptr<Shared> s = s_;
+    return PyramidPtr(p.release(), [s](FramePyramid* f) {
+        std::unique_ptr<FramePyramid> own(f);
+        std::lock_guard<std::mutex> lk(s->m);
+        if (s->free.size() < s->capacity) s->free.push_back(std::move(own));
+    });
+}
+
+uint64_t PyramidPool::allocated() const {
+    std::lock_guard<std::mutex> lk(s_->m);
+    return s_->allocated;
+}
+
+// in flight + the tracker's current and previous pyramid + one being released
+PyramidPipeline::PyramidPipeline(const Config& cfg)
+    : depth_(std::max(1, cfg.depth)),
+      pool_(static_cast<size_t>(std::max(1, cfg.depth)) + 3),
+      ring_(static_cast<size_t>(depth_)),
+      win_size_(cfg.win_size),
+      max_level_(cfg.max_level) {
+    for (int i = 0; i < std::max(1, cfg.workers); i++)
+        workers_.emplace_back([this, i]{ worker(i); });
+}
+
+PyramidPipeline::~PyramidPipeline() {
+    close();
+    for (auto& t : workers_) t.join();
+}
+
+bool PyramidPipeline::push(const cv::Mat& frame, uint64_t ts_us) {
+    std::unique_lock<std::mutex> lk(m_);
+    space_cv_.wait(lk, [&]{ return closed_ || next_push_ - next_pop_ < static_cast<uint64_t>(depth_); });
+    if (closed_) return false;
+    const uint64_t seq = next_push_++;
+    Slot& s = ring_[seq % depth_];
+    s.item.frame = frame;
+    s.item.ts_us = ts_us;
+    s.item.pyr.reset();
+    s.ready = false;
+    jobs_.push_back(seq);
+    lk.unlock();
+    work_cv_.notify_one();
+    return true;
+}
+
+bool PyramidPipeline::pop(Item& out) {
+    std::unique_lock<std::mutex> lk(m_);
+    ready_cv_.wait(lk, [&]{
+        return (next_pop_ < next_push_ && ring_[next_pop_ % depth_].ready) || (closed_ && next_pop_ == next_push_);
+    });
+    if (next_pop_ == next_push_) return false;
+    Slot& s = ring_[next_pop_ % depth_];
+    out = std::move(s.item);
+    s.item = Item();
+    s.ready = false;
+    next_pop_++;
+    lk.unlock();
+    space_cv_.notify_one();
+    return true;
+}
+
+void PyramidPipeline::close() {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        closed_ = true;
+    }
+    work_cv_.notify_all();
+    ready_cv_.notify_all();
+    space_cv_.notify_all();
+}
+
+void PyramidPipeline::setGeometry(int win_size, int max_level) {
+    win_size_.store(win_size, std::memory_order_relaxed);
+    max_level_.store(max_level, std::memory_order_relaxed);
+}
+
+PyramidPipeline::Stats PyramidPipeline::stats() const {
+    Stats st;
+    std::lock_guard<std::mutex> lk(m_);
+    st.built = built_;
+    st.reordered = reordered_;
+    st.in_flight = static_cast<int>(next_push_ - next_pop_);
+    st.pool_allocated = pool_.allocated();
+    return st;
+}
+
+void PyramidPipeline::worker(int index) {
+    ThreadTopology::instance().applyToCurrentThread("pyramid", "pyramid:" + std::to_string(index));
+    for (;;) {
+        uint64_t seq;
+        cv::Mat frame;
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            work_cv_.wait(lk, [&]{ return closed_ || !jobs_.empty(); });
+            if (jobs_.empty()) return; // closed; pop() drains the rest
+            seq = jobs_.front();
+            jobs_.pop_front();
+            frame = ring_[seq % depth_].item.frame;
+        }
+        PyramidPtr pyr = pool_.acquire();
+        const int win = win_size_.load(std::memory_order_relaxed);
+        build_lk_pyramid(frame, *pyr, cv::Size(win, win), max_level_.load(std::memory_order_relaxed));
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            Slot& s = ring_[seq % depth_];
+            s.item.pyr = std::move(pyr);
+            s.ready = true;
+            built_++;
+            for (uint64_t k = next_pop_; k < seq; k++)
+                if (!ring_[k % depth_].ready) { reordered_++; break; }
+        }
+        ready_cv_.notify_one();
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// LK pyramid of one frame: the levels interleaved with their Scharr
+// derivatives, as cv::buildOpticalFlowPyramid(withDerivatives) lays them out
+// and cv::calcOpticalFlowPyrLK takes them, so LK itself does no image work.
+struct FramePyramid {
+    std::vector<cv::Mat> levels;
+    cv::Size win;        // window it was padded for
+    int max_level = -1;  // requested top level (the image may support fewer)
+
+    bool matches(const cv::Size& w, int level) const { return !levels.empty() && win == w && max_level == level; }
+};
+using PyramidPtr = std::shared_ptr<FramePyramid>;
+
+// Build into `out`, reusing its buffers when the frame size is unchanged.
+void build_lk_pyramid(const cv::Mat& grey, FramePyramid& out, const cv::Size& win, int max_level);
+
+// Recycles pyramid buffers between frames. A buffer goes back to the pool
+// when its last PyramidPtr is dropped, so it can be handed between threads
+// (worker -> reorder buffer -> tracker, which keeps it as the previous frame)
+// without copies. Steady state allocates nothing. Thread-safe.
+class PyramidPool {
+public:
+    explicit PyramidPool(size_t capacity = 8);
+
+    PyramidPtr acquire();
+    uint64_t allocated() const; // buffers created so far (steady state: constant)
+
+private:
+    struct Shared {
+        std::mutex m;
+        std::vector<std::unique_ptr<FramePyramid>> free;
+        size_t capacity;
+        uint64_t allocated = 0;
+    };
+    std::shared_ptr<Shared> s_; // outlives the pool while buffers are out
+};
+
+// Builds pyramids for upcoming frames on worker threads while the tracker
+// consumes them strictly in submission order. LK has to run frame by frame,
+// but frame N+1's pyramid does not depend on frame N's result, so with K
+// workers the pyramid stage sustains up to K times the single-thread rate.
+// Completed frames wait in a reorder ring of `depth` slots until every
+// earlier frame is out; push() blocks while `depth` frames are in flight.
+// One producer thread and one consumer thread.
+class PyramidPipeline {
+public:
+    struct Config {
+        int workers = 2;
+        int depth = 4;      // frames in flight (pushed, not yet popped)
+        int win_size = 15;  // must match the tracker's LK window and level
+        int max_level = 2;
+    };
+
+    struct Item {
+        cv::Mat frame;
+        uint64_t ts_us = 0;
+        PyramidPtr pyr;
+    };
+
+    struct Stats {
+        uint64_t built = 0;
+        uint64_t reordered = 0;   // finished while an earlier frame was still building
+        uint64_t pool_allocated = 0;
+        int in_flight = 0;
+    };
+
+    explicit PyramidPipeline(const Config& cfg);
+    ~PyramidPipeline();
+    PyramidPipeline(const PyramidPipeline&) = delete;
+    PyramidPipeline& operator=(const PyramidPipeline&) = delete;
+
+    // Producer. False once closed.
+    bool push(const cv::Mat& frame, uint64_t ts_us);
+    // Consumer: the next frame in push order with its pyramid. False once
+    // closed and drained.
+    bool pop(Item& out);
+    // No more pushes; pop() drains what is in flight.
+    void close();
+
+    // Window/levels for pyramids started from now on (live parameter change);
+    // the tracker rebuilds any pyramid that no longer matches.
+    void setGeometry(int win_size, int max_level);
+    Stats stats() const;
+
+private:
+    struct Slot {
+        Item item;
+        bool ready = false;
+    };
+
+    void worker(int index);
+
+    const int depth_;
+    PyramidPool pool_;
+    std::vector<Slot> ring_;          // seq % depth_
+    std::deque<uint64_t> jobs_;
+    uint64_t next_push_ = 0, next_pop_ = 0;
+    bool closed_ = false;
+    mutable std::mutex m_;
+    std::condition_variable work_cv_, ready_cv_, space_cv_;
+    std::atomic<int> win_size_, max_level_;
+    uint64_t built_ = 0, reordered_ = 0;
+    std::vector<std::thread> workers_;
+};
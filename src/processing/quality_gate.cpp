@@ -0,0 +1,170 @@
+#include "quality_gate.h"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr int kBaselineFrames = 5;   // accepted frames before blur can be judged
+constexpr double kBaselineAlpha = 0.05;
+
+} // namespace
+
+void QualityGate::laplacian_moments(const uint8_t* up, const uint8_t* row, const uint8_t* down, size_t n,
+                                    int64_t& sum, uint64_t& sumsq) {
+    sum = 0;
+    sumsq = 0;
+    if (n < 3) return;
+    size_t x = 1;
+    // |lap| <= 1020, so lap fits int16 and lap^2 pairs fit int32 per lane
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int32x4_t acc_s = vdupq_n_s32(0);
+    uint64x2_t acc_q = vdupq_n_u64(0);
+    for (; x + 17 <= n; x += 16) {
+        uint8x16_t c = vld1q_u8(row + x), l = vld1q_u8(row + x - 1), r = vld1q_u8(row + x + 1);
+        uint8x16_t u = vld1q_u8(up + x), d = vld1q_u8(down + x);
+        for (int h = 0; h < 2; h++) {
+            uint8x8_t c8 = h ? vget_high_u8(c) : vget_low_u8(c);
+            // 4c - (l + r + u + d), computed in u16 then reinterpreted
+            uint16x8_t nb = vaddl_u8(h ? vget_high_u8(l) : vget_low_u8(l), h ? vget_high_u8(r) : vget_low_u8(r));
+            nb = vaddw_u8(nb, h ? vget_high_u8(u) : vget_low_u8(u));
+            nb = vaddw_u8(nb, h ? vget_high_u8(d) : vget_low_u8(d));
+            int16x8_t lap = vsubq_s16(vreinterpretq_s16_u16(vshll_n_u8(c8, 2)), vreinterpretq_s16_u16(nb));
+            acc_s = vpadalq_s16(acc_s, lap);
+            int32x4_t q0 = vmull_s16(vget_low_s16(lap), vget_low_s16(lap));
+            int32x4_t q1 = vmull_s16(vget_high_s16(lap), vget_high_s16(lap));
+            acc_q = vpadalq_u32(acc_q, vreinterpretq_u32_s32(q0));
+            acc_q = vpadalq_u32(acc_q, vreinterpretq_u32_s32(q1));
+        }
+    }
+    sum = static_cast<int64_t>(vgetq_lane_s32(acc_s, 0)) + vgetq_lane_s32(acc_s, 1) +
+          vgetq_lane_s32(acc_s, 2) + vgetq_lane_s32(acc_s, 3);
+    sumsq = vgetq_lane_u64(acc_q, 0) + vgetq_lane_u64(acc_q, 1);
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc_s = zero, acc_q = zero;
+    for (; x + 17 <= n; x += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - 1));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 1));
+        __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + x));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + x));
+        for (int h = 0; h < 2; h++) {
+            auto wide = [&](__m128i v) { return h ? _mm_unpackhi_epi8(v, zero) : _mm_unpacklo_epi8(v, zero); };
+            __m128i nb = _mm_add_epi16(_mm_add_epi16(wide(l), wide(r)), _mm_add_epi16(wide(u), wide(d)));
+            __m128i lap = _mm_sub_epi16(_mm_slli_epi16(wide(c), 2), nb);
+            acc_s = _mm_add_epi32(acc_s, _mm_madd_epi16(lap, _mm_set1_epi16(1)));
+            __m128i q = _mm_madd_epi16(lap, lap); // non-negative, so zero-extend to 64 bit
+            acc_q = _mm_add_epi64(acc_q, _mm_add_epi64(_mm_unpacklo_epi32(q, zero), _mm_unpackhi_epi32(q, zero)));
+        }
+    }
+    alignas(16) int32_t s[4];
+    alignas(16) uint64_t q[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(s), acc_s);
+    _mm_store_si128(reinterpret_cast<__m128i*>(q), acc_q);
+    sum = static_cast<int64_t>(s[0]) + s[1] + s[2] + s[3];
+    sumsq = q[0] + q[1];
+#endif
+    for (; x + 1 < n; x++) {
+        const int lap = 4 * row[x] - row[x - 1] - row[x + 1] - up[x] - down[x];
+        sum += lap;
+        sumsq += static_cast<uint64_t>(lap * lap);
+    }
+}
+
+void QualityGate::reset() {
+    base_[0] = base_[1] = Baseline();
+    rejected_run_ = 0;
+}
+
+cv::Rect QualityGate::sampleRect(const cv::Mat& frame, const cv::Rect& roi) const {
+    cv::Rect full(0, 0, frame.cols, frame.rows);
+    if (roi.area() <= 0) return full;
+    cv::Rect r(roi.x - p_.margin_px, roi.y - p_.margin_px, roi.width + 2 * p_.margin_px, roi.height + 2 * p_.margin_px);
+    r &= full;
+    return r.area() > 0 ? r : full;
+}
+
+bool QualityGate::check(const cv::Mat& frame, const cv::Rect& roi, FrameQuality& out) {
+    out = FrameQuality();
+    if (!p_.enabled || frame.type() != CV_8UC1 || frame.rows < 3 || frame.cols < 3) return true;
+
+    // Laplacian rows need a neighbour above and below
+    const cv::Rect r = sampleRect(frame, roi) & cv::Rect(0, 1, frame.cols, frame.rows - 2);
+    if (r.area() <= 0) return true;
+    const int step = std::max(1, p_.decimation);
+    const size_t w = static_cast<size_t>(r.width);
+
+    // the histogram only needs its tails, but the four interleaved tables keep
+    // successive increments of the same bin from serialising on one counter
+    uint32_t hist[4][256] = {};
+    int64_t s_sum = 0;
+    uint64_t s_sq = 0, n_lap = 0, n_px = 0;
+    for (int y = r.y; y < r.y + r.height; y += step) {
+        const uint8_t* row = frame.ptr<uint8_t>(y) + r.x;
+        // extend one pixel left/right when the frame allows, so the whole ROI width is measured
+        const int x0 = r.x > 0 ? r.x - 1 : r.x;
+        const int x1 = std::min(frame.cols, r.x + r.width + 1);
+        int64_t ls;
+        uint64_t lq;
+        laplacian_moments(frame.ptr<uint8_t>(y - 1) + x0, frame.ptr<uint8_t>(y) + x0, frame.ptr<uint8_t>(y + 1) + x0,
+                          static_cast<size_t>(x1 - x0), ls, lq);
+        s_sum += ls;
+        s_sq += lq;
+        n_lap += static_cast<uint64_t>(x1 - x0 - 2);
+        size_t x = 0;
+        for (; x + 4 <= w; x += 4) {
+            hist[0][row[x]]++;
+            hist[1][row[x + 1]]++;
+            hist[2][row[x + 2]]++;
+            hist[3][row[x + 3]]++;
+        }
+        for (; x < w; x++) hist[0][row[x]]++;
+        n_px += w;
+    }
+    if (!n_lap || !n_px) return true;
+
+    uint64_t dark = 0, sat = 0, lum = 0;
+    for (int v = 0; v < 256; v++) {
+        const uint64_t c = uint64_t(hist[0][v]) + hist[1][v] + hist[2][v] + hist[3][v];
+        if (v <= p_.dark_level) dark += c;
+        if (v >= p_.sat_level) sat += c;
+        lum += c * static_cast<uint64_t>(v);
+    }
+    const double mean_lap = static_cast<double>(s_sum) / n_lap;
+    out.checked = true;
+    out.sharpness = static_cast<float>(static_cast<double>(s_sq) / n_lap - mean_lap * mean_lap);
+    out.clipped = static_cast<float>(static_cast<double>(dark + sat) / n_px);
+    out.mean = static_cast<float>(static_cast<double>(lum) / n_px);
+    stats_.checked++;
+
+    Baseline& b = base_[roi.area() > 0 ? 1 : 0];
+    const bool exposure_bad = out.clipped > p_.max_clipped;
+    const bool blurry = out.sharpness < p_.min_sharpness ||
+                        (b.n >= kBaselineFrames && out.sharpness < p_.blur_ratio * b.value);
+    out.ok = !exposure_bad && !blurry;
+    if (exposure_bad) stats_.exposure++;
+    else if (blurry) stats_.blurry++;
+
+    if (out.ok) {
+        rejected_run_ = 0;
+        b.value = b.n ? (1 - kBaselineAlpha) * b.value + kBaselineAlpha * out.sharpness : out.sharpness;
+        b.n++;
+        return true;
+    }
+    if (++rejected_run_ > p_.max_skip) {
+        // a long bad run may be a new scene (focus, lighting): process and relearn
+        // (ok = processed, per FrameQuality; stats_.forced still counts it)
+        stats_.forced++;
+        rejected_run_ = 0;
+        b = Baseline();
+        out.ok = true;
+        return true;
+    }
+    return false;
+}
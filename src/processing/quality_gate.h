@@ -0,0 +1,65 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+
+#include "motion_types.h"
+
+struct QualityGateParams {
+    bool enabled = false;
+    int decimation = 4;          // measure every Nth row of the ROI
+    int margin_px = 16;          // ROI = marker bbox grown by this much (whole frame when not tracking)
+    double blur_ratio = 0.35;    // blurry below this fraction of the running sharpness baseline
+    double min_sharpness = 0;    // absolute Laplacian-variance floor (0 = baseline only)
+    double max_clipped = 0.25;   // badly exposed above this fraction of crushed or saturated pixels
+    int dark_level = 8;          // grey levels <= this count as crushed
+    int sat_level = 247;         // grey levels >= this count as saturated
+    int max_skip = 30;           // process anyway after this many consecutive rejections
+};
+
+// Per-frame image quality estimate ahead of detection and LK. Sharpness is
+// the variance of the 4-neighbour Laplacian over the ROI (SIMD kernel),
+// exposure the share of the ROI histogram in its crushed and saturated
+// tails. Sharpness depends on the scene, so a frame counts as blurry
+// relative to a running baseline of accepted frames; separate baselines are
+// kept for the marker ROI and for the whole frame (search mode).
+class QualityGate {
+public:
+    struct Stats {
+        uint64_t checked = 0;
+        uint64_t blurry = 0;
+        uint64_t exposure = 0;
+        uint64_t forced = 0;     // rejected but processed anyway (max_skip)
+    };
+
+    explicit QualityGate(const QualityGateParams& p = QualityGateParams()) : p_(p) {}
+
+    void setParams(const QualityGateParams& p) { p_ = p; reset(); }
+    const QualityGateParams& params() const { return p_; }
+    void reset();
+
+    // Measure `frame` inside `roi` into `out`. True when the frame should go
+    // through detection / LK; false when it should be skipped.
+    bool check(const cv::Mat& frame, const cv::Rect& roi, FrameQuality& out);
+
+    const Stats& stats() const { return stats_; }
+
+    // Sum and sum of squares of the 4-neighbour Laplacian at row[1..n-2]
+    // (NEON / SSE2 / scalar). up and down are the rows above and below.
+    static void laplacian_moments(const uint8_t* up, const uint8_t* row, const uint8_t* down, size_t n,
+                                  int64_t& sum, uint64_t& sumsq);
+
+private:
+    cv::Rect sampleRect(const cv::Mat& frame, const cv::Rect& roi) const;
+
+    struct Baseline {
+        double value = 0;
+        int n = 0;
+    };
+
+    QualityGateParams p_;
+    Baseline base_[2];           // [0] whole frame, [1] marker ROI
+    int rejected_run_ = 0;
+    Stats stats_;
+};
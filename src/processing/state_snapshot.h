@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "motion_types.h"
+#include "vibration_spectrum.h"
+
+// What a frame consumer needs to draw the tracker's view of the scene.
+struct OverlayState {
+    TrackerState st;
+    std::array<std::string, 4> vib; // spectrum labels per quadrant (may be empty)
+    uint64_t ts_us = 0;             // timestamp of the frame the state belongs to
+    uint64_t version = 0;           // bumps on every publish
+};
+
+// Latest tracker state for display-rate consumers on other threads.
+// Written once per processed frame by the processing thread; readers copy
+// it out under a short lock and draw without touching the tracker.
+class StateSnapshot {
+public:
+    void publish(const TrackerState& st, const VibrationSpectrum* spectrum, uint64_t ts_us) {
+        std::lock_guard<std::mutex> lk(m_);
+        s_.st = st;
+        for (int i = 0; i < 4; i++) s_.vib[i] = spectrum ? spectrum->label(i) : std::string();
+        s_.ts_us = ts_us;
+        s_.version++;
+    }
+
+    OverlayState get() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return s_;
+    }
+
+private:
+    mutable std::mutex m_;
+    OverlayState s_;
+};
@@ -0,0 +1,85 @@
+#include "tiled_detector.h"
+
+#include <cmath>
+
+using namespace cv;
+
+std::vector<Rect> TiledDetector::makeTiles(const Size& size, const TileDetectParams& p) {
+    const int cols = std::max(1, p.cols), rows = std::max(1, p.rows);
+    const int half = std::max(0, p.overlap_px) / 2;
+    const Rect full(0, 0, size.width, size.height);
+    std::vector<Rect> out;
+    for (int r = 0; r < rows; r++)
+        for (int c = 0; c < cols; c++) {
+            // even split, then grown by half the overlap on each inner edge
+            int x0 = size.width * c / cols, x1 = size.width * (c + 1) / cols;
+            int y0 = size.height * r / rows, y1 = size.height * (r + 1) / rows;
+            Rect t(x0 - half, y0 - half, x1 - x0 + 2 * half, y1 - y0 + 2 * half);
+            out.push_back(t & full);
+        }
+    return out;
+}
+
+void TiledDetector::detect(const Mat& frame, const Ptr<aruco::Dictionary>& dict, const TileDetectParams& p,
+                           std::vector<std::vector<Point2f>>& corners, std::vector<int>& ids) {
+    corners.clear();
+    ids.clear();
+    if (frame.size() != tiles_for_ || p.cols != tiles_cols_ || p.rows != tiles_rows_ || p.overlap_px != tiles_overlap_) {
+        tiles_ = makeTiles(frame.size(), p);
+        tiles_for_ = frame.size();
+        tiles_cols_ = p.cols;
+        tiles_rows_ = p.rows;
+        tiles_overlap_ = p.overlap_px;
+        results_.resize(tiles_.size());
+        // the default perimeter limits are relative to the image: keep the
+        // minimum relative to the full frame, not to a (smaller) tile
+        det_params_ = aruco::DetectorParameters::create();
+        const double full = std::max(frame.cols, frame.rows);
+        det_params_->minMarkerPerimeterRate *= full / std::max(1, std::max(tiles_[0].width, tiles_[0].height));
+    }
+    const int want = p.threads > 0 ? p.threads : static_cast<int>(tiles_.size()) - 1;
+    if (want != pool_threads_) {
+        pool_ = std::make_unique<WorkStealingPool>(want, "detect");
+        pool_threads_ = want;
+    }
+
+    pool_->run(static_cast<int>(tiles_.size()), [&](int i) {
+        TileResult& r = results_[static_cast<size_t>(i)];
+        r.corners.clear();
+        r.ids.clear();
+        aruco::detectMarkers(frame(tiles_[static_cast<size_t>(i)]), dict, r.corners, r.ids, det_params_);
+        const Point2f off(static_cast<float>(tiles_[static_cast<size_t>(i)].x),
+                          static_cast<float>(tiles_[static_cast<size_t>(i)].y));
+        for (auto& q : r.corners)
+            for (auto& c : q) c += off;
+    });
+
+    // Merge duplicates from overlapping tiles: same id, centres closer than a
+    // quarter of the marker side. Corner order is the marker's own, so the
+    // corners of duplicates correspond one to one.
+    std::vector<int> count;
+    std::vector<Point2f> centre;
+    for (const auto& r : results_) {
+        for (size_t k = 0; k < r.ids.size(); k++) {
+            stats_.raw++;
+            const auto& q = r.corners[k];
+            Point2f c = (q[0] + q[1] + q[2] + q[3]) * 0.25f;
+            const float side = static_cast<float>(norm(q[1] - q[0]));
+            size_t m = 0;
+            for (; m < ids.size(); m++)
+                if (ids[m] == r.ids[k] && norm(centre[m] - c) < 0.25f * side) break;
+            if (m == ids.size()) {
+                ids.push_back(r.ids[k]);
+                corners.push_back(q);
+                centre.push_back(c);
+                count.push_back(1);
+                continue;
+            }
+            // running mean of the duplicates' corners
+            const float w = 1.0f / static_cast<float>(++count[m]);
+            for (int j = 0; j < 4; j++) corners[m][static_cast<size_t>(j)] += (q[static_cast<size_t>(j)] - corners[m][static_cast<size_t>(j)]) * w;
+            stats_.merged++;
+        }
+    }
+    stats_.frames++;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/aruco.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../util/work_stealing_pool.h"
+
+struct TileDetectParams {
+    bool enabled = false;
+    int cols = 2;            // tile grid
+    int rows = 2;
+    int overlap_px = 160;    // at least the largest marker side, so each marker lies whole in some tile
+    int threads = 0;         // pool workers; 0 = tiles - 1 (the calling thread works too)
+};
+
+// Marker detection split over overlapping tiles, detected in parallel on a
+// work-stealing pool. A marker inside an overlap is found by more than one
+// tile; detections with the same id whose centres are within a quarter of
+// the marker side are merged by averaging their corners, so callers see
+// each physical marker once, in full-frame coordinates.
+class TiledDetector {
+public:
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t raw = 0;        // detections summed over tiles
+        uint64_t merged = 0;     // duplicates folded into another detection
+    };
+
+    void detect(const cv::Mat& frame, const cv::Ptr<cv::aruco::Dictionary>& dict, const TileDetectParams& p,
+                std::vector<std::vector<cv::Point2f>>& corners, std::vector<int>& ids);
+
+    static std::vector<cv::Rect> makeTiles(const cv::Size& size, const TileDetectParams& p);
+
+    const Stats& stats() const { return stats_; }
+    uint64_t steals() const { return pool_ ? pool_->steals() : 0; }
+
+private:
+    struct TileResult {
+        std::vector<std::vector<cv::Point2f>> corners;
+        std::vector<int> ids;
+    };
+
+    std::unique_ptr<WorkStealingPool> pool_;
+    int pool_threads_ = -1;
+    cv::Size tiles_for_;
+    int tiles_cols_ = 0, tiles_rows_ = 0, tiles_overlap_ = -1;
+    std::vector<cv::Rect> tiles_;
+    std::vector<TileResult> results_;
+    cv::Ptr<cv::aruco::DetectorParameters> det_params_;
+    Stats stats_;
+};
@@ -0,0 +1,257 @@
+#include "tracker_params.h"
+
+#include <opencv2/core.hpp>
+
+#include <iostream>
+
+namespace {
+
+template <typename T>
+void read_if(const cv::FileStorage& fs, const char* key, T& out) {
+    cv::FileNode n = fs[key];
+    if (!n.empty()) n >> out;
+}
+
+} // namespace
+
+const char* track_mode_name(TrackMode m) {
+    return m == TrackMode::Homography ? "homography" : "lk";
+}
+
+bool parse_track_mode(const std::string& s, TrackMode& m) {
+    if (s == "lk") m = TrackMode::LK;
+    else if (s == "homography") m = TrackMode::Homography;
+    else return false;
+    return true;
+}
+
+const char* lk_backend_name(LkBackend b) {
+    return b == LkBackend::Cpu ? "cpu" : "cuda";
+}
+
+bool parse_lk_backend(const std::string& s, LkBackend& b) {
+    if (s == "cuda") b = LkBackend::Cuda;
+    else if (s == "cpu") b = LkBackend::Cpu;
+    else return false;
+    return true;
+}
+
+namespace {
+
+void read_params(const cv::FileStorage& fs, TrackerParams& p) {
+    std::string mode = track_mode_name(p.track_mode);
+    read_if(fs, "track_mode", mode);
+    if (!parse_track_mode(mode, p.track_mode))
+        std::cerr << "TrackerParams: unknown track_mode '" << mode << "', keeping " << track_mode_name(p.track_mode) << std::endl;
+    std::string backend = lk_backend_name(p.lk_backend);
+    read_if(fs, "lk_backend", backend);
+    if (!parse_lk_backend(backend, p.lk_backend))
+        std::cerr << "TrackerParams: unknown lk_backend '" << backend << "', keeping " << lk_backend_name(p.lk_backend) << std::endl;
+    read_if(fs, "lk_max_level", p.lk_max_level);
+    read_if(fs, "lk_win_size", p.lk_win_size);
+    read_if(fs, "lk_iters", p.lk_iters);
+    read_if(fs, "redetect_interval", p.redetect_interval);
+    int redetect_adaptive = p.redetect.adaptive ? 1 : 0;
+    read_if(fs, "redetect_adaptive", redetect_adaptive);
+    p.redetect.adaptive = redetect_adaptive != 0;
+    read_if(fs, "redetect_min_confidence", p.redetect.min_confidence);
+    read_if(fs, "redetect_max_interval", p.redetect.max_interval);
+    read_if(fs, "redetect_err_scale", p.redetect.err_scale);
+    int redetect_fb = p.redetect.forward_backward ? 1 : 0;
+    read_if(fs, "redetect_fb_check", redetect_fb);
+    p.redetect.forward_backward = redetect_fb != 0;
+    read_if(fs, "redetect_fb_max_px", p.redetect.fb_max_px);
+    read_if(fs, "points_per_quadrant", p.points_per_quadrant);
+    read_if(fs, "feature_quality", p.feature_quality);
+    read_if(fs, "vel_alpha", p.motion.vel_alpha);
+    read_if(fs, "max_accel", p.motion.max_accel);
+    int kalman_enabled = p.kalman.enabled ? 1 : 0;
+    read_if(fs, "kalman_enabled", kalman_enabled);
+    p.kalman.enabled = kalman_enabled != 0;
+    read_if(fs, "kalman_jerk_psd", p.kalman.jerk_psd);
+    read_if(fs, "kalman_meas_sigma", p.kalman.meas_sigma);
+    read_if(fs, "kalman_max_gap_s", p.kalman.max_gap_s);
+    read_if(fs, "homog_template_px", p.homog.template_px);
+    read_if(fs, "homog_levels", p.homog.levels);
+    read_if(fs, "homog_iters", p.homog.iters);
+    read_if(fs, "homog_eps", p.homog.eps);
+    read_if(fs, "homog_min_cc", p.homog.min_cc);
+    int spectrum_enabled = p.spectrum.enabled ? 1 : 0;
+    read_if(fs, "spectrum_enabled", spectrum_enabled);
+    p.spectrum.enabled = spectrum_enabled != 0;
+    read_if(fs, "spectrum_window", p.spectrum.window);
+    read_if(fs, "spectrum_sample_hz", p.spectrum.sample_hz);
+    read_if(fs, "spectrum_min_hz", p.spectrum.min_hz);
+    read_if(fs, "spectrum_max_hz", p.spectrum.max_hz);
+    read_if(fs, "spectrum_update_hz", p.spectrum.update_hz);
+    int gate_enabled = p.gate.enabled ? 1 : 0;
+    read_if(fs, "gate_enabled", gate_enabled);
+    p.gate.enabled = gate_enabled != 0;
+    read_if(fs, "gate_threshold", p.gate.threshold);
+    read_if(fs, "gate_decimation", p.gate.decimation);
+    read_if(fs, "gate_margin_px", p.gate.margin_px);
+    read_if(fs, "gate_max_skip", p.gate.max_skip);
+    int quality_enabled = p.quality.enabled ? 1 : 0;
+    read_if(fs, "quality_enabled", quality_enabled);
+    p.quality.enabled = quality_enabled != 0;
+    read_if(fs, "quality_decimation", p.quality.decimation);
+    read_if(fs, "quality_margin_px", p.quality.margin_px);
+    read_if(fs, "quality_blur_ratio", p.quality.blur_ratio);
+    read_if(fs, "quality_min_sharpness", p.quality.min_sharpness);
+    read_if(fs, "quality_max_clipped", p.quality.max_clipped);
+    read_if(fs, "quality_dark_level", p.quality.dark_level);
+    read_if(fs, "quality_sat_level", p.quality.sat_level);
+    read_if(fs, "quality_max_skip", p.quality.max_skip);
+    int pose_enabled = p.pose.enabled ? 1 : 0;
+    read_if(fs, "pose_enabled", pose_enabled);
+    p.pose.enabled = pose_enabled != 0;
+    read_if(fs, "pose_marker_mm", p.pose.marker_mm);
+    int pose_warm = p.pose.warm_start ? 1 : 0;
+    read_if(fs, "pose_warm_start", pose_warm);
+    p.pose.warm_start = pose_warm != 0;
+    read_if(fs, "pose_refine_iters", p.pose.refine_iters);
+    read_if(fs, "pose_max_reproj_px", p.pose.max_reproj_px);
+    read_if(fs, "pose_vel_alpha", p.pose.vel_alpha);
+    int tile_enabled = p.tiles.enabled ? 1 : 0;
+    read_if(fs, "tile_enabled", tile_enabled);
+    p.tiles.enabled = tile_enabled != 0;
+    read_if(fs, "tile_cols", p.tiles.cols);
+    read_if(fs, "tile_rows", p.tiles.rows);
+    read_if(fs, "tile_overlap_px", p.tiles.overlap_px);
+    read_if(fs, "tile_threads", p.tiles.threads);
+}
+
+void clamp_params(TrackerParams& p) {
+    if (p.lk_max_level < 0) p.lk_max_level = 0;
+    if (p.lk_win_size < 3) p.lk_win_size = 3;
+    if (p.lk_iters < 1) p.lk_iters = 1;
+    if (p.redetect_interval < 1) p.redetect_interval = 1;
+    if (p.redetect.max_interval < 1) p.redetect.max_interval = 1;
+    if (p.redetect.err_scale <= 0) p.redetect.err_scale = 8.0;
+    if (p.redetect.fb_max_px <= 0) p.redetect.fb_max_px = 1.0;
+    if (p.points_per_quadrant < 1) p.points_per_quadrant = 1;
+    if (p.feature_quality <= 0 || p.feature_quality >= 1) p.feature_quality = 0.05;
+    if (p.kalman.meas_sigma <= 0) p.kalman.meas_sigma = 0.3;
+    if (p.homog.template_px < 16) p.homog.template_px = 16;
+    if (p.homog.levels < 1) p.homog.levels = 1;
+    if (p.homog.iters < 1) p.homog.iters = 1;
+    if (p.spectrum.window < 16) p.spectrum.window = 16;
+    if (p.spectrum.sample_hz <= 0) p.spectrum.sample_hz = 120.0;
+    if (p.gate.decimation < 1) p.gate.decimation = 1;
+    if (p.gate.margin_px < 0) p.gate.margin_px = 0;
+    if (p.gate.max_skip < 0) p.gate.max_skip = 0;
+    if (p.quality.decimation < 1) p.quality.decimation = 1;
+    if (p.quality.margin_px < 0) p.quality.margin_px = 0;
+    if (p.quality.max_skip < 0) p.quality.max_skip = 0;
+    if (p.pose.marker_mm <= 0) p.pose.marker_mm = 50.0;
+    if (p.pose.refine_iters < 1) p.pose.refine_iters = 1;
+    if (p.tiles.cols < 1) p.tiles.cols = 1;
+    if (p.tiles.rows < 1) p.tiles.rows = 1;
+    if (p.tiles.overlap_px < 0) p.tiles.overlap_px = 0;
+    if (p.tiles.threads < 0) p.tiles.threads = 0;
+}
+
+void write_params(cv::FileStorage& fs, const TrackerParams& p) {
+    fs << "track_mode" << std::string(track_mode_name(p.track_mode));
+    fs << "lk_backend" << std::string(lk_backend_name(p.lk_backend));
+    fs << "lk_max_level" << p.lk_max_level;
+    fs << "lk_win_size" << p.lk_win_size;
+    fs << "lk_iters" << p.lk_iters;
+    fs << "redetect_interval" << p.redetect_interval;
+    fs << "redetect_adaptive" << (p.redetect.adaptive ? 1 : 0);
+    fs << "redetect_min_confidence" << p.redetect.min_confidence;
+    fs << "redetect_max_interval" << p.redetect.max_interval;
+    fs << "redetect_err_scale" << p.redetect.err_scale;
+    fs << "redetect_fb_check" << (p.redetect.forward_backward ? 1 : 0);
+    fs << "redetect_fb_max_px" << p.redetect.fb_max_px;
+    fs << "points_per_quadrant" << p.points_per_quadrant;
+    fs << "feature_quality" << p.feature_quality;
+    fs << "vel_alpha" << p.motion.vel_alpha;
+    fs << "max_accel" << p.motion.max_accel;
+    fs << "kalman_enabled" << (p.kalman.enabled ? 1 : 0);
+    fs << "kalman_jerk_psd" << p.kalman.jerk_psd;
+    fs << "kalman_meas_sigma" << p.kalman.meas_sigma;
+    fs << "kalman_max_gap_s" << p.kalman.max_gap_s;
+    fs << "homog_template_px" << p.homog.template_px;
+    fs << "homog_levels" << p.homog.levels;
+    fs << "homog_iters" << p.homog.iters;
+    fs << "homog_eps" << p.homog.eps;
+    fs << "homog_min_cc" << p.homog.min_cc;
+    fs << "spectrum_enabled" << (p.spectrum.enabled ? 1 : 0);
+    fs << "spectrum_window" << p.spectrum.window;
+    fs << "spectrum_sample_hz" << p.spectrum.sample_hz;
+    fs << "spectrum_min_hz" << p.spectrum.min_hz;
+    fs << "spectrum_max_hz" << p.spectrum.max_hz;
+    fs << "spectrum_update_hz" << p.spectrum.update_hz;
+    fs << "gate_enabled" << (p.gate.enabled ? 1 : 0);
+    fs << "gate_threshold" << p.gate.threshold;
+    fs << "gate_decimation" << p.gate.decimation;
+    fs << "gate_margin_px" << p.gate.margin_px;
+    fs << "gate_max_skip" << p.gate.max_skip;
+    fs << "quality_enabled" << (p.quality.enabled ? 1 : 0);
+    fs << "quality_decimation" << p.quality.decimation;
+    fs << "quality_margin_px" << p.quality.margin_px;
+    fs << "quality_blur_ratio" << p.quality.blur_ratio;
+    fs << "quality_min_sharpness" << p.quality.min_sharpness;
+    fs << "quality_max_clipped" << p.quality.max_clipped;
+    fs << "quality_dark_level" << p.quality.dark_level;
+    fs << "quality_sat_level" << p.quality.sat_level;
+    fs << "quality_max_skip" << p.quality.max_skip;
+    fs << "pose_enabled" << (p.pose.enabled ? 1 : 0);
+    fs << "pose_marker_mm" << p.pose.marker_mm;
+    fs << "pose_warm_start" << (p.pose.warm_start ? 1 : 0);
+    fs << "pose_refine_iters" << p.pose.refine_iters;
+    fs << "pose_max_reproj_px" << p.pose.max_reproj_px;
+    fs << "pose_vel_alpha" << p.pose.vel_alpha;
+    fs << "tile_enabled" << (p.tiles.enabled ? 1 : 0);
+    fs << "tile_cols" << p.tiles.cols;
+    fs << "tile_rows" << p.tiles.rows;
+    fs << "tile_overlap_px" << p.tiles.overlap_px;
+    fs << "tile_threads" << p.tiles.threads;
+}
+
+} // namespace
+
+bool load_tracker_params(const std::string& path, TrackerParams& p) {
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+        read_params(fs, p);
+    } catch (const cv::Exception& e) {
+        std::cerr << "TrackerParams: failed to parse " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    clamp_params(p);
+    return true;
+}
+
+bool parse_tracker_params(const std::string& text, TrackerParams& p) {
+    try {
+        cv::FileStorage fs(text, cv::FileStorage::READ | cv::FileStorage::MEMORY);
+        if (!fs.isOpened()) return false;
+        read_params(fs, p);
+    } catch (const cv::Exception& e) {
+        std::cerr << "TrackerParams: failed to parse parameter text: " << e.what() << std::endl;
+        return false;
+    }
+    clamp_params(p);
+    return true;
+}
+
+bool save_tracker_params(const std::string& path, const TrackerParams& p) {
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
+        if (!fs.isOpened()) return false;
+        write_params(fs, p);
+    } catch (const cv::Exception& e) {
+        std::cerr << "TrackerParams: failed to write " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string tracker_params_json(const TrackerParams& p) {
+    cv::FileStorage fs(".json", cv::FileStorage::WRITE | cv::FileStorage::MEMORY);
+    write_params(fs, p);
+    return fs.releaseAndGetString();
+}
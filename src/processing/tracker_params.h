@@ -0,0 +1,70 @@
+#pragma once
+
+#include "motion_types.h"
+#include "motion_gate.h"
+#include "quality_gate.h"
+#include "kalman_point.h"
+#include "homography_aligner.h"
+#include "vibration_spectrum.h"
+#include "pose_estimator.h"
+#include "tiled_detector.h"
+
+#include <string>
+
+enum class TrackMode {
+    LK,          // per-point sparse optical flow (CUDA), periodic re-detection
+    Homography,  // whole-marker ECC alignment, re-detection only on failure
+};
+
+enum class LkBackend {
+    Cuda,  // cv::cuda::SparsePyrLKOpticalFlow on the GPU
+    Cpu,   // cv::calcOpticalFlowPyrLK on prebuilt pyramids (see PyramidPipeline)
+};
+
+// Confidence-driven re-detection (TrackMode::LK). Each tracked point gets a
+// confidence from its LK residual and, optionally, a forward-backward round
+// trip; the marker re-detects when its weakest quadrant drops below
+// min_confidence, or after max_interval frames at the latest. Off: a fixed
+// cadence of redetect_interval frames.
+struct RedetectParams {
+    bool adaptive = false;
+    double min_confidence = 0.5;  // 0..1
+    int max_interval = 120;       // safety net (frames)
+    double err_scale = 8.0;       // LK residual (grey levels) at which confidence falls to 1/e
+    bool forward_backward = true; // track back to the previous frame and check the round trip
+    double fb_max_px = 1.0;       // points whose round trip misses by more are dropped
+};
+
+// Runtime-tunable tracking parameters. Defaults match the previously
+// hard-coded values; tools/tuner output is loaded with --params.
+struct TrackerParams {
+    TrackMode track_mode = TrackMode::LK;
+    LkBackend lk_backend = LkBackend::Cuda;
+    int lk_max_level = 2;        // pyramid levels above the base image
+    int lk_win_size = 15;        // square LK window (px)
+    int lk_iters = 10;           // LK iterations per level
+    int redetect_interval = 20;  // frames between forced re-detections
+    RedetectParams redetect;     // confidence-driven scheduling instead (off by default)
+    int points_per_quadrant = 1; // K Shi-Tomasi points per quadrant (1 = quadrant centre only)
+    double feature_quality = 0.05; // goodFeaturesToTrack qualityLevel
+    MotionParams motion;         // EMA smoothing (used when kalman.enabled is false)
+    KalmanParams kalman;         // per-point CA filter + LK initial flow
+    HomographyParams homog;      // TrackMode::Homography only
+    SpectrumParams spectrum;     // streaming vibration analysis (off by default)
+    MotionGateParams gate;       // skip unchanged frames (off by default)
+    QualityGateParams quality;   // skip blurred / badly exposed frames (off by default)
+    PoseParams pose;             // metric 6-DOF pose (needs a calibration, off by default)
+    TileDetectParams tiles;      // parallel tiled marker detection (off by default)
+};
+
+// JSON/YAML via cv::FileStorage. Missing keys keep their current value.
+bool load_tracker_params(const std::string& path, TrackerParams& p);
+bool save_tracker_params(const std::string& path, const TrackerParams& p);
+// Same keys from / to an in-memory JSON or YAML document (control socket).
+bool parse_tracker_params(const std::string& text, TrackerParams& p);
+std::string tracker_params_json(const TrackerParams& p);
+
+const char* track_mode_name(TrackMode m);
+bool parse_track_mode(const std::string& s, TrackMode& m);
+const char* lk_backend_name(LkBackend b);
+bool parse_lk_backend(const std::string& s, LkBackend& b);
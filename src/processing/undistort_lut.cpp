@@ -0,0 +1,136 @@
+#include "undistort_lut.h"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Cache file: this header, then gw*gh (x, y) float pairs. Every field that
+// determines the grid is in the header, so any change misses the cache.
+struct UndistortLut::Header {
+    char magic[8];
+    uint32_t version;
+    int32_t width, height, step, gw, gh, ndist;
+    double K[9];
+    double dist[14];
+};
+
+void UndistortLut::fill_header(Header& h, const CameraCalibration& c, const cv::Size& frame, int step) {
+    std::memset(&h, 0, sizeof(h)); // padding included, so headers compare with memcmp
+    std::memcpy(h.magic, "UNDLUT\0\0", 8);
+    h.version = 1;
+    h.width = frame.width;
+    h.height = frame.height;
+    h.step = step;
+    h.gw = (frame.width + step - 1) / step + 1;
+    h.gh = (frame.height + step - 1) / step + 1;
+    for (int i = 0; i < 9; i++) h.K[i] = c.K.at<double>(i / 3, i % 3);
+    h.ndist = static_cast<int32_t>(std::min<size_t>(14, c.dist.total()));
+    for (int i = 0; i < h.ndist; i++) h.dist[i] = c.dist.ptr<double>()[i];
+}
+
+bool UndistortLut::prepare(const CameraCalibration& c, const cv::Size& frame, int step, const std::string& cache_path) {
+    if (!c.valid() || frame.area() <= 0) return false;
+    const CameraCalibration cs = c.scaledTo(frame);
+    step = std::max(1, step);
+    if (!cache_path.empty() && load(cache_path, cs, frame, step)) return true;
+    if (!build(cs, frame, step)) return false;
+    if (!cache_path.empty() && !save(cache_path))
+        std::cerr << "UndistortLut: could not write cache " << cache_path << std::endl;
+    return true;
+}
+
+bool UndistortLut::build(const CameraCalibration& c, const cv::Size& frame, int step) {
+    if (!c.valid() || frame.area() <= 0) return false;
+    release();
+    Header h;
+    fill_header(h, c, frame, step);
+
+    std::vector<cv::Point2f> nodes, out;
+    nodes.reserve(static_cast<size_t>(h.gw) * h.gh);
+    for (int y = 0; y < h.gh; y++)
+        for (int x = 0; x < h.gw; x++)
+            nodes.emplace_back(static_cast<float>(x * step), static_cast<float>(y * step));
+    // P = K: undistorted coordinates stay in pixels of the same camera
+    cv::undistortPoints(nodes, out, c.K, c.dist, cv::Mat(), c.K);
+    if (out.size() != nodes.size()) return false;
+
+    own_.resize(2 * out.size());
+    for (size_t i = 0; i < out.size(); i++) {
+        own_[2 * i] = out[i].x;
+        own_[2 * i + 1] = out[i].y;
+    }
+    header_.assign(reinterpret_cast<const char*>(&h), reinterpret_cast<const char*>(&h) + sizeof(h));
+    grid_ = own_.data();
+    gw_ = h.gw;
+    gh_ = h.gh;
+    inv_step_ = 1.0f / step;
+    size_ = frame;
+    return true;
+}
+
+bool UndistortLut::load(const std::string& path, const CameraCalibration& c, const cv::Size& frame, int step) {
+    Header want;
+    fill_header(want, c, frame, step);
+    const size_t len = sizeof(Header) + sizeof(float) * 2 * static_cast<size_t>(want.gw) * want.gh;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != len) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    if (std::memcmp(p, &want, sizeof(Header)) != 0) {
+        munmap(p, len);
+        return false;
+    }
+    release();
+    map_ = p;
+    map_len_ = len;
+    header_.assign(reinterpret_cast<const char*>(&want), reinterpret_cast<const char*>(&want) + sizeof(want));
+    grid_ = reinterpret_cast<const float*>(static_cast<const char*>(p) + sizeof(Header));
+    gw_ = want.gw;
+    gh_ = want.gh;
+    inv_step_ = 1.0f / step;
+    size_ = frame;
+    return true;
+}
+
+bool UndistortLut::save(const std::string& path) const {
+    if (!grid_ || header_.size() != sizeof(Header)) return false;
+    // write-then-rename, so a concurrent reader never maps a partial file
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(header_.data(), static_cast<std::streamsize>(header_.size()));
+        f.write(reinterpret_cast<const char*>(grid_), static_cast<std::streamsize>(sizeof(float) * 2 * gw_ * gh_));
+        if (!f.good()) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+void UndistortLut::release() {
+    if (map_) munmap(map_, map_len_);
+    map_ = nullptr;
+    map_len_ = 0;
+    own_.clear();
+    own_.shrink_to_fit();
+    grid_ = nullptr;
+    gw_ = gh_ = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pose_estimator.h"
+
+// Point-space lens undistortion. A grid of undistorted positions, one node
+// every `step` pixels, is computed once from the calibration (exact
+// cv::undistortPoints, same camera matrix), and each point is then mapped
+// by bilinear interpolation between its four surrounding nodes: a handful
+// of multiply-adds per point instead of remapping whole frames.
+//
+// The grid can be cached on disk. A cache is only used when its header
+// matches the calibration, frame size and step; it is then mmap'ed, so a
+// restart costs one page-in instead of a rebuild.
+class UndistortLut {
+public:
+    UndistortLut() = default;
+    ~UndistortLut() { release(); }
+    UndistortLut(const UndistortLut&) = delete;
+    UndistortLut& operator=(const UndistortLut&) = delete;
+
+    // Load `cache_path` if it matches, else build (and write the cache when
+    // a path is given). Returns false only when the calibration is unusable.
+    bool prepare(const CameraCalibration& c, const cv::Size& frame, int step, const std::string& cache_path);
+    bool build(const CameraCalibration& c, const cv::Size& frame, int step);
+    bool load(const std::string& path, const CameraCalibration& c, const cv::Size& frame, int step);
+    bool save(const std::string& path) const;
+    void release();
+
+    bool ready() const { return grid_ != nullptr; }
+    bool mapped() const { return map_ != nullptr; }
+    const cv::Size& frameSize() const { return size_; }
+
+    cv::Point2f map(const cv::Point2f& p) const {
+        // cell index clamped to the grid; points outside extrapolate from the edge cell
+        float fx = p.x * inv_step_, fy = p.y * inv_step_;
+        int ix = static_cast<int>(fx), iy = static_cast<int>(fy);
+        ix = ix < 0 ? 0 : (ix > gw_ - 2 ? gw_ - 2 : ix);
+        iy = iy < 0 ? 0 : (iy > gh_ - 2 ? gh_ - 2 : iy);
+        const float ax = fx - ix, ay = fy - iy;
+        const float* n00 = grid_ + 2 * (iy * gw_ + ix);
+        const float* n01 = n00 + 2;
+        const float* n10 = n00 + 2 * gw_;
+        const float* n11 = n10 + 2;
+        const float w00 = (1 - ax) * (1 - ay), w01 = ax * (1 - ay), w10 = (1 - ax) * ay, w11 = ax * ay;
+        return {w00 * n00[0] + w01 * n01[0] + w10 * n10[0] + w11 * n11[0],
+                w00 * n00[1] + w01 * n01[1] + w10 * n10[1] + w11 * n11[1]};
+    }
+
+    void map(cv::Point2f* pts, size_t n) const {
+        for (size_t i = 0; i < n; i++) pts[i] = map(pts[i]);
+    }
+
+private:
+    struct Header;
+    static void fill_header(Header& h, const CameraCalibration& c, const cv::Size& frame, int step);
+
+    std::vector<float> own_;    // built grid (gw_ x gh_ x 2)
+    void* map_ = nullptr;       // mmap'ed cache file, grid_ points into it
+    size_t map_len_ = 0;
+    const float* grid_ = nullptr;
+    int gw_ = 0, gh_ = 0;
+    float inv_step_ = 0;
+    cv::Size size_;
+    std::vector<char> header_;  // header of the current grid, for save()
+};
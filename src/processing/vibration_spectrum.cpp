@@ -0,0 +1,156 @@
+#include "vibration_spectrum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+void SlidingDft::configure(int window, int k_lo, int k_hi) {
+    n_ = std::max(8, window);
+    lo_ = std::max(1, k_lo);
+    hi_ = std::min(n_ / 2 - 1, std::max(lo_, k_hi));
+    k0_ = lo_ - 1;
+    k1_ = hi_ + 1;
+    r_ = 1.0 - 1e-7;
+    rn_ = std::pow(r_, n_);
+    const double pi = 3.14159265358979323846;
+    tw_.resize(static_cast<size_t>(k1_ - k0_ + 1));
+    for (int k = k0_; k <= k1_; k++) tw_[k - k0_] = std::polar(1.0, 2.0 * pi * k / n_);
+    reset();
+}
+
+void SlidingDft::reset() {
+    X_.assign(tw_.size(), {0.0, 0.0});
+    ring_.assign(static_cast<size_t>(n_), 0.0);
+    head_ = count_ = since_resum_ = 0;
+    sum_ = sum2_ = 0;
+}
+
+void SlidingDft::push(double x) {
+    const double old = ring_[head_];
+    ring_[head_] = x;
+    head_ = (head_ + 1) % n_;
+    if (count_ < n_) count_++;
+
+    // X_k <- e^{j2pik/N} (r X_k + x - r^N x_old)
+    const double delta = x - rn_ * old;
+    for (size_t i = 0; i < X_.size(); i++) X_[i] = tw_[i] * (r_ * X_[i] + delta);
+
+    sum_ += x - old;
+    sum2_ += x * x - old * old;
+    if (++since_resum_ >= n_) {
+        // re-sum once per window to cancel accumulated rounding
+        sum_ = sum2_ = 0;
+        for (double v : ring_) { sum_ += v; sum2_ += v * v; }
+        since_resum_ = 0;
+    }
+}
+
+SpectrumPeak SlidingDft::peak(double sample_hz) const {
+    SpectrumPeak pk;
+    if (!full()) return pk;
+
+    // Hann window applied in the frequency domain: Y_k = X_k/2 - (X_{k-1} + X_{k+1})/4.
+    // Bin 0 is taken as zero, i.e. the window mean is removed first.
+    auto bin = [&](int k) { return k == 0 ? std::complex<double>() : X_[k - k0_]; };
+    auto hann = [&](int k) { return std::abs(0.5 * bin(k) - 0.25 * (bin(k - 1) + bin(k + 1))); };
+    int best = lo_;
+    double bm = -1;
+    for (int k = lo_; k <= hi_; k++) {
+        double m = hann(k);
+        if (m > bm) { bm = m; best = k; }
+    }
+    double a = best > lo_ ? hann(best - 1) : bm, c = best < hi_ ? hann(best + 1) : bm;
+    double den = a - 2 * bm + c;
+    double d = den != 0 ? 0.5 * (a - c) / den : 0.0;
+    d = std::max(-0.5, std::min(0.5, d));
+    double mag = bm - 0.25 * (a - c) * d;
+
+    const double pi = 3.14159265358979323846;
+    double mean = sum_ / n_;
+    pk.valid = true;
+    pk.freq_hz = (best + d) * sample_hz / n_;
+    pk.amp_px = 4.0 * mag / n_;
+    pk.rms_px = std::sqrt(std::max(0.0, sum2_ / n_ - mean * mean));
+    pk.vel_amp = 2 * pi * pk.freq_hz * pk.amp_px;
+    return pk;
+}
+
+void VibrationSpectrum::configure(const SpectrumParams& p) {
+    p_ = p;
+    if (p_.sample_hz <= 0) p_.sample_hz = 120.0;
+    const double nyq = p_.sample_hz / 2;
+    const double hi_hz = p_.max_hz > 0 ? std::min(p_.max_hz, nyq) : nyq;
+    const int k_lo = static_cast<int>(std::floor(p_.min_hz * p_.window / p_.sample_hz));
+    const int k_hi = static_cast<int>(std::ceil(hi_hz * p_.window / p_.sample_hz));
+    for (auto& q : dft_)
+        for (auto& d : q) d.configure(p_.window, k_lo, k_hi);
+    reset();
+}
+
+void VibrationSpectrum::reset() {
+    for (auto& q : dft_)
+        for (auto& d : q) d.reset();
+    for (auto& q : peak_)
+        for (auto& pk : q) pk = SpectrumPeak();
+    for (auto& t : track_) t = Track();
+    t0_ = 0;
+    last_update_us_ = 0;
+}
+
+void VibrationSpectrum::feed(int q, const cv::Point2f& pos, uint64_t ts_us) {
+    Track& t = track_[q];
+    const double dt = 1.0 / p_.sample_hz;
+    const double ts = (ts_us - t0_) * 1e-6;
+    if (t.started && (ts_us <= t.last_ts)) return; // duplicate / out of order
+    if (t.started && (ts_us - t.last_ts) * 1e-6 > p_.max_gap_s) {
+        dft_[q][0].reset();
+        dft_[q][1].reset();
+        peak_[q][0] = peak_[q][1] = SpectrumPeak();
+        t.started = false;
+    }
+    if (!t.started) {
+        dft_[q][0].push(pos.x);
+        dft_[q][1].push(pos.y);
+        t.started = true;
+        t.next_t = ts + dt;
+    } else {
+        // emit every grid point up to ts, interpolated between the last two samples
+        const double t_prev = (t.last_ts - t0_) * 1e-6;
+        const double span = ts - t_prev;
+        while (t.next_t <= ts) {
+            const double u = (t.next_t - t_prev) / span;
+            dft_[q][0].push(t.last_pos.x + u * (pos.x - t.last_pos.x));
+            dft_[q][1].push(t.last_pos.y + u * (pos.y - t.last_pos.y));
+            t.next_t += dt;
+        }
+    }
+    t.last_ts = ts_us;
+    t.last_pos = pos;
+}
+
+bool VibrationSpectrum::push(const TrackerState& st, uint64_t ts_us) {
+    if (!p_.enabled || !st.tracking) return false;
+    if (t0_ == 0) t0_ = ts_us;
+    for (int q = 0; q < 4; q++)
+        if (st.q[q].valid) feed(q, st.q[q].motion.pos, ts_us);
+
+    const uint64_t period = static_cast<uint64_t>(1e6 / std::max(0.1, p_.update_hz));
+    if (last_update_us_ && ts_us - last_update_us_ < period) return false;
+    last_update_us_ = ts_us;
+    for (int q = 0; q < 4; q++)
+        for (int a = 0; a < 2; a++) peak_[q][a] = dft_[q][a].peak(p_.sample_hz);
+    return true;
+}
+
+std::string VibrationSpectrum::label(int q) const {
+    const SpectrumPeak& x = peak_[q][0];
+    const SpectrumPeak& y = peak_[q][1];
+    if (!x.valid && !y.valid) return std::string();
+    const bool use_x = x.valid && (!y.valid || x.amp_px >= y.amp_px);
+    const SpectrumPeak& pk = use_x ? x : y;
+    std::ostringstream os;
+    os << (use_x ? "x " : "y ") << std::fixed << std::setprecision(1) << pk.freq_hz << "Hz "
+       << std::setprecision(2) << pk.amp_px << "px";
+    return os.str();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "motion_types.h"
+
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SpectrumParams {
+    bool enabled = false;
+    int window = 256;         // samples per DFT window (resolution = sample_hz / window)
+    double sample_hz = 120.0; // uniform resampling rate
+    double min_hz = 2.0;      // analysed band (keeps slow drift out of the peak search)
+    double max_hz = 0.0;      // 0 = Nyquist
+    double update_hz = 10.0;  // peak search / publication rate
+    double max_gap_s = 0.5;   // longer PTS gaps restart the window
+};
+
+struct SpectrumPeak {
+    bool valid = false;      // false until a full window has been seen
+    double freq_hz = 0;
+    double amp_px = 0;       // sinusoid amplitude (peak, not peak-to-peak)
+    double rms_px = 0;       // RMS of the de-meaned window (all frequencies)
+    double vel_amp = 0;      // 2*pi*f*A, px/s
+};
+
+// Sliding DFT over one real signal: every new sample updates the tracked
+// bins in O(bins) and the oldest sample leaves the window, so nothing is
+// ever recomputed from scratch. A tiny damping factor keeps the recursion
+// numerically stable over long runs.
+class SlidingDft {
+public:
+    void configure(int window, int k_lo, int k_hi);
+    void reset();
+    void push(double x);
+    bool full() const { return count_ >= n_; }
+    // Dominant Hann-windowed peak between k_lo and k_hi, interpolated.
+    SpectrumPeak peak(double sample_hz) const;
+
+private:
+    int n_ = 0, k0_ = 0, k1_ = 0;       // bins stored: k0_..k1_ (includes Hann neighbours)
+    int lo_ = 0, hi_ = 0;               // bins searched
+    double r_ = 1.0, rn_ = 1.0;         // damping r and r^N
+    std::vector<std::complex<double>> X_, tw_;
+    std::vector<double> ring_;
+    int head_ = 0, count_ = 0;
+    double sum_ = 0, sum2_ = 0;
+    int since_resum_ = 0;
+};
+
+// Per-quadrant, per-axis dominant vibration from tracked positions. PTS gaps
+// (dropped frames) are bridged by linear interpolation onto a uniform grid,
+// so the DFT always sees evenly spaced samples.
+class VibrationSpectrum {
+public:
+    void configure(const SpectrumParams& p);
+    void reset();
+    // Feed the state after each processed frame. True when peaks were refreshed.
+    bool push(const TrackerState& st, uint64_t ts_us);
+
+    const SpectrumPeak& peak(int quadrant, int axis) const { return peak_[quadrant][axis]; }
+    const SpectrumParams& params() const { return p_; }
+    // Short overlay text for the stronger axis of a quadrant, e.g. "x 12.3Hz 0.76px"; empty until valid.
+    std::string label(int quadrant) const;
+
+private:
+    struct Track {
+        bool started = false;
+        uint64_t last_ts = 0;
+        cv::Point2f last_pos;
+        double next_t = 0;    // next grid time, seconds since t0_
+    };
+
+    void feed(int q, const cv::Point2f& pos, uint64_t ts_us);
+
+    SpectrumParams p_;
+    SlidingDft dft_[4][2];
+    SpectrumPeak peak_[4][2];
+    Track track_[4];
+    uint64_t t0_ = 0;
+    uint64_t last_update_us_ = 0;
+};
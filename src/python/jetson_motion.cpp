@@ -0,0 +1,380 @@
+// Python bindings (pybind11): the tracker, its parameters, the frame sources
+// and the per-frame state, for offline processing driven from Python.
+//
+// Frames go in as NumPy uint8 arrays without a copy: a (H, W) array with
+// contiguous rows becomes a cv::Mat header over the same memory. A batch
+// call takes an (N, H, W) array, processes every frame with the GIL released
+// and returns an N-element structured array (dtype STATE_DTYPE), so a whole
+// clip costs one Python call instead of a run through metrics.csv.
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <gst/gst.h>
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "processing/aruco_tracker.h"
+#include "processing/tracker_params.h"
+#include "pipeline/source_factory.h"
+
+namespace py = pybind11;
+
+namespace {
+
+// One row of the structured state array. Flat fixed-size fields only, so
+// NumPy sees a plain record type.
+struct StateRecord {
+    uint64_t ts_us;
+    bool tracking;
+    int32_t marker_id;
+    int32_t bbox[4];          // x, y, w, h
+    bool q_valid[4];
+    float pos[4][2];          // px (undistorted when undistortion is on)
+    float vel[4][2];          // px/s
+    float acc[4][2];          // px/s^2
+    bool pose_valid;
+    double t_mm[3];
+    double rvec[3];
+    double v_mm_s[3];
+    double reproj_px;
+    bool quality_checked;
+    bool quality_ok;
+    float sharpness;
+    float clipped;
+};
+
+void fill_record(const TrackerState& st, uint64_t ts_us, StateRecord& r) {
+    std::memset(&r, 0, sizeof(r));
+    r.ts_us = ts_us;
+    r.tracking = st.tracking;
+    r.marker_id = st.marker_id;
+    r.bbox[0] = st.marker_bbox.x;
+    r.bbox[1] = st.marker_bbox.y;
+    r.bbox[2] = st.marker_bbox.width;
+    r.bbox[3] = st.marker_bbox.height;
+    for (int q = 0; q < 4; q++) {
+        const MotionState& m = st.q[q].motion;
+        r.q_valid[q] = st.q[q].valid;
+        r.pos[q][0] = m.pos.x; r.pos[q][1] = m.pos.y;
+        r.vel[q][0] = m.vel.x; r.vel[q][1] = m.vel.y;
+        r.acc[q][0] = m.acc.x; r.acc[q][1] = m.acc.y;
+    }
+    const PoseState& p = st.pose;
+    r.pose_valid = p.valid;
+    if (p.valid) {
+        r.t_mm[0] = p.t.x; r.t_mm[1] = p.t.y; r.t_mm[2] = p.t.z;
+        for (int i = 0; i < 3; i++) r.rvec[i] = p.rvec[i];
+        r.v_mm_s[0] = p.vel.x; r.v_mm_s[1] = p.vel.y; r.v_mm_s[2] = p.vel.z;
+        r.reproj_px = p.reproj_px;
+    }
+    r.quality_checked = st.quality.checked;
+    r.quality_ok = st.quality.ok;
+    r.sharpness = st.quality.sharpness;
+    r.clipped = st.quality.clipped;
+}
+
+// Header over a (H, W) uint8 array; rows may be strided (padding, column
+// slices), pixels may not, and rows must run forwards: cv::Mat has no
+// negative step, so e.g. frame[::-1] is rejected.
+cv::Mat frame_view(const py::array& a) {
+    if (a.dtype().kind() != 'u' || a.itemsize() != 1)
+        throw py::type_error("frame must be a uint8 array");
+    if (a.ndim() != 2) throw py::value_error("frame must be 2-D (H, W) greyscale");
+    if (a.strides(1) != 1) throw py::value_error("frame rows must be contiguous (frame.strides[1] == 1)");
+    const bool rows = a.shape(0) > 1; // a single row's stride is never used
+    if (rows && a.strides(0) < a.shape(1))
+        throw py::value_error("frame rows must not overlap or run backwards (frame.strides[0] >= width); "
+                              "use np.ascontiguousarray");
+    return cv::Mat(static_cast<int>(a.shape(0)), static_cast<int>(a.shape(1)), CV_8UC1,
+                   const_cast<void*>(a.data()), rows ? static_cast<size_t>(a.strides(0)) : cv::Mat::AUTO_STEP);
+}
+
+// NumPy view of a cv::Mat; the capsule keeps the Mat's buffer alive.
+py::array to_numpy(const cv::Mat& m) {
+    auto* owner = new cv::Mat(m);
+    py::capsule free_when_done(owner, [](void* p) { delete static_cast<cv::Mat*>(p); });
+    return py::array(py::dtype::of<uint8_t>(), {owner->rows, owner->cols},
+                     {static_cast<py::ssize_t>(owner->step[0]), static_cast<py::ssize_t>(1)}, owner->data, free_when_done);
+}
+
+// The tracker with a lock: calls release the GIL, so two Python threads
+// could otherwise drive the same instance at once.
+class PyTracker {
+public:
+    PyTracker(const TrackerParams& p, const std::string& camera) : tracker_(p, camera) {
+        // results go back to the caller; no CSV, snapshots or UDP
+        ArucoTracker::Options o;
+        o.enable_save = false;
+        o.enable_csv = false;
+        o.enable_metrics = false;
+        tracker_.setOptions(o);
+    }
+
+    TrackerState process(const py::array& frame, uint64_t ts_us) {
+        cv::Mat m = frame_view(frame);
+        py::gil_scoped_release nogil;
+        std::lock_guard<std::mutex> lk(m_);
+        tracker_.process(m, ts_us);
+        return tracker_.state();
+    }
+
+    py::array process_batch(const py::array& frames, const py::object& ts_obj, double fps, uint64_t start_us) {
+        if (frames.dtype().kind() != 'u' || frames.itemsize() != 1)
+            throw py::type_error("frames must be a uint8 array");
+        if (frames.ndim() != 3) throw py::value_error("frames must be 3-D (N, H, W)");
+        if (frames.strides(2) != 1) throw py::value_error("frame rows must be contiguous (frames.strides[2] == 1)");
+        const bool rows = frames.shape(1) > 1, many = frames.shape(0) > 1;
+        if ((rows && frames.strides(1) < frames.shape(2)) || (many && frames.strides(0) <= 0))
+            throw py::value_error("frames and rows must not run backwards (frames.strides[0] > 0, "
+                                  "frames.strides[1] >= W); use np.ascontiguousarray");
+        const py::ssize_t n = frames.shape(0);
+        py::array_t<uint64_t, py::array::c_style | py::array::forcecast> ts;
+        const bool have_ts = !ts_obj.is_none();
+        if (have_ts) {
+            ts = py::array_t<uint64_t, py::array::c_style | py::array::forcecast>::ensure(ts_obj);
+            if (!ts || ts.ndim() != 1 || ts.shape(0) != n)
+                throw py::value_error("ts_us must be a 1-D array with one timestamp per frame");
+        } else if (fps <= 0) {
+            throw py::value_error("fps must be positive when ts_us is not given");
+        }
+
+        py::array_t<StateRecord> out(n);
+        StateRecord* rec = out.mutable_data();
+        const uint64_t* ts_ptr = have_ts ? ts.data() : nullptr;
+        const auto* base = static_cast<const uint8_t*>(frames.data());
+        const int h = static_cast<int>(frames.shape(1)), w = static_cast<int>(frames.shape(2));
+        const py::ssize_t s0 = frames.strides(0);
+        const size_t s1 = rows ? static_cast<size_t>(frames.strides(1)) : cv::Mat::AUTO_STEP;
+        {
+            py::gil_scoped_release nogil;
+            std::lock_guard<std::mutex> lk(m_);
+            for (py::ssize_t k = 0; k < n; k++) {
+                const cv::Mat m(h, w, CV_8UC1, const_cast<uint8_t*>(base + k * s0), s1);
+                const uint64_t t = ts_ptr ? ts_ptr[k] : start_us + static_cast<uint64_t>(k * 1e6 / fps + 0.5);
+                tracker_.process(m, t);
+                fill_record(tracker_.state(), t, rec[k]);
+            }
+        }
+        return std::move(out);
+    }
+
+    ArucoTracker& tracker() { return tracker_; }
+    std::mutex& mutex() { return m_; }
+
+private:
+    ArucoTracker tracker_;
+    std::mutex m_;
+};
+
+class PySource {
+public:
+    explicit PySource(const SourceConfig& c) {
+        if (source_uses_gstreamer(c)) gst_init(nullptr, nullptr);
+        src_ = open_frame_source(c);
+        if (!src_) throw std::runtime_error("could not open " + c.source + " source");
+    }
+
+    // (frame, ts_us), or None at the end of the stream. The frame is a view
+    // of the grabbed buffer, not a copy.
+    py::object grab() {
+        cv::Mat f;
+        uint64_t ts = 0;
+        bool ok;
+        {
+            py::gil_scoped_release nogil;
+            ok = src_ && src_->grab(f, ts);
+        }
+        if (!ok) return py::none();
+        return py::make_tuple(to_numpy(f), ts);
+    }
+
+    // Up to n frames as one (n, H, W) array plus their timestamps; fewer at
+    // the end of the stream. The size is taken from the first frame.
+    py::tuple read(py::ssize_t n) {
+        cv::Mat f;
+        uint64_t t0 = 0;
+        bool ok;
+        {
+            py::gil_scoped_release nogil;
+            ok = n > 0 && src_ && src_->grab(f, t0);
+        }
+        if (!ok) return py::make_tuple(py::array_t<uint8_t>(std::vector<py::ssize_t>{0, 0, 0}), py::array_t<uint64_t>(0));
+        if (f.type() != CV_8UC1) throw std::runtime_error("source delivered a non-greyscale frame");
+
+        const int h = f.rows, w = f.cols;
+        py::array_t<uint8_t> frames(std::vector<py::ssize_t>{n, h, w});
+        py::array_t<uint64_t> ts(n);
+        uint8_t* dst = frames.mutable_data();
+        uint64_t* t = ts.mutable_data();
+        const size_t frame_bytes = static_cast<size_t>(w) * h;
+        py::ssize_t got = 0;
+        bool size_ok = true;
+        {
+            py::gil_scoped_release nogil;
+            t[0] = t0;
+            do {
+                if (f.cols != w || f.rows != h || f.type() != CV_8UC1) { size_ok = false; break; }
+                cv::Mat view(h, w, CV_8UC1, dst + got * frame_bytes);
+                f.copyTo(view);
+                got++;
+            } while (got < n && src_->grab(f, t[got]));
+        }
+        if (!size_ok) throw std::runtime_error("source frame size changed mid-stream");
+        if (got < n) {
+            frames = frames[py::slice(0, got, 1)].cast<py::array_t<uint8_t>>();
+            ts = ts[py::slice(0, got, 1)].cast<py::array_t<uint64_t>>();
+        }
+        return py::make_tuple(frames, ts);
+    }
+
+    void close() { if (src_) src_->close(); src_.reset(); }
+
+private:
+    std::unique_ptr<FrameSource> src_;
+};
+
+py::tuple point(const cv::Point2f& p) { return py::make_tuple(p.x, p.y); }
+
+} // namespace
+
+PYBIND11_MODULE(jetson_motion, m) {
+    m.doc() = "ArUco quadrant motion tracker: zero-copy NumPy frames, batch processing without the GIL";
+    // registers the dtype at import; it has to run before anything below uses it
+    PYBIND11_NUMPY_DTYPE(StateRecord, ts_us, tracking, marker_id, bbox, q_valid, pos, vel, acc, pose_valid, t_mm, rvec,
+                         v_mm_s, reproj_px, quality_checked, quality_ok, sharpness, clipped);
+    m.attr("STATE_DTYPE") = py::dtype::of<StateRecord>();
+
+    py::class_<TrackerParams>(m, "TrackerParams")
+        .def(py::init<>())
+        .def_static("load", [](const std::string& path) {
+            TrackerParams p;
+            if (!load_tracker_params(path, p)) throw std::runtime_error("could not load " + path);
+            return p;
+        }, py::arg("path"))
+        .def("save", [](const TrackerParams& p, const std::string& path) {
+            if (!save_tracker_params(path, p)) throw std::runtime_error("could not write " + path);
+        }, py::arg("path"))
+        .def_property("track_mode", [](const TrackerParams& p) { return std::string(track_mode_name(p.track_mode)); },
+                      [](TrackerParams& p, const std::string& s) {
+                          if (!parse_track_mode(s, p.track_mode)) throw py::value_error("track_mode: lk | homography");
+                      })
+        .def_property("lk_backend", [](const TrackerParams& p) { return std::string(lk_backend_name(p.lk_backend)); },
+                      [](TrackerParams& p, const std::string& s) {
+                          if (!parse_lk_backend(s, p.lk_backend)) throw py::value_error("lk_backend: cuda | cpu");
+                      })
+        .def_readwrite("lk_max_level", &TrackerParams::lk_max_level)
+        .def_readwrite("lk_win_size", &TrackerParams::lk_win_size)
+        .def_readwrite("lk_iters", &TrackerParams::lk_iters)
+        .def_readwrite("redetect_interval", &TrackerParams::redetect_interval)
+        .def_readwrite("points_per_quadrant", &TrackerParams::points_per_quadrant)
+        .def_readwrite("feature_quality", &TrackerParams::feature_quality)
+        .def_property("kalman_enabled", [](const TrackerParams& p) { return p.kalman.enabled; },
+                      [](TrackerParams& p, bool v) { p.kalman.enabled = v; })
+        .def_property("gate_enabled", [](const TrackerParams& p) { return p.gate.enabled; },
+                      [](TrackerParams& p, bool v) { p.gate.enabled = v; })
+        .def_property("quality_enabled", [](const TrackerParams& p) { return p.quality.enabled; },
+                      [](TrackerParams& p, bool v) { p.quality.enabled = v; })
+        .def_property("pose_enabled", [](const TrackerParams& p) { return p.pose.enabled; },
+                      [](TrackerParams& p, bool v) { p.pose.enabled = v; })
+        .def_property("pose_marker_mm", [](const TrackerParams& p) { return p.pose.marker_mm; },
+                      [](TrackerParams& p, double v) { p.pose.marker_mm = v; })
+        .def_property("tile_enabled", [](const TrackerParams& p) { return p.tiles.enabled; },
+                      [](TrackerParams& p, bool v) { p.tiles.enabled = v; });
+
+    py::class_<TrackerState>(m, "TrackerState")
+        .def_readonly("tracking", &TrackerState::tracking)
+        .def_readonly("marker_id", &TrackerState::marker_id)
+        .def_property_readonly("bbox", [](const TrackerState& s) {
+            return py::make_tuple(s.marker_bbox.x, s.marker_bbox.y, s.marker_bbox.width, s.marker_bbox.height);
+        })
+        .def_property_readonly("quadrants", [](const TrackerState& s) {
+            py::list l;
+            for (const auto& q : s.q) {
+                py::dict d;
+                d["valid"] = q.valid;
+                d["pos"] = point(q.motion.pos);
+                d["vel"] = point(q.motion.vel);
+                d["acc"] = point(q.motion.acc);
+                l.append(d);
+            }
+            return l;
+        })
+        .def_property_readonly("pose", [](const TrackerState& s) -> py::object {
+            if (!s.pose.valid) return py::none();
+            py::dict d;
+            d["t_mm"] = py::make_tuple(s.pose.t.x, s.pose.t.y, s.pose.t.z);
+            d["rvec"] = py::make_tuple(s.pose.rvec[0], s.pose.rvec[1], s.pose.rvec[2]);
+            d["v_mm_s"] = py::make_tuple(s.pose.vel.x, s.pose.vel.y, s.pose.vel.z);
+            d["reproj_px"] = s.pose.reproj_px;
+            return std::move(d);
+        })
+        .def_property_readonly("quality_ok", [](const TrackerState& s) { return s.quality.ok; })
+        .def("record", [](const TrackerState& s, uint64_t ts_us) {
+            py::array_t<StateRecord> out(1);
+            fill_record(s, ts_us, *out.mutable_data());
+            return out;
+        }, py::arg("ts_us") = 0, "The state as a 1-element STATE_DTYPE array");
+
+    py::class_<PyTracker>(m, "Tracker")
+        .def(py::init<const TrackerParams&, const std::string&>(),
+             py::arg("params") = TrackerParams(), py::arg("camera") = std::string())
+        .def("process", &PyTracker::process, py::arg("frame"), py::arg("ts_us"),
+             "Track one (H, W) uint8 frame (no copy, GIL released) and return the state")
+        .def("process_batch", &PyTracker::process_batch, py::arg("frames"), py::arg("ts_us") = py::none(),
+             py::arg("fps") = 120.0, py::arg("start_us") = 0,
+             "Track an (N, H, W) uint8 array in order with the GIL released; returns an N-element STATE_DTYPE array. "
+             "Without ts_us, timestamps are start_us + k / fps")
+        .def("warm_up", [](PyTracker& t, int width, int height) {
+            py::gil_scoped_release nogil;
+            std::lock_guard<std::mutex> lk(t.mutex());
+            t.tracker().warmUp(cv::Size(width, height));
+        }, py::arg("width"), py::arg("height"))
+        .def("set_params", [](PyTracker& t, const TrackerParams& p) {
+            std::lock_guard<std::mutex> lk(t.mutex());
+            t.tracker().setParams(p);
+        }, py::arg("params"))
+        .def("set_calibration", [](PyTracker& t, const std::string& path) {
+            CameraCalibration c;
+            if (!load_camera_calibration(path, c)) throw std::runtime_error("could not load calibration " + path);
+            std::lock_guard<std::mutex> lk(t.mutex());
+            t.tracker().setCalibration(c);
+        }, py::arg("path"))
+        .def("set_undistortion", [](PyTracker& t, int step, const std::string& cache) {
+            std::lock_guard<std::mutex> lk(t.mutex());
+            t.tracker().setUndistortion(step, cache);
+        }, py::arg("step") = 8, py::arg("cache") = std::string())
+        .def_property_readonly("state", [](PyTracker& t) {
+            std::lock_guard<std::mutex> lk(t.mutex());
+            return t.tracker().state();
+        })
+        .def_property_readonly("detections", [](PyTracker& t) { return t.tracker().detections(); });
+
+    py::class_<SourceConfig>(m, "SourceConfig")
+        .def(py::init<>())
+        .def_readwrite("source", &SourceConfig::source)
+        .def_readwrite("path", &SourceConfig::path)
+        .def_readwrite("device", &SourceConfig::device)
+        .def_readwrite("width", &SourceConfig::width)
+        .def_readwrite("height", &SourceConfig::height)
+        .def_readwrite("framerate", &SourceConfig::framerate)
+        .def_readwrite("io_mode", &SourceConfig::io_mode)
+        .def_readwrite("queue", &SourceConfig::queue)
+        .def_readwrite("max_buffers", &SourceConfig::max_buffers)
+        .def_readwrite("seed", &SourceConfig::seed)
+        .def_readwrite("frames", &SourceConfig::frames);
+
+    py::class_<PySource>(m, "FrameSource")
+        .def(py::init<const SourceConfig&>(), py::arg("config"))
+        .def("grab", &PySource::grab, "(frame, ts_us) with the frame as a view of the grabbed buffer, or None at the end")
+        .def("read", &PySource::read, py::arg("n"), "Up to n frames as ((n, H, W) uint8, (n,) uint64 ts_us)")
+        .def("close", &PySource::close)
+        .def("__enter__", [](PySource& s) -> PySource& { return s; })
+        .def("__exit__", [](PySource& s, py::args) { s.close(); });
+}
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Smoke test for the jetson_motion module (ctest: python_smoke).
+
+Tracks a synthetic clip with one process_batch() call and checks that the
+marker is acquired and the structured output has the documented shape.
+Runs the CPU LK backend so it needs no GPU.
+
+Usage: smoke_test.py [MODULE_DIR]
+"""
+import sys
+
+if len(sys.argv) > 1:
+	sys.path.insert(0, sys.argv[1])
+
+import numpy as np
+import jetson_motion as jm
+
+N, W, H, FPS = 240, 640, 480, 120.0
+
+
+def check(cond, what):
+	if not cond:
+		print(f"FAIL: {what}", file=sys.stderr)
+		sys.exit(1)
+
+
+def main():
+	cfg = jm.SourceConfig()
+	cfg.source = "synthetic"
+	cfg.width, cfg.height, cfg.frames = W, H, N
+	with jm.FrameSource(cfg) as src:
+		frames, ts = src.read(N)
+	check(frames.shape == (N, H, W) and frames.dtype == np.uint8, f"read() frames {frames.shape} {frames.dtype}")
+	check(ts.shape == (N,), f"read() timestamps {ts.shape}")
+
+	params = jm.TrackerParams()
+	params.lk_backend = "cpu"
+	tracker = jm.Tracker(params)
+	out = tracker.process_batch(frames, fps=FPS, start_us=1000)
+
+	check(out.shape == (N,), f"process_batch shape {out.shape}")
+	check(out.dtype == jm.STATE_DTYPE, "process_batch dtype")
+	check(out["bbox"].shape == (N, 4) and out["q_valid"].shape == (N, 4), "bbox / q_valid field shapes")
+	for f in ("pos", "vel", "acc"):
+		check(out[f].shape == (N, 4, 2), f"{f} field shape {out[f].shape}")
+	check(out["t_mm"].shape == (N, 3), "t_mm field shape")
+	expect_ts = 1000 + np.round(np.arange(N) * 1e6 / FPS).astype(np.uint64)
+	check(np.array_equal(out["ts_us"], expect_ts), "generated timestamps")
+
+	# acquired within the first few frames and held for the rest of the clip
+	tail = out[N // 4:]
+	check(tail["tracking"].all(), f"tracking in {np.count_nonzero(tail['tracking'])}/{len(tail)} frames")
+	check((tail["marker_id"] == 0).all(), "marker id")
+	check(tail["q_valid"].all(), "all quadrants valid")
+	pos = tail["pos"]
+	check(((pos[..., 0] >= 0) & (pos[..., 0] < W) & (pos[..., 1] >= 0) & (pos[..., 1] < H)).all(),
+		  "quadrant centres inside the frame")
+	check(tracker.detections >= 1, "at least one detection")
+
+	# single-frame path on a strided view, and the input checks
+	st = tracker.process(frames[-1][:, :W], int(out["ts_us"][-1]) + 8333)
+	check(st.tracking and len(st.quadrants) == 4, "process() state")
+	check(st.record(1).shape == (1,), "TrackerState.record()")
+	for bad in (frames[0].astype(np.float32), frames[0][:, ::2], frames[0][::-1]):
+		try:
+			tracker.process(bad, 0)
+		except (TypeError, ValueError):
+			continue
+		check(False, f"process() accepted a {bad.dtype} frame with strides {bad.strides}")
+	for bad in (frames[::-1], frames[:, ::-1]):
+		try:
+			tracker.process_batch(bad)
+		except ValueError:
+			continue
+		check(False, f"process_batch() accepted frames with strides {bad.strides}")
+	flipped = tracker.process(np.ascontiguousarray(frames[-1][::-1]), int(out["ts_us"][-1]) + 16667)
+	check(len(flipped.quadrants) == 4, "process() on a contiguous copy of a flipped view")
+
+	print(f"python_smoke: OK ({N} frames, tracking from frame {int(np.argmax(out['tracking']))})")
+
+
+if __name__ == "__main__":
+	main()
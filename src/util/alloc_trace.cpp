@@ -0,0 +1,244 @@
+#include "alloc_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <new>
+
+#ifdef TRACKER_ALLOC_TRACE
+#include <opencv2/core.hpp>
+#endif
+
+// Counters live in fixed static tables: the allocation hooks must never
+// allocate themselves, and threads/stages are few and long-lived.
+
+namespace {
+
+constexpr int kMaxThreads = 128;
+constexpr int kMaxStages = 32;
+
+struct Cells {
+    std::atomic<uint64_t> allocs{0}, bytes{0}, mat_allocs{0}, frees{0}, copies{0}, copy_bytes{0};
+
+    AllocCounters load() const {
+        AllocCounters c;
+        c.allocs = allocs.load(std::memory_order_relaxed);
+        c.bytes = bytes.load(std::memory_order_relaxed);
+        c.mat_allocs = mat_allocs.load(std::memory_order_relaxed);
+        c.frees = frees.load(std::memory_order_relaxed);
+        c.copies = copies.load(std::memory_order_relaxed);
+        c.copy_bytes = copy_bytes.load(std::memory_order_relaxed);
+        return c;
+    }
+};
+
+struct ThreadSlot {
+    Cells cells;
+    char name[32] = {};
+};
+
+ThreadSlot g_threads[kMaxThreads];
+std::atomic<int> g_thread_count{0};
+
+Cells g_stage_cells[kMaxStages];
+const char* g_stage_names[kMaxStages] = {"other"};
+std::atomic<int> g_stage_count{1};
+std::mutex g_stage_m;
+
+thread_local ThreadSlot* tl_slot = nullptr;
+thread_local int tl_stage = 0;
+
+ThreadSlot* slot() {
+    if (!tl_slot) {
+        int i = g_thread_count.fetch_add(1, std::memory_order_relaxed);
+        // past the table every late thread shares the last slot
+        tl_slot = &g_threads[i < kMaxThreads ? i : kMaxThreads - 1];
+    }
+    return tl_slot;
+}
+
+inline void count_alloc(size_t n, bool mat) {
+    Cells* cs[2] = {&slot()->cells, &g_stage_cells[tl_stage]};
+    for (Cells* c : cs) {
+        c->allocs.fetch_add(1, std::memory_order_relaxed);
+        c->bytes.fetch_add(n, std::memory_order_relaxed);
+        if (mat) c->mat_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#ifdef TRACKER_ALLOC_TRACE
+inline void count_free() {
+    slot()->cells.frees.fetch_add(1, std::memory_order_relaxed);
+    g_stage_cells[tl_stage].frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Wraps OpenCV's standard allocator; buffers still free through it since
+// UMatData::currAllocator stays the standard one.
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+        cv::UMatData* u = std_()->allocate(dims, sizes, type, data, step, flags, usage);
+        if (u && !data) count_alloc(u->size, true);
+        return u;
+    }
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+        return std_()->allocate(u, flags, usage);
+    }
+    void deallocate(cv::UMatData* u) const override { std_()->deallocate(u); }
+
+private:
+    static cv::MatAllocator* std_() { return cv::Mat::getStdAllocator(); }
+};
+#endif
+
+std::vector<alloc_trace::Row> rows_of(const Cells* cells, int n, const char* const* names, const ThreadSlot* slots) {
+    std::vector<alloc_trace::Row> out;
+    for (int i = 0; i < n; i++) {
+        alloc_trace::Row r;
+        r.c = slots ? slots[i].cells.load() : cells[i].load();
+        if (slots) r.name = slots[i].name[0] ? slots[i].name : "thread#" + std::to_string(i);
+        else r.name = names[i];
+        out.push_back(std::move(r));
+    }
+    return out;
+}
+
+} // namespace
+
+namespace alloc_trace {
+
+bool enabled() {
+#ifdef TRACKER_ALLOC_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void install() {
+#ifdef TRACKER_ALLOC_TRACE
+    static CountingMatAllocator alloc;
+    cv::Mat::setDefaultAllocator(&alloc);
+#endif
+}
+
+void name_thread(const std::string& name) {
+#ifdef TRACKER_ALLOC_TRACE
+    ThreadSlot* s = slot();
+    std::strncpy(s->name, name.c_str(), sizeof(s->name) - 1);
+#else
+    (void)name;
+#endif
+}
+
+int stage_id(const char* name) {
+    std::lock_guard<std::mutex> lk(g_stage_m);
+    int n = g_stage_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; i++)
+        if (std::strcmp(g_stage_names[i], name) == 0) return i;
+    if (n >= kMaxStages) return 0;
+    g_stage_names[n] = name;
+    g_stage_count.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+void note_copy(size_t bytes) {
+    Cells* cs[2] = {&slot()->cells, &g_stage_cells[tl_stage]};
+    for (Cells* c : cs) {
+        c->copies.fetch_add(1, std::memory_order_relaxed);
+        c->copy_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+AllocCounters thread_counters() {
+    return slot()->cells.load();
+}
+
+std::vector<Row> threads() {
+    int n = std::min(g_thread_count.load(std::memory_order_relaxed), kMaxThreads);
+    return rows_of(nullptr, n, nullptr, g_threads);
+}
+
+std::vector<Row> stages() {
+    int n = g_stage_count.load(std::memory_order_acquire);
+    return rows_of(g_stage_cells, n, g_stage_names, nullptr);
+}
+
+void report(std::ostream& os, uint64_t frames) {
+    if (!enabled()) return;
+    auto table = [&](const char* title, const std::vector<Row>& rows) {
+        os << title << "\n" << std::left << std::setw(16) << "  name" << std::right
+           << std::setw(12) << "allocs" << std::setw(14) << "bytes" << std::setw(10) << "mat"
+           << std::setw(12) << "frees" << std::setw(10) << "copies" << std::setw(14) << "copy_bytes";
+        if (frames) os << std::setw(12) << "allocs/fr" << std::setw(12) << "bytes/fr";
+        os << "\n";
+        for (const auto& r : rows) {
+            if (!r.c.allocs && !r.c.copies) continue;
+            os << "  " << std::left << std::setw(14) << r.name << std::right
+               << std::setw(12) << r.c.allocs << std::setw(14) << r.c.bytes << std::setw(10) << r.c.mat_allocs
+               << std::setw(12) << r.c.frees << std::setw(10) << r.c.copies << std::setw(14) << r.c.copy_bytes;
+            if (frames)
+                os << std::fixed << std::setprecision(2) << std::setw(12) << double(r.c.allocs) / frames
+                   << std::setw(12) << std::setprecision(0) << double(r.c.bytes) / frames;
+            os << "\n";
+        }
+    };
+    table("Allocations by thread:", threads());
+    table("Allocations by stage:", stages());
+}
+
+StageScope::StageScope(int id) : prev_(tl_stage) { tl_stage = id; }
+StageScope::~StageScope() { tl_stage = prev_; }
+
+} // namespace alloc_trace
+
+#ifdef TRACKER_ALLOC_TRACE
+// Global replacements: count, then defer to malloc/free.
+
+void* operator new(std::size_t n) {
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    count_alloc(n, false);
+    return p;
+}
+
+void* operator new[](std::size_t n) { return ::operator new(n); }
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    void* p = std::malloc(n ? n : 1);
+    if (p) count_alloc(n, false);
+    return p;
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t& t) noexcept { return ::operator new(n, t); }
+
+void* operator new(std::size_t n, std::align_val_t al) {
+    void* p = nullptr;
+    size_t a = std::max(sizeof(void*), static_cast<size_t>(al));
+    if (posix_memalign(&p, a, n ? n : 1) != 0) throw std::bad_alloc();
+    count_alloc(n, false);
+    return p;
+}
+
+void* operator new[](std::size_t n, std::align_val_t al) { return ::operator new(n, al); }
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    count_free();
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::align_val_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { ::operator delete(p); }
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Heap allocation and frame-copy accounting for the instrumentation build
+// (cmake -DTRACKER_ALLOC_TRACE=ON). That build replaces the global
+// operator new/delete and the cv::Mat allocator with counting versions and
+// attributes every allocation to the calling thread and to the innermost
+// ALLOC_STAGE scope. Copy sites report through ALLOC_TRACE_COPY. In normal
+// builds the macros compile to nothing and the queries return zeros.
+struct AllocCounters {
+    uint64_t allocs = 0;      // operator new + cv::Mat buffers
+    uint64_t bytes = 0;
+    uint64_t mat_allocs = 0;  // subset of allocs made for cv::Mat data
+    uint64_t frees = 0;       // operator delete only
+    uint64_t copies = 0;      // frame-sized copies at instrumented sites
+    uint64_t copy_bytes = 0;
+
+    AllocCounters operator-(const AllocCounters& o) const {
+        return {allocs - o.allocs, bytes - o.bytes, mat_allocs - o.mat_allocs,
+                frees - o.frees, copies - o.copies, copy_bytes - o.copy_bytes};
+    }
+};
+
+namespace alloc_trace {
+
+struct Row {
+    std::string name;
+    AllocCounters c;
+};
+
+// True when built with TRACKER_ALLOC_TRACE.
+bool enabled();
+
+// Route cv::Mat buffers through the counting allocator. Call once at startup.
+void install();
+
+// Label the calling thread (ThreadTopology does this for every role).
+void name_thread(const std::string& name);
+
+// Register a stage name once; returns its id (0 = "other").
+int stage_id(const char* name);
+
+void note_copy(size_t bytes);
+
+// Counters of the calling thread, for before/after deltas.
+AllocCounters thread_counters();
+
+std::vector<Row> threads();
+std::vector<Row> stages();
+
+// Per-thread and per-stage tables; `frames` > 0 adds per-frame columns.
+void report(std::ostream& os, uint64_t frames = 0);
+
+// Attribute allocations on this thread to a stage until the scope ends.
+class StageScope {
+public:
+    explicit StageScope(int id);
+    ~StageScope();
+    StageScope(const StageScope&) = delete;
+    StageScope& operator=(const StageScope&) = delete;
+
+private:
+    int prev_;
+};
+
+} // namespace alloc_trace
+
+#ifdef TRACKER_ALLOC_TRACE
+#define ALLOC_TRACE_CAT2(a, b) a##b
+#define ALLOC_TRACE_CAT(a, b) ALLOC_TRACE_CAT2(a, b)
+#define ALLOC_STAGE(name)                                                              \
+    static const int ALLOC_TRACE_CAT(alloc_stage_id_, __LINE__) = alloc_trace::stage_id(name); \
+    alloc_trace::StageScope ALLOC_TRACE_CAT(alloc_stage_scope_, __LINE__)(ALLOC_TRACE_CAT(alloc_stage_id_, __LINE__))
+#define ALLOC_TRACE_COPY(bytes) alloc_trace::note_copy(bytes)
+#else
+#define ALLOC_STAGE(name) do {} while (0)
+#define ALLOC_TRACE_COPY(bytes) do {} while (0)
+#endif
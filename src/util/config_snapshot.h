@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+// Immutable configuration versions handed from writers (any thread,
+// serialised by a mutex) to one reader that polls at a safe point, such as
+// a frame boundary. poll() is two atomic loads and one store: the reader
+// never takes the lock. A published version stays alive until the reader
+// has moved past it, so the pointer poll() returned is valid until the
+// next poll(); older versions are freed by the next publish().
+template <typename T>
+class ConfigSnapshot {
+public:
+    explicit ConfigSnapshot(const T& initial) {
+        publish(initial);
+        seen_ = version_;
+        acked_.store(version_, std::memory_order_relaxed);
+    }
+
+    ConfigSnapshot(const ConfigSnapshot&) = delete;
+    ConfigSnapshot& operator=(const ConfigSnapshot&) = delete;
+
+    // Writer side. Returns the new version number.
+    uint64_t publish(const T& v) {
+        std::lock_guard<std::mutex> lk(m_);
+        std::unique_ptr<Entry> e(new Entry{++version_, v});
+        const Entry* p = e.get();
+        live_.push_back(std::move(e));
+        cur_.store(p, std::memory_order_release);
+        const uint64_t acked = acked_.load(std::memory_order_acquire);
+        while (live_.size() > 1 && live_.front()->version < acked) live_.pop_front();
+        return p->version;
+    }
+
+    // Writer side: copy of the newest version, to edit and publish again.
+    T latest(uint64_t* version = nullptr) const {
+        std::lock_guard<std::mutex> lk(m_);
+        if (version) *version = live_.back()->version;
+        return live_.back()->value;
+    }
+
+    // Reader side (one thread): the newest version if it changed since the
+    // last poll(), else nullptr.
+    const T* poll() {
+        const Entry* p = cur_.load(std::memory_order_acquire);
+        if (p->version == seen_) return nullptr;
+        seen_ = p->version;
+        acked_.store(seen_, std::memory_order_release);
+        return &p->value;
+    }
+
+    // Version the reader is running with.
+    uint64_t applied() const { return acked_.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        uint64_t version;
+        T value;
+    };
+
+    mutable std::mutex m_;
+    std::deque<std::unique_ptr<Entry>> live_; // oldest first; back() is current
+    uint64_t version_ = 0;
+    std::atomic<const Entry*> cur_{nullptr};
+    std::atomic<uint64_t> acked_{0};
+    uint64_t seen_ = 0; // reader only
+};
@@ -10,9 +10,11 @@
 #include <filesystem>
 #include <cstdlib>
 #include <chrono>
-#include <sstream>
+#include <ctime>
 
 #include "../processing/motion_types.h"
+#include "state_schema.h"
+#include "thread_topology.h"
 
 // Asynchronous CSV logger that writes one line per processed frame.
 // Uses a background thread to minimize impact on FPS.
@@ -23,42 +25,65 @@ public:
 		return inst;
 	}
 
-	// Initialize output directory and CSV file.
-	void init(const std::string& out_dir = defaultOutDir()) {
+	// ARUCO_OUT_DIR, or the deployment default.
+	static std::string defaultOutDir() {
+		const char* env = std::getenv("ARUCO_OUT_DIR");
+		if (env && *env) return std::string(env);
+		return std::string("/data/yash_project/frames");
+	}
+
+	// Initialize output directory and CSV file. Tagged mode (several cameras
+	// sharing one logger) writes metrics_cameras.csv with a leading camera
+	// column, so it never appends to a single-camera file.
+	void init(const std::string& out_dir = defaultOutDir(), bool tagged = false) {
 		std::lock_guard<std::mutex> lk(init_m_);
 		if (initialized_) return;
 		out_dir_ = out_dir;
+		tagged_ = tagged;
 		std::filesystem::create_directories(out_dir_);
-		csv_path_ = out_dir_ + "/metrics.csv";
-		// create file with header
+		csv_path_ = out_dir_ + (tagged_ ? "/metrics_cameras.csv" : "/metrics.csv");
+		// create file with header; a file from a build with other columns is
+		// moved aside rather than appended to
+		const std::string header = build_header();
 		bool need_header = !std::filesystem::exists(csv_path_);
+		if (!need_header) {
+			std::ifstream in(csv_path_);
+			std::string first;
+			std::getline(in, first);
+			if (first + "\n" != header) {
+				std::error_code ec;
+				std::filesystem::rename(csv_path_, csv_path_ + "." + std::to_string(std::time(nullptr)) + ".old", ec);
+				need_header = !ec;
+			}
+		}
 		ofs_.open(csv_path_, std::ios::out | std::ios::app);
 		if (!ofs_.is_open()) {
 			// cannot write; leave initialized false
 			return;
 		}
-		if (need_header) {
-			ofs_ << "ts_us,tracking,marker_id,bbox_x,bbox_y,bbox_w,bbox_h";
-			for (int i=0;i<4;i++) {
-				ofs_ << ",q" << i << "_valid,q" << i << "_cx,q" << i << "_cy,q" << i << "_vx,q" << i << "_vy,q" << i << "_ax,q" << i << "_ay";
-			}
-			ofs_ << "\n";
-		}
+		if (need_header) ofs_ << header;
 		running_ = true;
 		worker_ = std::thread([this]{ this->run(); });
 		initialized_ = true;
 	}
 
-	// Log one line. Thread-safe, non-blocking (bounded queue).
-	void log(uint64_t ts_us, const TrackerState& st) {
+	// Log one line. Thread-safe, non-blocking (bounded queue). `camera` is
+	// written only in tagged mode.
+	void log(uint64_t ts_us, const TrackerState& st, const std::string& camera = std::string()) {
 		if (!initialized_) init();
 		if (!running_) return;
-		std::string line = build_line(ts_us, st);
+		std::string line = build_line(ts_us, st, camera);
+		if (line.empty()) {
+			// did not fit the line buffer (oversized camera name)
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
 		{
 			std::unique_lock<std::mutex> lk(m_);
 			if (queue_.size() >= max_queue_) {
 				// drop oldest to keep up
 				queue_.pop();
+				dropped_.fetch_add(1, std::memory_order_relaxed);
 			}
 			queue_.push(std::move(line));
 		}
@@ -75,37 +100,31 @@ public:
 	const std::string& outDir() const { return out_dir_; }
 	const std::string& csvPath() const { return csv_path_; }
 
+	// Lines discarded because the queue was full.
+	uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+	size_t queueDepth() {
+		std::lock_guard<std::mutex> lk(m_);
+		return queue_.size();
+	}
+
 private:
 	CsvLogger() = default;
 	~CsvLogger() { shutdown(); }
 
-	static std::string defaultOutDir() {
-		const char* env = std::getenv("ARUCO_OUT_DIR");
-		if (env && *env) return std::string(env);
-		return std::string("/data/yash_project/frames");
+	// columns and formatting come from state_schema (shared with the JSON
+	// and binary outputs)
+	std::string build_header() const {
+		char buf[state_schema::kMaxText];
+		return std::string(buf, state_schema::write_csv_header(buf, sizeof(buf), tagged_));
 	}
 
-	std::string build_line(uint64_t ts_us, const TrackerState& st) {
-		std::ostringstream os;
-		os.setf(std::ios::fixed); os.precision(3);
-		os << ts_us << "," << (st.tracking ? 1 : 0) << "," << st.marker_id
-		   << "," << st.marker_bbox.x << "," << st.marker_bbox.y << "," << st.marker_bbox.width << "," << st.marker_bbox.height;
-		for (int i=0;i<4;i++) {
-			const auto& q = st.q[i];
-			os << "," << (q.valid ? 1 : 0);
-			if (q.valid) {
-				os << "," << q.motion.pos.x << "," << q.motion.pos.y
-				   << "," << q.motion.vel.x << "," << q.motion.vel.y
-				   << "," << q.motion.acc.x << "," << q.motion.acc.y;
-			} else {
-				os << ",,,,,,"; // 7 empty fields when invalid
-			}
-		}
-		os << "\n";
-		return os.str();
+	std::string build_line(uint64_t ts_us, const TrackerState& st, const std::string& camera) {
+		char buf[state_schema::kMaxText];
+		return std::string(buf, state_schema::write_csv(buf, sizeof(buf), {st, ts_us}, tagged_, camera));
 	}
 
 	void run() {
+		ThreadTopology::instance().applyToCurrentThread("logger");
 		while (running_) {
 			std::unique_lock<std::mutex> lk(m_);
 			cv_.wait_for(lk, std::chrono::milliseconds(100), [&]{ return !queue_.empty() || !running_; });
@@ -125,6 +144,7 @@ private:
 
 	std::mutex init_m_;
 	bool initialized_ = false;
+	bool tagged_ = false;
 
 	std::thread worker_;
 	std::mutex m_;
@@ -132,4 +152,5 @@ private:
 	std::queue<std::string> queue_;
 	const size_t max_queue_ = 1024; // bounded to prevent RAM growth
 	std::atomic<bool> running_{false};
+	std::atomic<uint64_t> dropped_{0};
 };
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One captured frame, shared read-only by every subscriber. The pixel data
+// is reference counted through cv::Mat; nobody may write into it after
+// FrameBus::publish().
+struct BusFrame {
+    cv::Mat image;
+    uint64_t ts_us = 0;       // capture timestamp
+    uint64_t seq = 0;         // publish order, assigned by the bus
+    int64_t publish_ns = 0;   // steady clock at publish, for lag reporting
+};
+using FramePtr = std::shared_ptr<const BusFrame>;
+
+enum class DropPolicy {
+    DropOldest, // full queue: evict the oldest frame (freshest data wins)
+    DropNewest  // full queue: reject the incoming frame (no gaps in a burst)
+};
+
+struct SubscriberConfig {
+    std::string name;
+    size_t depth = 4;
+    DropPolicy policy = DropPolicy::DropOldest;
+    double max_hz = 0;  // 0 = every frame; otherwise thinned by capture timestamp
+};
+
+struct SubscriberStats {
+    std::string name;
+    uint64_t delivered = 0;     // frames handed out by pop()
+    uint64_t dropped = 0;       // lost to a full queue (either policy)
+    uint64_t rate_skipped = 0;  // intentionally thinned by max_hz
+    size_t queued = 0;          // current backlog
+    uint64_t lag_frames = 0;    // frames published since the last popped one
+    double lag_s = 0;           // publish -> pop latency of the last frame
+    double max_lag_s = 0;
+};
+
+// Bounded per-subscriber queue. Only the subscriber's own thread pops.
+class FrameSubscription {
+public:
+    FrameSubscription(const SubscriberConfig& cfg, const std::atomic<uint64_t>* published)
+        : cfg_(cfg), published_(published) {
+        if (cfg_.depth == 0) cfg_.depth = 1;
+        min_gap_us_ = cfg_.max_hz > 0 ? static_cast<uint64_t>(1e6 / cfg_.max_hz) : 0;
+    }
+
+    // Blocking pop. Returns false once the subscription is closed and drained.
+    bool pop(FramePtr& out) {
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait(lk, [&]{ return closed_ || !q_.empty(); });
+        return take(out);
+    }
+
+    // Like pop() but gives up after timeout_ms (returns false, out untouched).
+    bool pop_for(FramePtr& out, int timeout_ms) {
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait_for(lk, std::chrono::milliseconds(timeout_ms), [&]{ return closed_ || !q_.empty(); });
+        return take(out);
+    }
+
+    // Called from FrameBus::publish on the producer thread; never blocks on
+    // the consumer beyond the queue mutex.
+    void offer(const FramePtr& f) {
+        std::unique_lock<std::mutex> lk(m_);
+        if (closed_) return;
+        if (min_gap_us_ && last_accepted_us_ && f->ts_us > last_accepted_us_ &&
+            f->ts_us - last_accepted_us_ < min_gap_us_) {
+            rate_skipped_++;
+            return;
+        }
+        if (q_.size() >= cfg_.depth) {
+            dropped_++;
+            if (cfg_.policy == DropPolicy::DropNewest) return;
+            q_.pop_front();
+        }
+        last_accepted_us_ = f->ts_us;
+        q_.push_back(f);
+        lk.unlock();
+        cv_.notify_one();
+    }
+
+    void close() {
+        std::unique_lock<std::mutex> lk(m_);
+        closed_ = true;
+        lk.unlock();
+        cv_.notify_all();
+    }
+
+    SubscriberStats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        SubscriberStats s;
+        s.name = cfg_.name;
+        s.delivered = delivered_;
+        s.dropped = dropped_;
+        s.rate_skipped = rate_skipped_;
+        s.queued = q_.size();
+        s.lag_frames = lag_frames_;
+        s.lag_s = lag_s_;
+        s.max_lag_s = max_lag_s_;
+        return s;
+    }
+
+    const SubscriberConfig& config() const { return cfg_; }
+
+private:
+    bool take(FramePtr& out) {
+        if (q_.empty()) return false;
+        out = std::move(q_.front());
+        q_.pop_front();
+        delivered_++;
+        uint64_t pub = published_->load(std::memory_order_relaxed);
+        lag_frames_ = pub > out->seq ? pub - out->seq - 1 : 0;
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        lag_s_ = (now - out->publish_ns) * 1e-9;
+        max_lag_s_ = std::max(max_lag_s_, lag_s_);
+        return true;
+    }
+
+    SubscriberConfig cfg_;
+    const std::atomic<uint64_t>* published_;
+    uint64_t min_gap_us_ = 0;
+    uint64_t last_accepted_us_ = 0;
+
+    mutable std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<FramePtr> q_;
+    bool closed_ = false;
+
+    uint64_t delivered_ = 0, dropped_ = 0, rate_skipped_ = 0, lag_frames_ = 0;
+    double lag_s_ = 0, max_lag_s_ = 0;
+};
+
+// Single-producer frame fan-out. Each subscriber owns a bounded queue with
+// its own depth, drop policy and rate limit, so a slow consumer (display,
+// disk) only ever loses its own frames and never stalls the tracker.
+// Subscribe everything before the first publish().
+class FrameBus {
+public:
+    std::shared_ptr<FrameSubscription> subscribe(const SubscriberConfig& cfg) {
+        auto s = std::make_shared<FrameSubscription>(cfg, &published_);
+        std::lock_guard<std::mutex> lk(m_);
+        subs_.push_back(s);
+        return s;
+    }
+
+    // Wrap and fan out one frame. The bus takes a reference, not a copy:
+    // the caller must not reuse image's buffer afterwards (see FramePool).
+    uint64_t publish(const cv::Mat& image, uint64_t ts_us) {
+        auto f = std::make_shared<BusFrame>();
+        f->image = image;
+        f->ts_us = ts_us;
+        f->seq = published_.load(std::memory_order_relaxed);
+        f->publish_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        FramePtr fp = std::move(f);
+        std::lock_guard<std::mutex> lk(m_);
+        published_.fetch_add(1, std::memory_order_relaxed);
+        for (auto& s : subs_) s->offer(fp);
+        return fp->seq;
+    }
+
+    // Wake every subscriber; pops drain what is queued and then return false.
+    void close() {
+        std::lock_guard<std::mutex> lk(m_);
+        for (auto& s : subs_) s->close();
+    }
+
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+
+    std::vector<SubscriberStats> stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        std::vector<SubscriberStats> out;
+        for (auto& s : subs_) out.push_back(s->stats());
+        return out;
+    }
+
+private:
+    mutable std::mutex m_;
+    std::vector<std::shared_ptr<FrameSubscription>> subs_;
+    std::atomic<uint64_t> published_{0};
+};
+
+// Recycles frame buffers for sources that overwrite a scratch buffer
+// (V4L2 --reuse-buffer). A buffer is handed out again only once every
+// subscriber has released it, so steady state allocates nothing.
+class FramePool {
+public:
+    explicit FramePool(size_t capacity = 16) : capacity_(capacity) {}
+
+    cv::Mat acquire(int rows, int cols, int type) {
+        for (auto& m : pool_)
+            if (m.rows == rows && m.cols == cols && m.type() == type && m.u && m.u->refcount == 1)
+                return m;
+        cv::Mat m(rows, cols, type);
+        if (pool_.size() < capacity_) pool_.push_back(m);
+        else misses_++;
+        return m;
+    }
+
+    size_t size() const { return pool_.size(); }
+    uint64_t misses() const { return misses_; } // allocations beyond the pool
+
+private:
+    size_t capacity_;
+    std::vector<cv::Mat> pool_;
+    uint64_t misses_ = 0;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Process-wide metrics registry (counters, gauges, histograms) rendered in
+// Prometheus text format. Registration takes a lock and happens at startup;
+// updates are relaxed atomics only, so they are safe on the hot path.
+// Labels are passed preformatted, e.g. `camera="cam0"`.
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) { v_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return v_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<uint64_t> v_{0};
+};
+
+class Gauge {
+public:
+    void set(double v) { v_.store(v, std::memory_order_relaxed); }
+    void add(double d) {
+        double cur = v_.load(std::memory_order_relaxed);
+        while (!v_.compare_exchange_weak(cur, cur + d, std::memory_order_relaxed)) {}
+    }
+    double value() const { return v_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<double> v_{0.0};
+};
+
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds)
+        : bounds_(std::move(bounds)), buckets_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+        for (size_t i = 0; i <= bounds_.size(); i++) buckets_[i].store(0, std::memory_order_relaxed);
+    }
+
+    void observe(double v) {
+        size_t i = 0;
+        while (i < bounds_.size() && v > bounds_[i]) i++;
+        buckets_[i].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        double cur = sum_.load(std::memory_order_relaxed);
+        while (!sum_.compare_exchange_weak(cur, cur + v, std::memory_order_relaxed)) {}
+    }
+
+    const std::vector<double>& bounds() const { return bounds_; }
+    uint64_t bucket(size_t i) const { return buckets_[i].load(std::memory_order_relaxed); }
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double sum() const { return sum_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_; // last one is +Inf
+    std::atomic<uint64_t> count_{0};
+    std::atomic<double> sum_{0.0};
+};
+
+// Latency buckets in seconds, 50 us .. 1 s.
+inline std::vector<double> latency_buckets() {
+    return {50e-6, 100e-6, 250e-6, 500e-6, 1e-3, 2e-3, 4e-3, 8.33e-3, 16.7e-3, 33e-3, 100e-3, 1.0};
+}
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance() {
+        static MetricsRegistry inst;
+        return inst;
+    }
+
+    // Returns the existing metric when name+labels were registered before.
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "") {
+        std::lock_guard<std::mutex> lk(m_);
+        Family& f = family(name, help, "counter");
+        auto& e = f.series[labels];
+        if (!e.counter) e.counter = std::make_unique<Counter>();
+        return *e.counter;
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "") {
+        std::lock_guard<std::mutex> lk(m_);
+        Family& f = family(name, help, "gauge");
+        auto& e = f.series[labels];
+        if (!e.gauge) e.gauge = std::make_unique<Gauge>();
+        return *e.gauge;
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         std::vector<double> bounds = latency_buckets(), const std::string& labels = "") {
+        std::lock_guard<std::mutex> lk(m_);
+        Family& f = family(name, help, "histogram");
+        auto& e = f.series[labels];
+        if (!e.histogram) e.histogram = std::make_unique<Histogram>(std::move(bounds));
+        return *e.histogram;
+    }
+
+    // Value computed at scrape time (e.g. stats owned by another component).
+    // `type` is "counter" or "gauge".
+    void callback(const std::string& name, const std::string& help, const std::string& type,
+                  std::function<double()> fn, const std::string& labels = "") {
+        std::lock_guard<std::mutex> lk(m_);
+        family(name, help, type).series[labels].fn = std::move(fn);
+    }
+
+    std::string render() const {
+        std::lock_guard<std::mutex> lk(m_);
+        std::ostringstream os;
+        os.precision(9);
+        for (const auto& kv : families_) {
+            const Family& f = kv.second;
+            os << "# HELP " << kv.first << " " << f.help << "\n";
+            os << "# TYPE " << kv.first << " " << f.type << "\n";
+            for (const auto& s : f.series) {
+                const std::string& lb = s.first;
+                const Series& e = s.second;
+                if (e.histogram) {
+                    const Histogram& h = *e.histogram;
+                    uint64_t cum = 0;
+                    for (size_t i = 0; i <= h.bounds().size(); i++) {
+                        cum += h.bucket(i);
+                        os << kv.first << "_bucket{" << lb << (lb.empty() ? "" : ",") << "le=\"";
+                        if (i < h.bounds().size()) os << h.bounds()[i]; else os << "+Inf";
+                        os << "\"} " << cum << "\n";
+                    }
+                    os << kv.first << "_sum" << braces(lb) << " " << h.sum() << "\n";
+                    os << kv.first << "_count" << braces(lb) << " " << h.count() << "\n";
+                } else {
+                    os << kv.first << braces(lb) << " ";
+                    if (e.counter) os << e.counter->value();
+                    else if (e.gauge) os << e.gauge->value();
+                    else if (e.fn) os << e.fn();
+                    else os << 0;
+                    os << "\n";
+                }
+            }
+        }
+        return os.str();
+    }
+
+private:
+    struct Series {
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> fn;
+    };
+    struct Family {
+        std::string help;
+        std::string type;
+        std::map<std::string, Series> series; // keyed by label string
+    };
+
+    MetricsRegistry() = default;
+
+    Family& family(const std::string& name, const std::string& help, const std::string& type) {
+        Family& f = families_[name];
+        if (f.type.empty()) { f.help = help; f.type = type; }
+        return f;
+    }
+
+    static std::string braces(const std::string& labels) {
+        return labels.empty() ? std::string() : "{" + labels + "}";
+    }
+
+    mutable std::mutex m_;
+    std::map<std::string, Family> families_;
+};
@@ -4,6 +4,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <cstdint>
 
 // Simple thread-safe bounded ring buffer with optional drop-oldest policy.
 template <typename T>
@@ -21,6 +22,7 @@ public:
         if (buffer_.size() >= capacity_) {
             if (drop_oldest_) {
                 buffer_.pop_front();
+                evicted_.fetch_add(1, std::memory_order_relaxed);
             } else {
                 return false;
             }
@@ -53,6 +55,9 @@ public:
         return buffer_.size();
     }
 
+    // Items discarded by the drop-oldest policy since construction.
+    uint64_t evicted() const { return evicted_.load(std::memory_order_relaxed); }
+
 private:
     size_t capacity_;
     bool drop_oldest_;
@@ -60,4 +65,5 @@ private:
     std::condition_variable cv_;
     std::deque<T> buffer_;
     std::atomic<bool> closed_;
+    std::atomic<uint64_t> evicted_{0};
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer / multi-reader sequence lock for trivially copyable values.
+// Readers never block the writer and retry while a write is in progress.
+// The layout (8-byte sequence followed by the value) is plain data, so the
+// same type can be placed in shared memory and read by other processes.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock requires a trivially copyable type");
+
+public:
+    Seqlock() : seq_(0) { std::memset(&value_, 0, sizeof(value_)); }
+
+    // Writer side (one thread only).
+    void store(const T& v) {
+        uint64_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed); // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&value_, &v, sizeof(T));
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+    // Copy out a consistent value. Returns the (even) sequence it was read at.
+    uint64_t load(T& out) const {
+        for (;;) {
+            uint64_t s1 = seq_.load(std::memory_order_acquire);
+            if (s1 & 1) continue;
+            std::memcpy(&out, &value_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t s2 = seq_.load(std::memory_order_relaxed);
+            if (s1 == s2) return s1;
+        }
+    }
+
+    // Single attempt; false if a write was in progress or raced the copy.
+    bool try_load(T& out, uint64_t* seq = nullptr) const {
+        uint64_t s1 = seq_.load(std::memory_order_acquire);
+        if (s1 & 1) return false;
+        std::memcpy(&out, &value_, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) != s1) return false;
+        if (seq) *seq = s1;
+        return true;
+    }
+
+    uint64_t sequence() const { return seq_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<uint64_t> seq_;
+    T value_;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "metrics.h"
+
+// Named startup milestones relative to begin() (the top of main). Marks may
+// come from any thread; the first mark of a given name wins, so per-frame
+// call sites ("first_frame", ...) can mark unconditionally. Each phase is
+// exported as tracker_startup_seconds{phase="..."}.
+class StartupTimeline {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static StartupTimeline& instance() {
+        static StartupTimeline inst;
+        return inst;
+    }
+
+    void begin() {
+        std::lock_guard<std::mutex> lk(m_);
+        t0_ = clock::now();
+        events_.clear();
+    }
+
+    // Record `name` once; returns seconds since begin() (or the earlier mark).
+    double mark(const std::string& name) {
+        double t = std::chrono::duration<double>(clock::now() - t0_).count();
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            for (const auto& e : events_)
+                if (e.name == name) return e.t_s;
+            events_.push_back({name, t});
+        }
+        MetricsRegistry::instance().gauge("tracker_startup_seconds", "Time from process start to a startup milestone",
+                                          "phase=\"" + name + "\"").set(t);
+        return t;
+    }
+
+    bool has(const std::string& name) const {
+        std::lock_guard<std::mutex> lk(m_);
+        for (const auto& e : events_)
+            if (e.name == name) return true;
+        return false;
+    }
+
+    // Milestones in time order with the gap to the previous one.
+    void report(std::ostream& os) const {
+        std::vector<Event> ev;
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            ev = events_;
+        }
+        std::sort(ev.begin(), ev.end(), [](const Event& a, const Event& b) { return a.t_s < b.t_s; });
+        os << "Startup timeline:\n";
+        double prev = 0;
+        for (const auto& e : ev) {
+            os << "  " << std::left << std::setw(20) << e.name << std::right << std::fixed << std::setprecision(1)
+               << std::setw(9) << e.t_s * 1e3 << " ms  (+" << (e.t_s - prev) * 1e3 << ")\n";
+            prev = e.t_s;
+        }
+    }
+
+private:
+    StartupTimeline() : t0_(clock::now()) {}
+
+    struct Event {
+        std::string name;
+        double t_s;
+    };
+
+    mutable std::mutex m_;
+    clock::time_point t0_;
+    std::vector<Event> events_;
+};
@@ -0,0 +1,418 @@
+#pragma once
+
+#include "../processing/motion_types.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+// TrackerState as it leaves the process, described once. The field tables
+// below drive the CSV log, the snapshot and UDP JSON and the binary UDP
+// record, so the outputs cannot drift apart; a new field is one table row.
+// Writers format into a caller-provided buffer with std::to_chars (no
+// locale, no allocation) and return the bytes written, or 0 if it did not fit.
+namespace state_schema {
+
+// Outputs a field appears in.
+enum Format : uint8_t { kCsv = 1, kSnapshot = 2, kUdp = 4, kBinary = 8, kAll = 15 };
+
+enum class Kind : uint8_t { Bool, Int, Real, Vec3 };
+
+constexpr int kCsvPrecision = 3;
+constexpr int kJsonPrecision = 2;
+constexpr size_t kMaxText = 4096; // fits any CSV line or JSON object with a short camera name
+
+struct Record {
+    const TrackerState& st;
+    uint64_t ts_us;
+};
+
+struct Value {
+    int64_t i = 0;
+    double v[3] = {0, 0, 0};
+};
+
+inline Value int_value(int64_t x) { Value r; r.i = x; return r; }
+inline Value real_value(double x) { Value r; r.v[0] = x; return r; }
+inline Value vec_value(double x, double y, double z) { Value r; r.v[0] = x; r.v[1] = y; r.v[2] = z; return r; }
+
+struct Field {
+    const char* key;          // JSON member
+    const char* column[3];    // CSV column; x/y/z columns for Vec3
+    Kind kind;
+    uint8_t formats;
+    int count;                // 4: one value per quadrant (JSON array, q<i>_ columns)
+    Value (*get)(const Record& r, int i); // i: quadrant index in per-quadrant groups/fields
+};
+
+struct Group {
+    const char* key;          // JSON member (array when count > 1); nullptr: top level
+    const char* flag;         // presence column (and JSON key with json_nulls); nullptr: none
+    int count;                // 4: one entry per quadrant (JSON array, q<i>_ columns)
+    bool json_nulls;          // absent: JSON object with flag false and null values, else omitted
+    bool (*present)(const Record& r, int i); // nullptr: always
+    const Field* fields;
+    int nfields;
+};
+
+inline constexpr Field kTopFields[] = {
+    {"ts_us", {"ts_us"}, Kind::Int, kAll, 1, [](const Record& r, int) { return int_value(static_cast<int64_t>(r.ts_us)); }},
+    {"tracking", {"tracking"}, Kind::Bool, kCsv | kBinary, 1, [](const Record& r, int) { return int_value(r.st.tracking); }},
+    {"marker_id", {"marker_id"}, Kind::Int, kAll, 1, [](const Record& r, int) { return int_value(r.st.marker_id); }},
+    {"bbox_x", {"bbox_x"}, Kind::Int, kCsv | kBinary, 1, [](const Record& r, int) { return int_value(r.st.marker_bbox.x); }},
+    {"bbox_y", {"bbox_y"}, Kind::Int, kCsv | kBinary, 1, [](const Record& r, int) { return int_value(r.st.marker_bbox.y); }},
+    {"bbox_w", {"bbox_w"}, Kind::Int, kCsv | kBinary, 1, [](const Record& r, int) { return int_value(r.st.marker_bbox.width); }},
+    {"bbox_h", {"bbox_h"}, Kind::Int, kCsv | kBinary, 1, [](const Record& r, int) { return int_value(r.st.marker_bbox.height); }},
+};
+
+// px, px/s, px/s^2; positions stay out of the 10 Hz UDP feed
+inline constexpr Field kQuadrantFields[] = {
+    {"cx", {"cx"}, Kind::Real, kCsv | kSnapshot | kBinary, 1, [](const Record& r, int i) { return real_value(r.st.q[i].motion.pos.x); }},
+    {"cy", {"cy"}, Kind::Real, kCsv | kSnapshot | kBinary, 1, [](const Record& r, int i) { return real_value(r.st.q[i].motion.pos.y); }},
+    {"vx", {"vx"}, Kind::Real, kAll, 1, [](const Record& r, int i) { return real_value(r.st.q[i].motion.vel.x); }},
+    {"vy", {"vy"}, Kind::Real, kAll, 1, [](const Record& r, int i) { return real_value(r.st.q[i].motion.vel.y); }},
+    {"ax", {"ax"}, Kind::Real, kAll, 1, [](const Record& r, int i) { return real_value(r.st.q[i].motion.acc.x); }},
+    {"ay", {"ay"}, Kind::Real, kAll, 1, [](const Record& r, int i) { return real_value(r.st.q[i].motion.acc.y); }},
+};
+
+// mm, rad, mm/s
+inline constexpr Field kPoseFields[] = {
+    {"t", {"tx_mm", "ty_mm", "tz_mm"}, Kind::Vec3, kAll, 1,
+     [](const Record& r, int) { const auto& p = r.st.pose.t; return vec_value(p.x, p.y, p.z); }},
+    {"r", {"rx", "ry", "rz"}, Kind::Vec3, kAll, 1,
+     [](const Record& r, int) { const auto& p = r.st.pose.rvec; return vec_value(p[0], p[1], p[2]); }},
+    {"v", {"vx_mm_s", "vy_mm_s", "vz_mm_s"}, Kind::Vec3, kAll, 1,
+     [](const Record& r, int) { const auto& p = r.st.pose.vel; return vec_value(p.x, p.y, p.z); }},
+    {"qv", {"vx_mm_s", "vy_mm_s", "vz_mm_s"}, Kind::Vec3, kAll, 4,
+     [](const Record& r, int i) { const auto& p = r.st.pose.q_vel[i]; return vec_value(p.x, p.y, p.z); }},
+    {"reproj_px", {"reproj_px"}, Kind::Real, kAll, 1, [](const Record& r, int) { return real_value(r.st.pose.reproj_px); }},
+};
+
+inline constexpr Field kQualityFields[] = {
+    {"ok", {"quality_ok"}, Kind::Bool, kAll, 1, [](const Record& r, int) { return int_value(r.st.quality.ok); }},
+    {"sharpness", {"sharpness"}, Kind::Real, kAll, 1, [](const Record& r, int) { return real_value(r.st.quality.sharpness); }},
+    {"clipped", {"clipped"}, Kind::Real, kAll, 1, [](const Record& r, int) { return real_value(r.st.quality.clipped); }},
+};
+
+inline constexpr Group kGroups[] = {
+    {nullptr, nullptr, 1, false, nullptr, kTopFields, static_cast<int>(std::size(kTopFields))},
+    {"quadrants", "valid", 4, true, [](const Record& r, int i) { return r.st.q[i].valid; },
+     kQuadrantFields, static_cast<int>(std::size(kQuadrantFields))},
+    {"pose", "pose_valid", 1, false, [](const Record& r, int) { return r.st.pose.valid; },
+     kPoseFields, static_cast<int>(std::size(kPoseFields))},
+    {"quality", nullptr, 1, false, [](const Record& r, int) { return r.st.quality.checked; },
+     kQualityFields, static_cast<int>(std::size(kQualityFields))},
+};
+
+constexpr int components(const Field& f) { return f.kind == Kind::Vec3 ? 3 : 1; }
+
+// Bounded text output; remembers an overflow instead of writing past the end.
+class TextOut {
+public:
+    TextOut(char* buf, size_t cap) : begin_(buf), p_(buf), end_(buf + cap) {}
+
+    void put(char c) {
+        if (p_ < end_) *p_++ = c;
+        else full_ = true;
+    }
+    void put(std::string_view s) {
+        if (s.size() <= static_cast<size_t>(end_ - p_)) {
+            std::memcpy(p_, s.data(), s.size());
+            p_ += s.size();
+        } else {
+            full_ = true;
+        }
+    }
+    void integer(int64_t v) {
+        auto r = std::to_chars(p_, end_, v);
+        if (r.ec == std::errc()) p_ = r.ptr;
+        else full_ = true;
+    }
+    // Fixed-point; non-finite values become `non_finite` (JSON: null),
+    // or nan/inf/-inf like a stream when it is empty.
+    void real(double v, int prec, std::string_view non_finite = std::string_view()) {
+        if (!std::isfinite(v)) {
+            if (!non_finite.empty()) put(non_finite);
+            else put(std::isnan(v) ? "nan" : v > 0 ? "inf" : "-inf");
+            return;
+        }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        auto r = std::to_chars(p_, end_, v, std::chars_format::fixed, prec);
+        if (r.ec == std::errc()) p_ = r.ptr;
+        else full_ = true;
+#else
+        // libstdc++ before GCC 11 has integer to_chars only: print the value
+        // scaled to an integer, falling back to snprintf beyond 2^63
+        static const int64_t kScale[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+        prec = prec < 0 ? 0 : prec > 6 ? 6 : prec;
+        const double s = std::fabs(v) * static_cast<double>(kScale[prec]) + 0.5;
+        if (s >= 9.2e18) {
+            const int n = std::snprintf(p_, static_cast<size_t>(end_ - p_), "%.*f", prec, v);
+            if (n >= 0 && n < end_ - p_) p_ += n;
+            else full_ = true;
+            return;
+        }
+        const int64_t n = static_cast<int64_t>(s);
+        if (v < 0) put('-');
+        integer(n / kScale[prec]);
+        if (!prec) return;
+        put('.');
+        char frac[8];
+        auto r = std::to_chars(frac, frac + sizeof(frac), n % kScale[prec]);
+        for (int pad = prec - static_cast<int>(r.ptr - frac); pad > 0; pad--) put('0');
+        put(std::string_view(frac, static_cast<size_t>(r.ptr - frac)));
+#endif
+    }
+    // JSON string; escapes quotes, backslashes and control characters.
+    void str(std::string_view s) {
+        put('"');
+        for (char c : s) {
+            if (c == '"' || c == '\\') { put('\\'); put(c); }
+            else if (static_cast<unsigned char>(c) < 0x20) put(' ');
+            else put(c);
+        }
+        put('"');
+    }
+
+    size_t size() const { return full_ ? 0 : static_cast<size_t>(p_ - begin_); }
+
+private:
+    char* begin_;
+    char* p_;
+    char* end_;
+    bool full_ = false;
+};
+
+namespace detail {
+
+// the one traversal order shared by the CSV header, the CSV row and the binary record
+template <typename Fn>
+void for_each_column(uint8_t format, Fn&& fn) {
+    for (const Group& g : kGroups)
+        for (int i = 0; i < g.count; i++) {
+            const int gi = g.count > 1 ? i : -1;
+            if (g.flag) fn(g, i, nullptr, gi, -1, 0);
+            for (int f = 0; f < g.nfields; f++) {
+                const Field& fd = g.fields[f];
+                if (!(fd.formats & format)) continue;
+                for (int k = 0; k < fd.count; k++)
+                    fn(g, i, &fd, fd.count > 1 ? k : gi, fd.count > 1 ? k : i, components(fd));
+            }
+        }
+}
+
+inline void column_name(TextOut& o, int qi, const char* name) {
+    if (qi >= 0) {
+        o.put('q');
+        o.integer(qi);
+        o.put('_');
+    }
+    o.put(name);
+}
+
+inline void json_value(TextOut& o, const Field& f, const Value& v) {
+    switch (f.kind) {
+    case Kind::Bool: o.put(v.i ? "true" : "false"); break;
+    case Kind::Int: o.integer(v.i); break;
+    case Kind::Real: o.real(v.v[0], kJsonPrecision, "null"); break;
+    case Kind::Vec3:
+        o.put('[');
+        for (int c = 0; c < 3; c++) {
+            if (c) o.put(',');
+            o.real(v.v[c], kJsonPrecision, "null");
+        }
+        o.put(']');
+        break;
+    }
+}
+
+inline void json_object(TextOut& o, const Group& g, const Record& r, int i, bool on, uint8_t view) {
+    o.put('{');
+    bool first = true;
+    if (g.flag && g.json_nulls) {
+        o.put('"');
+        o.put(g.flag);
+        o.put(on ? "\":true" : "\":false");
+        first = false;
+    }
+    for (int f = 0; f < g.nfields; f++) {
+        const Field& fd = g.fields[f];
+        if (!(fd.formats & view)) continue;
+        if (!first) o.put(',');
+        first = false;
+        o.put('"');
+        o.put(fd.key);
+        o.put("\":");
+        if (!on) { o.put("null"); continue; }
+        if (fd.count > 1) o.put('[');
+        for (int k = 0; k < fd.count; k++) {
+            if (k) o.put(',');
+            json_value(o, fd, fd.get(r, fd.count > 1 ? k : i));
+        }
+        if (fd.count > 1) o.put(']');
+    }
+    o.put('}');
+}
+
+} // namespace detail
+
+// Header line for write_csv (with a leading camera column when tagged).
+inline size_t write_csv_header(char* buf, size_t cap, bool tagged) {
+    TextOut o(buf, cap);
+    if (tagged) o.put("camera,");
+    bool first = true;
+    detail::for_each_column(kCsv, [&](const Group& g, int, const Field* f, int qi, int, int comps) {
+        for (int c = 0; c < (f ? comps : 1); c++) {
+            if (!first) o.put(',');
+            first = false;
+            detail::column_name(o, qi, f ? f->column[c] : g.flag);
+        }
+    });
+    o.put('\n');
+    return o.size();
+}
+
+// One CSV line; an absent group leaves its columns empty.
+inline size_t write_csv(char* buf, size_t cap, const Record& r, bool tagged, std::string_view camera) {
+    TextOut o(buf, cap);
+    if (tagged) {
+        o.put(camera);
+        o.put(',');
+    }
+    bool first = true;
+    detail::for_each_column(kCsv, [&](const Group& g, int i, const Field* f, int, int fi, int comps) {
+        const bool on = !g.present || g.present(r, i);
+        if (!first) o.put(',');
+        first = false;
+        if (!f) { o.put(on ? '1' : '0'); return; }
+        if (!on) {
+            for (int c = 1; c < comps; c++) o.put(',');
+            return;
+        }
+        const Value v = f->get(r, fi);
+        switch (f->kind) {
+        case Kind::Bool: o.put(v.i ? '1' : '0'); break;
+        case Kind::Int: o.integer(v.i); break;
+        case Kind::Real:
+        case Kind::Vec3:
+            for (int c = 0; c < comps; c++) {
+                if (c) o.put(',');
+                o.real(v.v[c], kCsvPrecision);
+            }
+            break;
+        }
+    });
+    o.put('\n');
+    return o.size();
+}
+
+// JSON object for `view` (kSnapshot or kUdp). Per-quadrant entries are
+// always present ("valid":false with nulls); pose and quality only when set.
+inline size_t write_json(char* buf, size_t cap, const Record& r, Format view, std::string_view camera) {
+    TextOut o(buf, cap);
+    o.put('{');
+    bool first = true;
+    if (!camera.empty()) {
+        o.put("\"camera\":");
+        o.str(camera);
+        first = false;
+    }
+    for (const Group& g : kGroups) {
+        if (!g.key) {
+            for (int f = 0; f < g.nfields; f++) {
+                const Field& fd = g.fields[f];
+                if (!(fd.formats & view)) continue;
+                if (!first) o.put(',');
+                first = false;
+                o.put('"');
+                o.put(fd.key);
+                o.put("\":");
+                detail::json_value(o, fd, fd.get(r, 0));
+            }
+            continue;
+        }
+        if (g.count == 1 && !g.json_nulls && g.present && !g.present(r, 0)) continue;
+        if (!first) o.put(',');
+        first = false;
+        o.put('"');
+        o.put(g.key);
+        o.put("\":");
+        if (g.count > 1) o.put('[');
+        for (int i = 0; i < g.count; i++) {
+            if (i) o.put(',');
+            const bool on = !g.present || g.present(r, i);
+            if (!on && !g.json_nulls) o.put("null");
+            else detail::json_object(o, g, r, i, on, view);
+        }
+        if (g.count > 1) o.put(']');
+    }
+    o.put('}');
+    return o.size();
+}
+
+// Binary record: the CSV columns (write_csv_header(..., false) names them)
+// in the same order, fixed size, little-endian: presence flags and Bool u8,
+// Int i64, Real and Vec3 components f32 (NaN when absent).
+constexpr size_t binary_record_size() {
+    size_t n = 0;
+    for (const Group& g : kGroups)
+        for (int i = 0; i < g.count; i++) {
+            if (g.flag) n += 1;
+            for (int f = 0; f < g.nfields; f++) {
+                const Field& fd = g.fields[f];
+                if (!(fd.formats & kBinary)) continue;
+                const size_t each = fd.kind == Kind::Bool ? 1 : fd.kind == Kind::Int ? 8 : 4 * components(fd);
+                n += each * static_cast<size_t>(fd.count);
+            }
+        }
+    return n;
+}
+
+// UDP packet: "JMS1", u16 record size, u8 camera name length, the name, the record.
+constexpr char kBinaryMagic[4] = {'J', 'M', 'S', '1'};
+constexpr size_t kBinaryHeader = 7;
+
+inline size_t write_binary(char* buf, size_t cap, const Record& r, std::string_view camera) {
+    static_assert(binary_record_size() < 65536, "binary record too large for its u16 size field");
+    constexpr size_t rec = binary_record_size();
+    if (camera.size() > 255) camera = camera.substr(0, 255);
+    const size_t total = kBinaryHeader + camera.size() + rec;
+    if (total > cap) return 0;
+    char* p = buf;
+    std::memcpy(p, kBinaryMagic, 4);
+    p[4] = static_cast<char>(rec & 0xff);
+    p[5] = static_cast<char>(rec >> 8);
+    p[6] = static_cast<char>(camera.size());
+    p += kBinaryHeader;
+    std::memcpy(p, camera.data(), camera.size());
+    p += camera.size();
+    auto le = [&p](uint64_t v, int bytes) {
+        for (int b = 0; b < bytes; b++) *p++ = static_cast<char>((v >> (8 * b)) & 0xff);
+    };
+    auto f32 = [&le](double d) {
+        const float f = static_cast<float>(d);
+        uint32_t u;
+        std::memcpy(&u, &f, 4);
+        le(u, 4);
+    };
+    detail::for_each_column(kBinary, [&](const Group& g, int i, const Field* f, int, int fi, int comps) {
+        const bool on = !g.present || g.present(r, i);
+        if (!f) { *p++ = on ? 1 : 0; return; }
+        const Value v = on ? f->get(r, fi) : Value();
+        switch (f->kind) {
+        case Kind::Bool: *p++ = on && v.i ? 1 : 0; break;
+        case Kind::Int: le(static_cast<uint64_t>(v.i), 8); break;
+        case Kind::Real:
+        case Kind::Vec3:
+            for (int c = 0; c < comps; c++) f32(on ? v.v[c] : std::nan(""));
+            break;
+        }
+    });
+    return total;
+}
+
+} // namespace state_schema
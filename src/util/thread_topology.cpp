@@ -0,0 +1,222 @@
+#include "thread_topology.h"
+#include "metrics.h"
+#include "alloc_trace.h"
+
+#include <opencv2/core.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// "2", "0-3", "0+2+5", "0-1+4"
+bool parse_cpus(const std::string& s, std::vector<int>& out) {
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, '+')) {
+        if (part.empty()) return false;
+        size_t dash = part.find('-');
+        try {
+            if (dash == std::string::npos) {
+                out.push_back(std::stoi(part));
+            } else {
+                int a = std::stoi(part.substr(0, dash)), b = std::stoi(part.substr(dash + 1));
+                for (int c = a; c <= b; c++) out.push_back(c);
+            }
+        } catch (...) {
+            return false;
+        }
+    }
+    return !out.empty();
+}
+
+bool read_task_stat(int tid, ThreadStats& st) {
+    std::ifstream f("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string line;
+    if (!std::getline(f, line)) return false;
+    size_t rp = line.rfind(')');
+    if (rp == std::string::npos) return false;
+    std::istringstream is(line.substr(rp + 2));
+    std::vector<std::string> fields;
+    std::string tok;
+    while (is >> tok) fields.push_back(tok);
+    // fields[0] is /proc field 3 (state): utime=14, stime=15, processor=39
+    if (fields.size() < 37) return false;
+    const double tick = static_cast<double>(sysconf(_SC_CLK_TCK));
+    st.cpu_s = (std::stoull(fields[11]) + std::stoull(fields[12])) / tick;
+    st.last_cpu = std::stoi(fields[36]);
+
+    std::ifstream s("/proc/self/task/" + std::to_string(tid) + "/status");
+    while (std::getline(s, line)) {
+        if (line.compare(0, 24, "voluntary_ctxt_switches:") == 0) st.voluntary_cs = std::stoull(line.substr(24));
+        else if (line.compare(0, 27, "nonvoluntary_ctxt_switches:") == 0) st.involuntary_cs = std::stoull(line.substr(27));
+    }
+    return true;
+}
+
+} // namespace
+
+bool ThreadTopology::load(const std::string& path) {
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+        cv::FileNode root = fs.root();
+        for (auto it = root.begin(); it != root.end(); ++it) {
+            cv::FileNode n = *it;
+            ThreadPolicy p;
+            cv::FileNode cpus = n["cpus"];
+            if (cpus.isSeq()) {
+                for (auto c = cpus.begin(); c != cpus.end(); ++c) p.cpus.push_back(static_cast<int>(*c));
+            } else if (cpus.isInt()) {
+                p.cpus.push_back(static_cast<int>(cpus));
+            }
+            if (!n["fifo_priority"].empty()) p.fifo_priority = static_cast<int>(n["fifo_priority"]);
+            set(n.name(), p);
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "ThreadTopology: failed to parse " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ThreadTopology::parse(const std::string& spec) {
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos || eq == 0) return false;
+        std::string role = item.substr(0, eq);
+        std::string rest = item.substr(eq + 1);
+        ThreadPolicy p;
+        size_t colon = rest.find(':');
+        if (!parse_cpus(rest.substr(0, colon), p.cpus)) return false;
+        if (colon != std::string::npos) {
+            try { p.fifo_priority = std::stoi(rest.substr(colon + 1)); } catch (...) { return false; }
+        }
+        set(role, p);
+    }
+    return true;
+}
+
+void ThreadTopology::set(const std::string& role, const ThreadPolicy& p) {
+    std::lock_guard<std::mutex> lk(m_);
+    roles_[role] = p;
+}
+
+bool ThreadTopology::has(const std::string& role) const {
+    std::lock_guard<std::mutex> lk(m_);
+    return roles_.count(role) != 0;
+}
+
+bool ThreadTopology::empty() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return roles_.empty();
+}
+
+bool ThreadTopology::applyToCurrentThread(const std::string& role, const std::string& name) {
+    const std::string label = name.empty() ? role : name;
+    pthread_setname_np(pthread_self(), label.substr(0, 15).c_str());
+    alloc_trace::name_thread(label);
+
+    const int tid = currentTid();
+    ThreadPolicy p;
+    bool have = false, first = false;
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        bool known = false;
+        for (auto& e : threads_) if (e.tid == tid) { e.name = label; known = true; }
+        if (!known) threads_.push_back({label, tid});
+        first = !known;
+        auto it = roles_.find(role);
+        if (it != roles_.end()) { p = it->second; have = true; }
+    }
+    if (first) registerMetrics(label, tid);
+    if (!have) return true;
+
+    bool ok = true;
+    if (!p.cpus.empty() && !setAffinity(p.cpus)) {
+        std::cerr << "ThreadTopology: cannot pin " << label << ": " << std::strerror(errno) << std::endl;
+        ok = false;
+    }
+    if (p.fifo_priority > 0 && !setFifo(p.fifo_priority)) {
+        std::cerr << "ThreadTopology: SCHED_FIFO " << p.fifo_priority << " for " << label
+                  << " failed (needs CAP_SYS_NICE or rtprio limit): " << std::strerror(errno) << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+void ThreadTopology::registerMetrics(const std::string& name, int tid) {
+    auto& reg = MetricsRegistry::instance();
+    const std::string lb = "thread=\"" + name + "\"";
+    auto read = [tid](ThreadStats& st) { return read_task_stat(tid, st); };
+    reg.callback("tracker_thread_cpu_seconds_total", "CPU time (user+system) per registered thread", "counter",
+                 [read]() { ThreadStats st; return read(st) ? st.cpu_s : 0.0; }, lb);
+    reg.callback("tracker_thread_context_switches_total", "Context switches per registered thread", "counter",
+                 [read]() { ThreadStats st; return read(st) ? static_cast<double>(st.voluntary_cs) : 0.0; },
+                 lb + ",kind=\"voluntary\"");
+    reg.callback("tracker_thread_context_switches_total", "Context switches per registered thread", "counter",
+                 [read]() { ThreadStats st; return read(st) ? static_cast<double>(st.involuntary_cs) : 0.0; },
+                 lb + ",kind=\"involuntary\"");
+}
+
+std::vector<ThreadStats> ThreadTopology::stats() const {
+    std::vector<Entry> threads;
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        threads = threads_;
+    }
+    std::vector<ThreadStats> out;
+    for (const auto& e : threads) {
+        ThreadStats st;
+        st.name = e.name;
+        st.tid = e.tid;
+        st.alive = read_task_stat(e.tid, st);
+        out.push_back(st);
+    }
+    return out;
+}
+
+void ThreadTopology::report(std::ostream& os) const {
+    os << "Thread            tid    cpu_s   vol_cs  invol_cs  last_cpu\n";
+    for (const auto& st : stats()) {
+        os << std::left << std::setw(16) << st.name << std::right
+           << std::setw(7) << st.tid;
+        if (!st.alive) { os << "   (exited)\n"; continue; }
+        os << std::setw(9) << std::fixed << std::setprecision(2) << st.cpu_s
+           << std::setw(9) << st.voluntary_cs
+           << std::setw(10) << st.involuntary_cs
+           << std::setw(10) << st.last_cpu << "\n";
+    }
+}
+
+bool ThreadTopology::setAffinity(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) { errno = rc; return false; }
+    return true;
+}
+
+bool ThreadTopology::setFifo(int priority) {
+    sched_param sp{};
+    sp.sched_priority = priority;
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (rc != 0) { errno = rc; return false; }
+    return true;
+}
+
+int ThreadTopology::currentTid() {
+    return static_cast<int>(syscall(SYS_gettid));
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Per-role thread placement: CPU affinity and optional SCHED_FIFO priority.
+// Roles used by the tracker: "capture", "process", "output", "logger",
+// "overlay", "live", "recorder", "detect" (tiled detection workers), "pyramid" (CPU LK pyramid workers) and
+// "gstreamer" (GStreamer streaming threads, see pipeline/gst_thread_hook.h). With --cameras each camera's
+// threads look up "capture.<name>" / "process.<name>" first.
+// Threads register themselves by role so per-thread CPU time and context
+// switches can be reported (stdout at shutdown, /metrics while running),
+// whether or not a policy is configured.
+struct ThreadPolicy {
+    std::vector<int> cpus;  // empty = leave affinity alone
+    int fifo_priority = 0;  // 1..99 = SCHED_FIFO, 0 = keep SCHED_OTHER
+};
+
+struct ThreadStats {
+    std::string name;
+    int tid = 0;
+    double cpu_s = 0;              // user + system
+    uint64_t voluntary_cs = 0;     // blocked / yielded
+    uint64_t involuntary_cs = 0;   // preempted
+    int last_cpu = -1;
+    bool alive = false;
+};
+
+class ThreadTopology {
+public:
+    static ThreadTopology& instance() {
+        static ThreadTopology inst;
+        return inst;
+    }
+
+    // JSON/YAML: { "capture": { "cpus": [2], "fifo_priority": 80 }, ... }
+    bool load(const std::string& path);
+    // Compact form: "capture=2:80,process=3:70,logger=0-1" (CPU lists join
+    // with '+', e.g. "output=0+4").
+    bool parse(const std::string& spec);
+    void set(const std::string& role, const ThreadPolicy& p);
+    bool has(const std::string& role) const;
+    bool empty() const;
+
+    // Apply the role's policy (if any) to the calling thread and register it
+    // for reporting under `name` (defaults to the role).
+    bool applyToCurrentThread(const std::string& role, const std::string& name = std::string());
+
+    std::vector<ThreadStats> stats() const;
+    void report(std::ostream& os) const;
+
+    static bool setAffinity(const std::vector<int>& cpus);
+    static bool setFifo(int priority);
+    static int currentTid();
+
+private:
+    ThreadTopology() = default;
+    static void registerMetrics(const std::string& name, int tid);
+
+    struct Entry {
+        std::string name;
+        int tid;
+    };
+
+    mutable std::mutex m_;
+    std::map<std::string, ThreadPolicy> roles_;
+    std::vector<Entry> threads_;
+};
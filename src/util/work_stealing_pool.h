@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_topology.h"
+
+// Fixed worker threads with one task deque each. run() deals a batch of
+// task indices round-robin onto the deques; a worker pops from the back of
+// its own deque and, once that is empty, steals from the front of the
+// others, so uneven tasks (a tile full of candidate quads costs more than
+// an empty one) balance out. The calling thread steals too and returns when
+// the whole batch is done. One batch at a time: run() is not reentrant.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads, const std::string& role = "detect")
+        : queues_(static_cast<size_t>(std::max(1, threads))) {
+        for (int i = 0; i < threads; i++)
+            workers_.emplace_back([this, i, role]{ loop(i, role); });
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int threads() const { return static_cast<int>(workers_.size()); }
+
+    // Call fn(0..n-1) across the pool and the calling thread; blocks until all return.
+    void run(int n, const std::function<void(int)>& fn) {
+        if (n <= 0) return;
+        if (workers_.empty()) {
+            for (int i = 0; i < n; i++) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            fn_ = &fn;
+            pending_.store(n, std::memory_order_relaxed);
+            for (int i = 0; i < n; i++) {
+                Queue& q = queues_[static_cast<size_t>(i) % queues_.size()];
+                std::lock_guard<std::mutex> qlk(q.m);
+                q.tasks.push_back(i);
+            }
+            generation_++;
+        }
+        cv_.notify_all();
+
+        int idx;
+        while (take(-1, idx)) execute(idx);
+        std::unique_lock<std::mutex> lk(m_);
+        done_cv_.wait(lk, [&]{ return pending_.load(std::memory_order_acquire) == 0; });
+        fn_ = nullptr;
+    }
+
+    // Tasks taken from another thread's deque (caller included).
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<int> tasks;
+    };
+
+    // self < 0: the calling thread, which only steals
+    bool take(int self, int& idx) {
+        const int n = static_cast<int>(queues_.size());
+        if (self >= 0) {
+            Queue& q = queues_[static_cast<size_t>(self)];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (!q.tasks.empty()) {
+                idx = q.tasks.back();
+                q.tasks.pop_back();
+                return true;
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            const int v = self >= 0 ? (self + 1 + k) % n : k;
+            if (v == self) continue;
+            Queue& q = queues_[static_cast<size_t>(v)];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (!q.tasks.empty()) {
+                idx = q.tasks.front();
+                q.tasks.pop_front();
+                steals_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(int idx) {
+        (*fn_)(idx);
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lk(m_);
+            done_cv_.notify_all();
+        }
+    }
+
+    void loop(int self, const std::string& role) {
+        ThreadTopology::instance().applyToCurrentThread(role, role + ":" + std::to_string(self));
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lk(m_);
+                cv_.wait(lk, [&]{ return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            int idx;
+            while (take(self, idx)) execute(idx);
+        }
+    }
+
+    std::vector<Queue> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex m_;
+    std::condition_variable cv_, done_cv_;
+    const std::function<void(int)>* fn_ = nullptr;
+    std::atomic<int> pending_{0};
+    std::atomic<uint64_t> steals_{0};
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+};
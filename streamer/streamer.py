@@ -1,11 +1,12 @@
 #!/usr/bin/env python3
 """Simple MJPEG streamer that serves /stream by repeatedly reading /tmp/live.jpg."""
-from flask import Flask, Response, render_template_string, jsonify
+from flask import Flask, Response, render_template_string, jsonify, request
 import time
 import os
 import threading
 import socket
 import json
+import urllib.request
 
 FRAME_PATH = '/tmp/live.jpg'
 FPS = 10.0
@@ -184,6 +185,18 @@ def udp_receiver(host='0.0.0.0', port=5001):
 def metrics():
     return jsonify(latest_metrics or {"status":"no data yet"})
 
+@app.route('/history')
+def history():
+    # motion history from the tracker's metrics port (see README "Motion history")
+    url = 'http://127.0.0.1:9101/history'
+    if request.query_string:
+        url += '?' + request.query_string.decode('utf-8')
+    try:
+        with urllib.request.urlopen(url, timeout=2.0) as r:
+            return Response(r.read(), mimetype='application/json')
+    except Exception as e:
+        return jsonify({"status": "tracker unavailable", "error": str(e)}), 502
+
 # UDP JPEG frame receiver using the custom chunking protocol
 def udp_frame_receiver(host='0.0.0.0', port=5002):
     global latest_frame_bytes
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Offline processing through the jetson_motion Python module.
+
+Reads a clip in batches, tracks each batch with one process_batch() call
+(GIL released, frames passed without a copy) and saves the structured state
+array as .npy. With --compare-csv it also times loading the same fields from
+a metrics.csv written by the tracker binary.
+
+Build the module with -DTRACKER_PYTHON=ON and put the build directory on
+PYTHONPATH.
+"""
+import argparse
+import csv
+import sys
+import time
+
+import numpy as np
+
+try:
+	import jetson_motion as jm
+except ImportError:
+	print("ERROR: jetson_motion not found (cmake -DTRACKER_PYTHON=ON, then PYTHONPATH=build)", file=sys.stderr)
+	sys.exit(1)
+
+
+def load_csv(path):
+	"""metrics.csv into the same structured layout, the way it was done before."""
+	rows = []
+	with open(path, newline="") as f:
+		for r in csv.DictReader(f):
+			rec = np.zeros((), dtype=jm.STATE_DTYPE)
+			rec["ts_us"] = int(r["ts_us"])
+			rec["tracking"] = r["tracking"] == "1"
+			rec["marker_id"] = int(r["marker_id"])
+			for q in range(4):
+				rec["q_valid"][q] = r[f"q{q}_valid"] == "1"
+				if rec["q_valid"][q]:
+					rec["pos"][q] = (float(r[f"q{q}_cx"]), float(r[f"q{q}_cy"]))
+					rec["vel"][q] = (float(r[f"q{q}_vx"]), float(r[f"q{q}_vy"]))
+					rec["acc"][q] = (float(r[f"q{q}_ax"]), float(r[f"q{q}_ay"]))
+			rows.append(rec)
+	return np.array(rows, dtype=jm.STATE_DTYPE)
+
+
+def main():
+	ap = argparse.ArgumentParser(description="Track a clip from Python in batches")
+	ap.add_argument("--source", default="synthetic", help="video | sequence | synthetic")
+	ap.add_argument("--path", default="", help="video file or image directory")
+	ap.add_argument("--frames", type=int, default=1200, help="synthetic clip length")
+	ap.add_argument("--width", type=int, default=640)
+	ap.add_argument("--height", type=int, default=480)
+	ap.add_argument("--params", default="", help="tracker params JSON")
+	ap.add_argument("--batch", type=int, default=256, help="frames per process_batch call")
+	ap.add_argument("--out", default="states.npy")
+	ap.add_argument("--compare-csv", default="", help="metrics.csv to time against")
+	args = ap.parse_args()
+
+	cfg = jm.SourceConfig()
+	cfg.source = args.source
+	cfg.path = args.path
+	cfg.width = args.width
+	cfg.height = args.height
+	cfg.frames = args.frames
+	params = jm.TrackerParams.load(args.params) if args.params else jm.TrackerParams()
+	tracker = jm.Tracker(params)
+	tracker.warm_up(args.width, args.height)
+
+	parts = []
+	t_read = t_track = 0.0
+	with jm.FrameSource(cfg) as src:
+		while True:
+			t0 = time.perf_counter()
+			frames, ts = src.read(args.batch)
+			t1 = time.perf_counter()
+			if len(ts) == 0:
+				break
+			parts.append(tracker.process_batch(frames, ts))
+			t_read += t1 - t0
+			t_track += time.perf_counter() - t1
+	states = np.concatenate(parts) if parts else np.zeros(0, dtype=jm.STATE_DTYPE)
+	np.save(args.out, states)
+	n = len(states)
+	print(f"{n} frames: read {t_read:.2f} s, track {t_track:.2f} s ({n / max(t_track, 1e-9):.0f} fps), "
+		  f"tracking {np.count_nonzero(states['tracking'])}, detections {tracker.detections} -> {args.out}")
+
+	if args.compare_csv:
+		t0 = time.perf_counter()
+		from_csv = load_csv(args.compare_csv)
+		t_csv = time.perf_counter() - t0
+		t0 = time.perf_counter()
+		np.load(args.out)
+		t_npy = time.perf_counter() - t0
+		print(f"load {len(from_csv)} rows from CSV: {t_csv * 1e3:.1f} ms; {n} rows from .npy: {t_npy * 1e3:.2f} ms")
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,62 @@
+// Minimal reader for the tracker's shared-memory state segment.
+// Usage: aruco_shm_reader [--name /aruco_tracker_state] [--history N] [--follow]
+#include "io/state_shm.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+static void print_record(const ShmStateRecord& r, uint64_t now_ns) {
+    std::printf("seq=%llu ts_us=%llu tracking=%u id=%d age_us=%.1f",
+                (unsigned long long)r.frame_seq, (unsigned long long)r.ts_us, r.tracking, r.marker_id,
+                (now_ns - r.publish_ns) / 1000.0);
+    for (int i = 0; i < 4; i++) {
+        const auto& q = r.q[i];
+        if (q.valid) std::printf(" q%d=(%.1f,%.1f v=%.1f,%.1f)", i, q.cx, q.cy, q.vx, q.vy);
+        else std::printf(" q%d=-", i);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    std::string name = kDefaultShmName;
+    int history = 0;
+    bool follow = false;
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--name" && i+1<argc) name = argv[++i];
+        else if (a == "--history" && i+1<argc) history = atoi(argv[++i]);
+        else if (a == "--follow") follow = true;
+    }
+
+    StateShmReader rd;
+    if (!rd.open(name)) {
+        std::fprintf(stderr, "cannot open shared memory segment %s (is the tracker running?)\n", name.c_str());
+        return 1;
+    }
+
+    ShmStateRecord r;
+    if (history > 0) {
+        uint64_t n = rd.writeCount();
+        uint64_t first = n > static_cast<uint64_t>(history) ? n - history + 1 : 1;
+        for (uint64_t k = first; k <= n; k++)
+            if (rd.history(k, r)) print_record(r, shm_now_ns());
+        return 0;
+    }
+
+    uint64_t last = 0;
+    do {
+        // spin briefly on the write counter; a new frame shows up within microseconds
+        uint64_t n = rd.writeCount();
+        if (n != last) {
+            rd.latest(r);
+            print_record(r, shm_now_ns());
+            last = n;
+        } else if (follow) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    } while (follow);
+    return 0;
+}
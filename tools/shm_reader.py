@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Lock-free reader for the tracker's shared-memory state segment.
+
+Mirrors the layout in src/io/state_shm.h. Each slot is a seqlock: an 8-byte
+sequence (odd while the writer is mid-update) followed by one record.
+"""
+import argparse
+import mmap
+import os
+import struct
+import sys
+import time
+
+SHM_MAGIC = 0x4B525441
+SHM_VERSION = 1
+
+HEADER = struct.Struct("<IIIIQ40x")            # 64 bytes
+RECORD = struct.Struct("<QQQiIiiii" + "6fII" * 4 + "Q")  # 184 bytes
+SEQ = struct.Struct("<Q")
+SLOT_SIZE = SEQ.size + RECORD.size            # 192 bytes
+
+
+class StateShmReader:
+	def __init__(self, name="/aruco_tracker_state"):
+		path = "/dev/shm/" + name.lstrip("/")
+		fd = os.open(path, os.O_RDONLY)
+		try:
+			size = os.fstat(fd).st_size
+			self._mm = mmap.mmap(fd, size, mmap.MAP_SHARED, mmap.PROT_READ)
+		finally:
+			os.close(fd)
+		magic, version, self.history_len, record_size, _ = HEADER.unpack_from(self._mm, 0)
+		if magic != SHM_MAGIC or version != SHM_VERSION or record_size != RECORD.size:
+			raise RuntimeError(f"{path}: unexpected segment header (magic={magic:#x}, version={version})")
+		if size < HEADER.size + SLOT_SIZE * (1 + self.history_len):
+			raise RuntimeError(f"{path}: segment truncated")
+
+	def close(self):
+		self._mm.close()
+
+	def write_count(self):
+		return HEADER.unpack_from(self._mm, 0)[4]
+
+	def _read_slot(self, index):
+		off = HEADER.size + index * SLOT_SIZE
+		while True:
+			s1 = SEQ.unpack_from(self._mm, off)[0]
+			if s1 & 1:
+				continue
+			raw = self._mm[off + SEQ.size: off + SLOT_SIZE]
+			if SEQ.unpack_from(self._mm, off)[0] == s1:
+				return decode(raw)
+
+	def latest(self):
+		return self._read_slot(0)
+
+	def history(self, n):
+		"""Record with frame_seq == n, or None if not written / overwritten."""
+		if n <= 0:
+			return None
+		rec = self._read_slot(1 + (n - 1) % self.history_len)
+		return rec if rec["frame_seq"] == n else None
+
+
+def decode(raw):
+	v = RECORD.unpack(raw)
+	rec = {
+		"frame_seq": v[0], "ts_us": v[1], "publish_ns": v[2],
+		"marker_id": v[3], "tracking": bool(v[4]),
+		"bbox": (v[5], v[6], v[7], v[8]),
+		"quadrants": [],
+	}
+	for i in range(4):
+		cx, cy, vx, vy, ax, ay, valid, _ = v[9 + i * 8: 17 + i * 8]
+		rec["quadrants"].append({"valid": bool(valid), "cx": cx, "cy": cy, "vx": vx, "vy": vy, "ax": ax, "ay": ay})
+	return rec
+
+
+def main():
+	ap = argparse.ArgumentParser(description="Read tracker state from shared memory")
+	ap.add_argument("--name", default="/aruco_tracker_state")
+	ap.add_argument("--history", type=int, default=0, help="Print the last N records instead of the latest")
+	ap.add_argument("--follow", action="store_true", help="Keep printing each new frame")
+	args = ap.parse_args()
+
+	try:
+		rd = StateShmReader(args.name)
+	except (OSError, RuntimeError) as e:
+		print(f"ERROR: {e}", file=sys.stderr)
+		sys.exit(1)
+
+	if args.history > 0:
+		n = rd.write_count()
+		for k in range(max(1, n - args.history + 1), n + 1):
+			rec = rd.history(k)
+			if rec:
+				print(rec)
+		return
+
+	last = 0
+	while True:
+		n = rd.write_count()
+		if n != last:
+			rec = rd.latest()
+			age_us = (time.clock_gettime_ns(time.CLOCK_MONOTONIC) - rec["publish_ns"]) / 1000.0
+			print(f"seq={rec['frame_seq']} ts_us={rec['ts_us']} tracking={rec['tracking']} id={rec['marker_id']} age_us={age_us:.1f}")
+			last = n
+		if not args.follow:
+			break
+		time.sleep(0.0002)
+
+
+if __name__ == "__main__":
+	main()